@@ -0,0 +1,142 @@
+#include "Sockets.hpp"
+#include "Address.hpp"
+#include "UDP/UDPClient.hpp"
+#include "UDP/Datagram.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+#include "Serialization/Serializer.hpp"
+#include "Errors.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cost of a frame of a server with lots of connected peers of which only a few are active, i.e. have data sent to them each frame
+// Peers complete their connection through the simulator then stay silent : the timeout is raised so that they remain connected
+
+namespace
+{
+	constexpr Bousk::uint16 ServerPort = 8888;
+	constexpr std::chrono::milliseconds FrameDuration{ 16 };
+	constexpr size_t NbWarmUpFrames = 30; //!< Let the connection burst go
+	constexpr size_t NbMeasuredFrames = 120;
+	constexpr size_t MessageSize = 16;
+
+	std::vector<Bousk::Network::Address> CreatePeers(size_t nbPeers)
+	{
+		// Spread peers over ips and ports, as seen by a server behind NATs
+		std::vector<Bousk::Network::Address> peers;
+		peers.reserve(nbPeers);
+		for (size_t i = 0; i < nbPeers; ++i)
+		{
+			const std::string ip = "127.0." + std::to_string((i / 250) % 250) + "." + std::to_string(1 + i % 250);
+			peers.emplace_back(ip, static_cast<Bousk::uint16>(20000 + i % 40000));
+		}
+		return peers;
+	}
+	// Keep alive a peer answers the connection request of the server with
+	Bousk::Network::UDP::Datagram ConnectedKeepAlive()
+	{
+		Bousk::Network::UDP::Datagram datagram;
+		datagram.header.id = 0;
+		datagram.header.ack = 0;
+		datagram.header.previousAcks = 0;
+		datagram.header.type = Bousk::Network::UDP::Datagram::Type::KeepAlive;
+		Bousk::Serialization::Serializer serializer;
+		serializer.write(true);
+		memcpy(datagram.data.data(), serializer.buffer(), serializer.bufferSize());
+		datagram.datasize = static_cast<Bousk::uint16>(serializer.bufferSize());
+		return datagram;
+	}
+
+	void Run(size_t nbPeers, size_t nbActivePeers)
+	{
+		const std::vector<Bousk::Network::Address> peers = CreatePeers(nbPeers);
+		Bousk::Network::UDP::Client server;
+		server.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		server.simulator().enable();
+		server.simulator().setLossRate(0);
+		server.simulator().setDelay(0, 0);
+		if (!server.init(ServerPort))
+		{
+			std::cout << "Server initialisation error : " << Bousk::Network::Errors::Get() << std::endl;
+			return;
+		}
+
+		for (const Bousk::Network::Address& peer : peers)
+			server.connect(peer);
+		server.processSend();
+		const Bousk::Network::UDP::Datagram keepAlive = ConnectedKeepAlive();
+		for (const Bousk::Network::Address& peer : peers)
+			server.simulator().push(keepAlive, peer);
+		size_t nbConnected = 0;
+		std::vector<Bousk::Network::Messages::Event> events;
+		for (const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5); nbConnected < nbPeers && std::chrono::steady_clock::now() < end;)
+		{
+			server.receive();
+			events.clear();
+			server.pollEvents(events);
+			nbConnected += std::count_if(events.begin(), events.end(), [](const Bousk::Network::Messages::Event& event) { return event.is<Bousk::Network::Messages::Connection>(); });
+		}
+
+		const std::vector<Bousk::uint8> message(MessageSize, 42);
+		std::chrono::steady_clock::duration processSendDuration{ 0 };
+		Bousk::uint64 nbDatagramsSent = 0;
+		Bousk::uint64 nbDatagramsDropped = 0;
+		auto frameStart = std::chrono::steady_clock::now();
+		for (size_t frame = 0; frame < NbWarmUpFrames + NbMeasuredFrames; ++frame)
+		{
+			if (frame == NbWarmUpFrames)
+			{
+				nbDatagramsSent = server.nbDatagramsSent();
+				nbDatagramsDropped = server.nbDatagramsDropped();
+			}
+			server.receive();
+			events.clear();
+			server.pollEvents(events);
+			for (size_t i = 0; i < nbActivePeers; ++i)
+				server.sendTo(peers[i * nbPeers / nbActivePeers], message.data(), message.size(), 0);
+			const auto start = std::chrono::steady_clock::now();
+			server.processSend();
+			if (frame >= NbWarmUpFrames)
+				processSendDuration += std::chrono::steady_clock::now() - start;
+			frameStart += FrameDuration;
+			std::this_thread::sleep_until(frameStart);
+		}
+		nbDatagramsSent = server.nbDatagramsSent() - nbDatagramsSent;
+		nbDatagramsDropped = server.nbDatagramsDropped() - nbDatagramsDropped;
+
+		std::cout << nbPeers << " peers (" << nbConnected << " connected), " << nbActivePeers << " active : "
+			<< std::chrono::duration<double, std::micro>(processSendDuration).count() / NbMeasuredFrames << "us per processSend - "
+			<< static_cast<double>(nbDatagramsSent + nbDatagramsDropped) / NbMeasuredFrames << " datagrams per frame";
+		if (nbDatagramsDropped)
+			std::cout << " (" << static_cast<double>(nbDatagramsDropped) / NbMeasuredFrames << " dropped by the socket)";
+		std::cout << std::endl;
+		server.release();
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	Bousk::Network::UDP::Client::SetTimeout(std::chrono::minutes(10));
+	std::cout << "Periodic keep alives" << std::endl;
+	Bousk::Network::UDP::Client::SetKeepAliveMode(Bousk::Network::UDP::KeepAliveMode::Periodic);
+	Run(100, 100);
+	Run(10000, 100);
+	std::cout << "Ack only keep alives" << std::endl;
+	Bousk::Network::UDP::Client::SetKeepAliveMode(Bousk::Network::UDP::KeepAliveMode::AckOnly);
+	Run(100, 100);
+	Run(10000, 100);
+
+	Bousk::Network::Release();
+	return 0;
+}
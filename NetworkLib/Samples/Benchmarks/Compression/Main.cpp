@@ -0,0 +1,149 @@
+#include "Compression/LZ.hpp"
+#include "UDP/Packet.hpp"
+#include "UDP/Protocols/Compressed.hpp"
+#include "UDP/Protocols/ReliableOrdered.hpp"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compression ratio and cost of the LZ compressor, on its own and as a channel
+// Messages are JSON like states of entities, the dictionary is a sample of them both ends know
+
+namespace
+{
+	constexpr size_t NbMessages = 20000;
+	constexpr size_t NbRepeats = 5; //!< Each measure is repeated to time more than a few microseconds
+
+	std::string Message(std::mt19937& random)
+	{
+		static const char* const States[] = { "idle", "running", "jumping", "attacking", "dead" };
+		std::uniform_int_distribution<int> value(-1000, 1000);
+		return "{\"entity\":" + std::to_string(random() % 512)
+			+ ",\"position\":{\"x\":" + std::to_string(value(random) / 10.f) + ",\"y\":" + std::to_string(value(random) / 10.f) + ",\"z\":" + std::to_string(value(random) / 10.f)
+			+ "},\"state\":\"" + States[random() % 5] + "\",\"health\":" + std::to_string(random() % 101) + "}";
+	}
+	std::vector<std::vector<Bousk::uint8>> Messages(size_t nbMessages, unsigned int seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<std::vector<Bousk::uint8>> messages;
+		for (size_t i = 0; i < nbMessages; ++i)
+		{
+			const std::string message = Message(random);
+			messages.emplace_back(message.begin(), message.end());
+		}
+		return messages;
+	}
+
+	struct Result
+	{
+		Bousk::uint64 rawSize{ 0 };
+		Bousk::uint64 compressedSize{ 0 };
+		std::chrono::nanoseconds compressDuration{ 0 };
+		std::chrono::nanoseconds decompressDuration{ 0 };
+	};
+	void Print(const char* name, const Result& result)
+	{
+		std::cout << name << " : " << result.rawSize << "B -> " << result.compressedSize << "B, ratio " << static_cast<double>(result.rawSize) / result.compressedSize
+			<< " - compress " << static_cast<double>(result.compressDuration.count()) / result.rawSize << "ns/B"
+			<< ", decompress " << static_cast<double>(result.decompressDuration.count()) / result.rawSize << "ns/B" << std::endl;
+	}
+	//!< Each block compressed on its own
+	Result Run(const std::vector<std::vector<Bousk::uint8>>& blocks, const Bousk::Compression::Dictionary* dictionary)
+	{
+		Result result;
+		std::vector<Bousk::uint8> compressed;
+		std::vector<Bousk::uint8> decompressed;
+		for (const std::vector<Bousk::uint8>& block : blocks)
+		{
+			compressed.resize(Bousk::Compression::LZ::CompressBound(block.size()));
+			decompressed.resize(block.size());
+			size_t compressedSize = 0;
+			const auto compressStart = std::chrono::steady_clock::now();
+			for (size_t repeat = 0; repeat < NbRepeats; ++repeat)
+				compressedSize = Bousk::Compression::LZ::Compress(block.data(), block.size(), compressed.data(), compressed.size(), dictionary);
+			const auto decompressStart = std::chrono::steady_clock::now();
+			size_t decompressedSize = 0;
+			bool decompressedOk = true;
+			for (size_t repeat = 0; repeat < NbRepeats; ++repeat)
+				decompressedOk &= Bousk::Compression::LZ::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size(), decompressedSize, dictionary);
+			const auto end = std::chrono::steady_clock::now();
+			if (!decompressedOk || decompressed != block)
+				std::cout << "Round trip failed" << std::endl;
+			result.compressDuration += (decompressStart - compressStart) / NbRepeats;
+			result.decompressDuration += (end - decompressStart) / NbRepeats;
+			result.rawSize += block.size();
+			result.compressedSize += compressedSize;
+		}
+		return result;
+	}
+	//!< Bytes of packets a reliable channel sends, wrapped in a Compressed one or not
+	Bousk::uint64 ChannelSize(const std::vector<std::vector<Bousk::uint8>>& messages, std::unique_ptr<Bousk::Network::UDP::Protocols::IProtocol>&& channel)
+	{
+		constexpr size_t MessagesPerFrame = 8;
+		std::array<Bousk::uint8, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+		Bousk::uint64 size = 0;
+		Bousk::Network::UDP::Datagram::ID datagramId = 0;
+		for (size_t i = 0; i < messages.size(); ++i)
+		{
+			channel->queue(std::vector<Bousk::uint8>(messages[i]));
+			if (i % MessagesPerFrame != MessagesPerFrame - 1)
+				continue;
+			while (const Bousk::uint16 serialized = channel->serialize(buffer.data(), static_cast<Bousk::uint16>(buffer.size()), datagramId))
+			{
+				channel->onDatagramAcked(datagramId++);
+				size += serialized;
+			}
+		}
+		return size;
+	}
+}
+
+int main()
+{
+	const std::vector<std::vector<Bousk::uint8>> messages = Messages(NbMessages, 42);
+	//!< Sample of messages, generated apart from the ones sent
+	std::vector<Bousk::uint8> sample;
+	for (const std::vector<Bousk::uint8>& message : Messages(32, 7))
+		sample.insert(sample.end(), message.begin(), message.end());
+	const Bousk::Compression::Dictionary dictionary(std::move(sample));
+	//!< Blocks of 8 messages, as a datagram of a frame holds
+	std::vector<std::vector<Bousk::uint8>> blocks;
+	for (size_t i = 0; i < messages.size(); i += 8)
+	{
+		blocks.emplace_back();
+		for (size_t j = i; j < i + 8 && j < messages.size(); ++j)
+			blocks.back().insert(blocks.back().end(), messages[j].begin(), messages[j].end());
+	}
+	std::vector<std::vector<Bousk::uint8>> random(NbMessages / 8, std::vector<Bousk::uint8>(1000));
+	std::mt19937 generator(42);
+	for (std::vector<Bousk::uint8>& block : random)
+		for (Bousk::uint8& byte : block)
+			byte = static_cast<Bousk::uint8>(generator());
+
+	std::cout << NbMessages << " messages of " << blocks.front().size() / 8 << "B on average, dictionary of " << dictionary.size() << "B" << std::endl;
+	Print("Per message", Run(messages, nullptr));
+	Print("Per message, dictionary", Run(messages, &dictionary));
+	Print("Per 8 messages", Run(blocks, nullptr));
+	Print("Per 8 messages, dictionary", Run(blocks, &dictionary));
+	Print("Random data", Run(random, nullptr));
+
+	using Compressed = Bousk::Network::UDP::Protocols::Compressed;
+	using ReliableOrdered = Bousk::Network::UDP::Protocols::ReliableOrdered;
+	auto dictionaryCopy = std::make_shared<const Bousk::Compression::Dictionary>(std::vector<Bousk::uint8>(dictionary.data(), dictionary.data() + dictionary.size()));
+	const Bousk::uint64 uncompressed = ChannelSize(messages, std::make_unique<ReliableOrdered>());
+	std::cout << "ReliableOrdered channel, frames of 8 messages : " << uncompressed << "B of packets" << std::endl;
+	for (const Compressed::Mode mode : { Compressed::Mode::PerMessage, Compressed::Mode::PerDatagram })
+	{
+		const char* name = (mode == Compressed::Mode::PerMessage) ? "PerMessage" : "PerDatagram";
+		const Bousk::uint64 compressed = ChannelSize(messages, std::make_unique<Compressed>(std::make_unique<ReliableOrdered>(), mode));
+		const Bousk::uint64 withDictionary = ChannelSize(messages, std::make_unique<Compressed>(std::make_unique<ReliableOrdered>(), mode, dictionaryCopy));
+		std::cout << "  Compressed " << name << " : " << compressed << "B (" << 100 * compressed / uncompressed << "%), with dictionary : "
+			<< withDictionary << "B (" << 100 * withDictionary / uncompressed << "%)" << std::endl;
+	}
+	return 0;
+}
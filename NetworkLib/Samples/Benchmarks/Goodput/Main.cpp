@@ -0,0 +1,84 @@
+#include "UDP/AckHandler.hpp"
+#include "UDP/ChannelsHandler.hpp"
+#include "UDP/Datagram.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+
+#include <array>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Goodput of typical game traffic : share of the bytes sent over the network which are user data
+// Frames of small messages of 20 to 60 bytes, acks of a peer receiving datagrams with some loss
+
+namespace
+{
+	constexpr size_t NbFrames = 10000;
+	constexpr size_t MinMessageSize = 20;
+	constexpr size_t MaxMessageSize = 60;
+	constexpr size_t IPv4UDPHeadersSize = 20 + 8;
+
+	struct Result
+	{
+		Bousk::uint64 nbDatagrams{ 0 };
+		Bousk::uint64 payloadSize{ 0 };
+		Bousk::uint64 wireSize{ 0 };
+	};
+	Result Run(size_t messagesPerFrame, unsigned int lossPercent)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<size_t> messageSize(MinMessageSize, MaxMessageSize);
+		std::uniform_int_distribution<unsigned int> loss(0, 99);
+
+		Bousk::Network::UDP::ChannelsHandler channels;
+		channels.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		//!< Acks of the datagrams received from the other end, losing some of them
+		Bousk::Network::UDP::AckHandler receivedAcks;
+		Bousk::uint16 receivedId = 0;
+		std::array<Bousk::uint8, Bousk::Network::UDP::Datagram::BufferMaxSize> wire;
+
+		Result result;
+		Bousk::Network::UDP::Datagram::ID datagramId = 0;
+		for (size_t frame = 0; frame < NbFrames; ++frame)
+		{
+			if (loss(random) >= lossPercent)
+				receivedAcks.update(receivedId, 0);
+			++receivedId;
+
+			for (size_t i = 0; i < messagesPerFrame; ++i)
+			{
+				const size_t size = messageSize(random);
+				channels.queue(std::vector<Bousk::uint8>(size, static_cast<Bousk::uint8>(i)), 0);
+				result.payloadSize += size;
+			}
+			Bousk::Network::UDP::Datagram datagram;
+			while ((datagram.datasize = channels.serialize(datagram.data.data(), Bousk::Network::UDP::Datagram::DataMaxSize, datagramId)) != 0)
+			{
+				datagram.header.id = datagramId++;
+				datagram.header.ack = receivedAcks.lastAck();
+				datagram.header.previousAcks = receivedAcks.previousAcksMask();
+				datagram.header.type = Bousk::Network::UDP::Datagram::Type::ConnectedData;
+				result.wireSize += datagram.serialize(wire.data()) + IPv4UDPHeadersSize;
+				++result.nbDatagrams;
+			}
+		}
+		return result;
+	}
+}
+
+int main()
+{
+	std::cout << NbFrames << " frames of messages of " << MinMessageSize << " to " << MaxMessageSize << "B, a datagram per frame, " << IPv4UDPHeadersSize << "B of IPv4 and UDP headers counted" << std::endl;
+	for (const size_t messagesPerFrame : { 1, 4, 16 })
+	{
+		for (const unsigned int lossPercent : { 0, 5 })
+		{
+			const Result result = Run(messagesPerFrame, lossPercent);
+			const Bousk::uint64 overhead = result.wireSize - result.payloadSize;
+			std::cout << messagesPerFrame << " messages per frame, " << lossPercent << "% loss : "
+				<< overhead / static_cast<double>(result.nbDatagrams) << "B of headers per datagram - goodput "
+				<< 100. * result.payloadSize / result.wireSize << "%" << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "Address.hpp"
+#include "MPSCQueue.hpp"
+#include "Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Contention between threads queueing operations, as game logic threads calling UDP::Client::sendTo while the network thread runs processSend
+// Compares the former locked vector of operations with the lock-free queue of preallocated slots
+
+namespace
+{
+	constexpr size_t NbOperations = 1 << 20; //!< Shared between producers
+	constexpr size_t DataSize = 32;
+	constexpr size_t QueueSize = 4096;
+
+	struct Operation
+	{
+		Bousk::Network::Address target;
+		std::vector<Bousk::uint8> data;
+		Bousk::uint32 channel{ 0 };
+	};
+
+	class LockedQueue
+	{
+	public:
+		void push(const Bousk::Network::Address& target, const Bousk::uint8* data, size_t dataSize)
+		{
+			std::lock_guard<std::mutex> lock(mLock);
+			mOperations.push_back(Operation{ target, std::vector<Bousk::uint8>(data, data + dataSize), 0 });
+		}
+		template<class Consume>
+		size_t consume(Consume&& consumer)
+		{
+			std::vector<Operation> operations;
+			{
+				std::lock_guard<std::mutex> lock(mLock);
+				operations.swap(mOperations);
+			}
+			for (Operation& op : operations)
+				consumer(op);
+			return operations.size();
+		}
+	private:
+		std::mutex mLock;
+		std::vector<Operation> mOperations;
+	};
+
+	class LockFreeQueue
+	{
+	public:
+		void push(const Bousk::Network::Address& target, const Bousk::uint8* data, size_t dataSize)
+		{
+			mOperations.push([&](Operation& op) { op.target = target; op.data.assign(data, data + dataSize); op.channel = 0; });
+		}
+		template<class Consume>
+		size_t consume(Consume&& consumer) { return mOperations.consume(consumer); }
+		size_t nbOverflows() const { return mOperations.nbOverflows(); }
+	private:
+		Bousk::MPSCQueue<Operation> mOperations{ QueueSize };
+	};
+
+	// Returns the number of operations per second
+	template<class Queue>
+	double Run(Queue& queue, size_t nbProducers)
+	{
+		const Bousk::Network::Address target("127.0.0.1", 8888);
+		const std::vector<Bousk::uint8> data(DataSize, 42);
+		std::atomic<bool> start{ false };
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < nbProducers; ++i)
+		{
+			producers.emplace_back([&]()
+			{
+				while (!start)
+					std::this_thread::yield();
+				for (size_t op = 0; op < NbOperations / nbProducers; ++op)
+					queue.push(target, data.data(), data.size());
+			});
+		}
+
+		const size_t nbExpected = (NbOperations / nbProducers) * nbProducers;
+		size_t nbConsumed = 0;
+		std::vector<Bousk::uint8> sink;
+		const auto startTime = std::chrono::steady_clock::now();
+		start = true;
+		while (nbConsumed < nbExpected)
+		{
+			//!< The consumer takes the data, as processSend hands it to the distant client
+			nbConsumed += queue.consume([&](Operation& op) { sink = std::move(op.data); });
+		}
+		const auto duration = std::chrono::steady_clock::now() - startTime;
+		for (std::thread& producer : producers)
+			producer.join();
+		return nbConsumed / std::chrono::duration<double>(duration).count();
+	}
+}
+
+int main()
+{
+	std::cout << NbOperations << " operations of " << DataSize << " bytes, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	for (size_t nbProducers = 1; nbProducers <= 16; nbProducers *= 2)
+	{
+		LockedQueue lockedQueue;
+		const double locked = Run(lockedQueue, nbProducers);
+		LockFreeQueue lockFreeQueue;
+		const double lockFree = Run(lockFreeQueue, nbProducers);
+		std::cout << nbProducers << " producers : locked " << static_cast<Bousk::uint64>(locked) << " ops/s - lock-free " << static_cast<Bousk::uint64>(lockFree) << " ops/s"
+			<< " (" << lockFreeQueue.nbOverflows() << " overflows) - x" << lockFree / locked << std::endl;
+	}
+	return 0;
+}
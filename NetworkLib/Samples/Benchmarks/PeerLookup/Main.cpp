@@ -0,0 +1,123 @@
+#include "Sockets.hpp"
+#include "Address.hpp"
+#include "UDP/UDPClient.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+#include "Errors.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Cost of finding the distant client of an address, as done for every received datagram and every queued operation
+// Compares the former linear search with the hashed address table, then measures operations going through a Client
+
+namespace
+{
+	constexpr size_t NbLookups = 1000000;
+	constexpr size_t NbOperationsPerPeer = 10; //!< Keep per peer queues small so that their cost doesn't hide the lookup one
+	constexpr Bousk::uint16 ClientPort = 8888;
+
+	std::vector<Bousk::Network::Address> CreatePeers(size_t nbPeers)
+	{
+		// Spread peers over ips and ports, as seen by a server behind NATs
+		std::vector<Bousk::Network::Address> peers;
+		peers.reserve(nbPeers);
+		for (size_t i = 0; i < nbPeers; ++i)
+		{
+			const std::string ip = "127.0." + std::to_string((i / 250) % 250) + "." + std::to_string(1 + i % 250);
+			peers.emplace_back(ip, static_cast<Bousk::uint16>(20000 + i % 40000));
+		}
+		return peers;
+	}
+	std::vector<size_t> CreateAccesses(size_t nbPeers, size_t nbAccesses)
+	{
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<size_t> distribution(0, nbPeers - 1);
+		std::vector<size_t> accesses(nbAccesses);
+		for (size_t& access : accesses)
+			access = distribution(generator);
+		return accesses;
+	}
+	double NanosecondsPer(std::chrono::steady_clock::duration duration, size_t count)
+	{
+		return std::chrono::duration<double, std::nano>(duration).count() / count;
+	}
+
+	void BenchmarkLookups(size_t nbPeers)
+	{
+		const std::vector<Bousk::Network::Address> peers = CreatePeers(nbPeers);
+		// Lookups are done from a copy of the address, as the one built from each received datagram
+		std::vector<Bousk::Network::Address> lookups;
+		for (size_t index : CreateAccesses(nbPeers, NbLookups))
+			lookups.emplace_back(peers[index].storage());
+
+		size_t found = 0;
+		const size_t nbLinearLookups = std::min(NbLookups, 100000000 / nbPeers); //!< Keep linear runs reasonable with lots of peers
+		const auto linearStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < nbLinearLookups; ++i)
+		{
+			const Bousk::Network::Address& address = lookups[i];
+			found += std::find_if(peers.begin(), peers.end(), [&](const Bousk::Network::Address& peer) { return peer == address; }) != peers.end();
+		}
+		const auto linearDuration = std::chrono::steady_clock::now() - linearStart;
+
+		std::unordered_map<Bousk::Network::Address::Key, size_t, Bousk::Network::Address::Key::Hash> indices;
+		for (size_t i = 0; i < peers.size(); ++i)
+			indices.emplace(peers[i].key(), i);
+		const auto hashedStart = std::chrono::steady_clock::now();
+		for (const Bousk::Network::Address& address : lookups)
+			found += indices.find(address.key()) != indices.end();
+		const auto hashedDuration = std::chrono::steady_clock::now() - hashedStart;
+
+		std::cout << nbPeers << " peers : linear " << NanosecondsPer(linearDuration, nbLinearLookups) << "ns - hashed " << NanosecondsPer(hashedDuration, NbLookups) << "ns per lookup"
+			<< " (" << found << " found)" << std::endl;
+	}
+
+	void BenchmarkOperations(size_t nbPeers)
+	{
+		const std::vector<Bousk::Network::Address> peers = CreatePeers(nbPeers);
+		Bousk::Network::UDP::Client client;
+		client.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		if (!client.init(ClientPort))
+		{
+			std::cout << "Client initialisation error : " << Bousk::Network::Errors::Get() << std::endl;
+			return;
+		}
+		for (const Bousk::Network::Address& peer : peers)
+			client.connect(peer);
+		client.processSend();
+
+		const Bousk::uint8 data[] = { 'b', 'e', 'n', 'c', 'h' };
+		const size_t nbOperations = nbPeers * NbOperationsPerPeer;
+		for (size_t index : CreateAccesses(nbPeers, nbOperations))
+			client.sendTo(peers[index], data, sizeof(data), 0);
+		const auto start = std::chrono::steady_clock::now();
+		client.processSend();
+		const auto duration = std::chrono::steady_clock::now() - start;
+		std::cout << nbPeers << " peers : processSend " << NanosecondsPer(duration, nbOperations) << "ns per sendTo operation" << std::endl;
+		client.release();
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	const size_t peersCounts[] = { 10, 1000, 10000 };
+	std::cout << "Address lookups" << std::endl;
+	for (size_t nbPeers : peersCounts)
+		BenchmarkLookups(nbPeers);
+	std::cout << "Client operations" << std::endl;
+	for (size_t nbPeers : peersCounts)
+		BenchmarkOperations(nbPeers);
+
+	Bousk::Network::Release();
+	return 0;
+}
@@ -0,0 +1,163 @@
+#include "Sockets.hpp"
+#include "UDP/UDPClient.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+#include "Messages.hpp"
+#include "Errors.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+// Cost of receiving small messages : heap allocations and time spent by the receiving client, from the socket until the application drops the messages
+// A sender client streams small messages to a receiver client on loopback, both updated by this thread
+// The receiver polls either messages, allocated one by one, or compact events
+
+namespace
+{
+	constexpr Bousk::uint16 ReceiverPort = 8888;
+	constexpr Bousk::uint16 SenderPort = 8889;
+	constexpr size_t MessageSize = 16;
+	constexpr size_t MessagesPerFrame = 64;
+	constexpr size_t NbFrames = 20000;
+
+	//!< Only allocations done by the receiver are counted
+	thread_local bool CountAllocations = false;
+	thread_local Bousk::uint64 NbAllocations = 0;
+}
+
+void* operator new(size_t size)
+{
+	if (CountAllocations)
+		++NbAllocations;
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+	bool Connect(Bousk::Network::UDP::Client& sender, Bousk::Network::UDP::Client& receiver)
+	{
+		const Bousk::Network::Address receiverAddress = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, ReceiverPort);
+		sender.connect(receiverAddress);
+		bool senderConnected = false;
+		bool receiverConnected = false;
+		const auto start = std::chrono::steady_clock::now();
+		while (!(senderConnected && receiverConnected) && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+		{
+			sender.processSend();
+			receiver.wait(std::chrono::milliseconds(10));
+			receiver.receive();
+			for (auto&& message : receiver.poll())
+			{
+				if (message->is<Bousk::Network::Messages::IncomingConnection>())
+					receiver.connect(message->emitter());
+				else if (message->is<Bousk::Network::Messages::Connection>())
+					receiverConnected = true;
+			}
+			receiver.processSend();
+			sender.wait(std::chrono::milliseconds(10));
+			sender.receive();
+			for (auto&& message : sender.poll())
+			{
+				if (message->is<Bousk::Network::Messages::Connection>())
+					senderConnected = true;
+			}
+		}
+		return senderConnected && receiverConnected;
+	}
+
+	template<class Message>
+	void Count(const Message& msg, Bousk::uint64& nbMessages, Bousk::uint64& nbBytes)
+	{
+		if (msg.template is<Bousk::Network::Messages::UserData>())
+		{
+			++nbMessages;
+			nbBytes += msg.template as<Bousk::Network::Messages::UserData>()->data.size();
+		}
+	}
+
+	bool Run(bool events)
+	{
+		Bousk::Network::UDP::Client sender;
+		Bousk::Network::UDP::Client receiver;
+		sender.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		receiver.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		if (!sender.init(SenderPort) || !receiver.init(ReceiverPort))
+		{
+			std::cout << "Client initialisation error : " << Bousk::Network::Errors::Get() << std::endl;
+			return false;
+		}
+		if (!Connect(sender, receiver))
+		{
+			std::cout << "Connection failed" << std::endl;
+			return false;
+		}
+
+		const Bousk::Network::Address receiverAddress = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, ReceiverPort);
+		const std::vector<Bousk::uint8> message(MessageSize, 42);
+		std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages;
+		std::vector<Bousk::Network::Messages::Event> frameEvents;
+		Bousk::uint64 nbMessages = 0;
+		Bousk::uint64 nbBytes = 0;
+		NbAllocations = 0;
+		std::chrono::steady_clock::duration receiveDuration{ 0 };
+		for (size_t frame = 0; frame < NbFrames; ++frame)
+		{
+			for (size_t i = 0; i < MessagesPerFrame; ++i)
+				sender.sendTo(receiverAddress, message.data(), message.size(), 0);
+			sender.processSend();
+			sender.receive();
+			sender.poll();
+
+			const auto start = std::chrono::steady_clock::now();
+			CountAllocations = true;
+			receiver.receive();
+			if (events)
+			{
+				receiver.pollEvents(frameEvents);
+				for (const Bousk::Network::Messages::Event& event : frameEvents)
+					Count(event, nbMessages, nbBytes);
+				frameEvents.clear(); //!< Events are dropped by the application : their buffers can be reused
+			}
+			else
+			{
+				receiver.poll(messages);
+				for (const auto& msg : messages)
+					Count(*msg, nbMessages, nbBytes);
+				messages.clear(); //!< Messages are dropped by the application : their buffers can be reused
+			}
+			receiver.processSend();
+			CountAllocations = false;
+			receiveDuration += std::chrono::steady_clock::now() - start;
+		}
+
+		const double seconds = std::chrono::duration<double>(receiveDuration).count();
+		std::cout << (events ? "Events   : " : "Messages : ") << nbMessages << "/" << NbFrames * MessagesPerFrame << " messages of " << MessageSize << " bytes received (" << nbBytes << " bytes)"
+			<< " - " << NbAllocations << " allocations - " << static_cast<double>(NbAllocations) / nbMessages << " per message"
+			<< " - " << static_cast<Bousk::uint64>(nbMessages / seconds) << " messages/s" << std::endl;
+
+		sender.release();
+		receiver.release();
+		return true;
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	if (!Run(false) || !Run(true))
+		return -2;
+
+	Bousk::Network::Release();
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include "Sockets.hpp"
+#include "Address.hpp"
+#include "UDP/UDPClient.hpp"
+#include "UDP/Protocols/ReliableOrdered.hpp"
+#include "Errors.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Delivery latency of reliable messages over a lossy link, emulated by the simulator of both ends
+// A message is sent every frame, at a rate low enough that lost datagrams are not quickly followed by 64 others
+
+namespace
+{
+	constexpr Bousk::uint16 SenderPort = 8888;
+	constexpr Bousk::uint16 ReceiverPort = 8889;
+	constexpr std::chrono::milliseconds FrameDuration{ 10 };
+	constexpr size_t NbMessages = 500;
+
+	struct Peer
+	{
+		Bousk::Network::UDP::Client client;
+		std::vector<Bousk::Network::Messages::Event> events;
+	};
+	bool Init(Peer& peer, Bousk::uint16 port, Bousk::uint8 lossRate)
+	{
+		peer.client.registerChannel<Bousk::Network::UDP::Protocols::ReliableOrdered>();
+		peer.client.simulator().enable();
+		peer.client.simulator().seed(port);
+		peer.client.simulator().setLossRate(lossRate);
+		peer.client.simulator().setDelay(20, 10);
+		if (!peer.client.init(port))
+		{
+			std::cout << "Client initialisation error : " << Bousk::Network::Errors::Get() << std::endl;
+			return false;
+		}
+		return true;
+	}
+	template<class OnEvent>
+	void Step(Peer& peer, OnEvent&& onEvent)
+	{
+		peer.client.receive();
+		peer.events.clear();
+		peer.client.pollEvents(peer.events);
+		for (const Bousk::Network::Messages::Event& event : peer.events)
+		{
+			if (event.is<Bousk::Network::Messages::IncomingConnection>())
+				peer.client.connect(peer.client.address(event.emitterId()));
+			else
+				onEvent(event);
+		}
+		peer.client.processSend();
+	}
+	double Percentile(const std::vector<double>& sortedValues, double percentile)
+	{
+		return sortedValues[std::min(sortedValues.size() - 1, static_cast<size_t>(percentile * sortedValues.size()))];
+	}
+
+	void Run(Bousk::uint8 lossRate)
+	{
+		Peer sender;
+		Peer receiver;
+		if (!Init(sender, SenderPort, lossRate) || !Init(receiver, ReceiverPort, lossRate))
+			return;
+		const Bousk::Network::Address receiverAddress = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, ReceiverPort);
+
+		std::vector<double> latencies; //!< In milliseconds
+		latencies.reserve(NbMessages);
+		size_t nbSent = 0;
+		auto nextSend = std::chrono::steady_clock::now();
+		const auto end = nextSend + FrameDuration * NbMessages + std::chrono::seconds(10);
+		while (latencies.size() < NbMessages && std::chrono::steady_clock::now() < end)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if (nbSent < NbMessages && now >= nextSend)
+			{
+				// Each message holds its send time
+				const Bousk::int64 sendTime = now.time_since_epoch().count();
+				std::vector<Bousk::uint8> message(sizeof(sendTime));
+				memcpy(message.data(), &sendTime, sizeof(sendTime));
+				sender.client.sendTo(receiverAddress, std::move(message), 0);
+				++nbSent;
+				nextSend += FrameDuration;
+			}
+			Step(sender, [](const Bousk::Network::Messages::Event&) {});
+			Step(receiver, [&](const Bousk::Network::Messages::Event& event)
+			{
+				if (!event.is<Bousk::Network::Messages::UserData>())
+					return;
+				Bousk::int64 sendTime;
+				memcpy(&sendTime, event.as<Bousk::Network::Messages::UserData>()->data.data(), sizeof(sendTime));
+				const auto latency = std::chrono::steady_clock::now() - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(sendTime));
+				latencies.push_back(std::chrono::duration<double, std::milli>(latency).count());
+			});
+			receiver.client.wait(std::chrono::milliseconds(1));
+		}
+		const Bousk::uint64 nbReceiverDatagrams = receiver.client.nbDatagramsSent();
+		sender.client.release();
+		receiver.client.release();
+
+		std::cout << static_cast<int>(lossRate) << "% loss : " << latencies.size() << "/" << NbMessages << " messages received, " << nbReceiverDatagrams << " datagrams sent back";
+		if (!latencies.empty())
+		{
+			std::sort(latencies.begin(), latencies.end());
+			std::cout << " - latency p50 " << Percentile(latencies, 0.5) << "ms, p99 " << Percentile(latencies, 0.99) << "ms, max " << latencies.back() << "ms";
+		}
+		std::cout << std::endl;
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	std::cout << "One reliable message every " << FrameDuration.count() << "ms, 20-30ms delay each way" << std::endl;
+	const Bousk::uint8 lossRates[] = { 0, 1, 5 };
+	for (Bousk::uint8 lossRate : lossRates)
+		Run(lossRate);
+	// Acks delayed for a few messages, costing some latency to loss detection
+	const std::chrono::milliseconds maxAckDelay(2 * FrameDuration);
+	const Bousk::uint8 ackFrequency = 3;
+	std::cout << "Acks delayed up to " << maxAckDelay.count() << "ms or " << static_cast<int>(ackFrequency) << " datagrams" << std::endl;
+	Bousk::Network::UDP::Client::SetAckPolicy(maxAckDelay, ackFrequency);
+	for (Bousk::uint8 lossRate : lossRates)
+		Run(lossRate);
+
+	Bousk::Network::Release();
+	return 0;
+}
@@ -0,0 +1,171 @@
+#include "Float.hpp"
+#include "RangedInteger.hpp"
+#include "Replication/Snapshot.hpp"
+#include "Serialization/Serializer.hpp"
+#include "UDP/ChannelsHandler.hpp"
+#include "UDP/Datagram.hpp"
+#include "UDP/Protocols/SnapshotDelta.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Bandwidth of replicating a scene of objects, mostly static, with a snapshot per tick
+// Full snapshots serialized as is against deltas to the last snapshot acked on a SnapshotDelta channel, acks coming back after a delay and with some loss
+
+namespace
+{
+	constexpr size_t NbObjects = 1000;
+	constexpr size_t NbTicks = 1000;
+	constexpr size_t AckDelay = 6; //!< In ticks, 100ms at 60Hz
+	constexpr size_t NbFinalTicks = AckDelay + 2; //!< Without changes nor loss, for the receiver to end with the last state
+
+	struct Entity : public Bousk::Network::Replication::Object, public Bousk::Serialization::Serializable
+	{
+		Bousk::Float32<-1000, 1000, 2> x{ 0.f };
+		Bousk::Float32<-1000, 1000, 2> y{ 0.f };
+		Bousk::Float32<-1000, 1000, 2> z{ 0.f };
+		Bousk::Float32<-180, 180, 1> yaw{ 0.f };
+		Bousk::RangedInteger<0, 1000> health{ 1000 };
+		Bousk::RangedInteger<0, 7> team{ 0 };
+		Bousk::RangedInteger<0, 255> model{ 0 };
+		bool visible{ true };
+
+		void write(Bousk::Network::Replication::FieldsWriter& writer) const override
+		{
+			writer.write(x);
+			writer.write(y);
+			writer.write(z);
+			writer.write(yaw);
+			writer.write(health);
+			writer.write(team);
+			writer.write(model);
+			writer.write(visible);
+		}
+		bool read(Bousk::Network::Replication::FieldsReader& reader) override
+		{
+			return reader.read(x) && reader.read(y) && reader.read(z) && reader.read(yaw) && reader.read(health) && reader.read(team) && reader.read(model) && reader.read(visible);
+		}
+		bool write(Bousk::Serialization::Serializer& serializer) const override
+		{
+			return serializer.write(x) && serializer.write(y) && serializer.write(z) && serializer.write(yaw)
+				&& health.write(serializer) && team.write(serializer) && model.write(serializer) && serializer.write(visible);
+		}
+		bool read(Bousk::Serialization::Deserializer&) override { return false; }
+	};
+
+	struct Result
+	{
+		Bousk::uint64 fullSize{ 0 }; //!< Serializer writing each object id and fields
+		Bousk::uint64 snapshotsSize{ 0 }; //!< Replication::Snapshot::serialize
+		Bousk::uint64 deltaSize{ 0 }; //!< Datagrams data of the SnapshotDelta channel
+		Bousk::uint64 nbDatagrams{ 0 };
+		Bousk::uint64 nbReceived{ 0 };
+		bool isReceiverInSync{ false };
+	};
+	Result Run(unsigned int movingPerMille, unsigned int lossPercent)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<unsigned int> perMille(0, 999);
+		std::uniform_int_distribution<unsigned int> loss(0, 99);
+		std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+		std::uniform_real_distribution<float> move(-1.f, 1.f);
+
+		std::vector<Entity> entities(NbObjects);
+		for (size_t i = 0; i < NbObjects; ++i)
+		{
+			entities[i].x = position(random);
+			entities[i].y = position(random);
+			entities[i].z = position(random) / 10.f;
+			entities[i].team = static_cast<Bousk::uint8>(i % 8);
+			entities[i].model = static_cast<Bousk::uint8>(random() % 256);
+		}
+
+		Bousk::Network::UDP::ChannelsHandler sender;
+		sender.registerChannel<Bousk::Network::UDP::Protocols::SnapshotDelta>();
+		Bousk::Network::UDP::ChannelsHandler receiver;
+		receiver.registerChannel<Bousk::Network::UDP::Protocols::SnapshotDelta>();
+		//!< Datagrams sent, waiting for their ack or loss to be known
+		struct InFlight
+		{
+			size_t ackTick;
+			Bousk::Network::UDP::Datagram::ID id;
+			bool isLost;
+		};
+		std::deque<InFlight> inFlight;
+		Bousk::Network::UDP::Datagram::ID datagramId = 0;
+		std::vector<Bousk::uint8> lastSnapshot;
+		std::vector<Bousk::uint8> lastReceived;
+
+		Result result;
+		for (size_t tick = 0; tick < NbTicks + NbFinalTicks; ++tick)
+		{
+			const bool isFinalTick = (tick >= NbTicks);
+			for (; !inFlight.empty() && inFlight.front().ackTick <= tick; inFlight.pop_front())
+			{
+				if (inFlight.front().isLost)
+					sender.onDatagramLost(inFlight.front().id);
+				else
+					sender.onDatagramAcked(inFlight.front().id);
+			}
+
+			Bousk::Network::Replication::Snapshot snapshot;
+			Bousk::Serialization::Serializer full;
+			for (size_t i = 0; i < NbObjects; ++i)
+			{
+				Entity& entity = entities[i];
+				if (!isFinalTick && tick != 0 && perMille(random) < movingPerMille)
+				{
+					entity.x = std::min(std::max(entity.x.get() + move(random), -1000.f), 1000.f);
+					entity.y = std::min(std::max(entity.y.get() + move(random), -1000.f), 1000.f);
+					entity.yaw = std::min(std::max(entity.yaw.get() + 10.f * move(random), -180.f), 180.f);
+				}
+				snapshot.add(static_cast<Bousk::Network::Replication::ObjectId>(i), entity);
+				full.write(static_cast<Bousk::uint32>(i));
+				full.write(entity);
+			}
+			lastSnapshot = snapshot.serialize();
+			result.fullSize += full.bufferSize();
+			result.snapshotsSize += lastSnapshot.size();
+
+			sender.queue(std::vector<Bousk::uint8>(lastSnapshot), 0);
+			Bousk::Network::UDP::Datagram datagram;
+			while ((datagram.datasize = sender.serialize(datagram.data.data(), Bousk::Network::UDP::Datagram::DataMaxSize, datagramId)) != 0)
+			{
+				const bool isLost = !isFinalTick && loss(random) < lossPercent;
+				if (!isLost)
+					receiver.onDataReceived(datagram.data.data(), datagram.datasize);
+				inFlight.push_back({ tick + AckDelay, datagramId++, isLost });
+				result.deltaSize += datagram.datasize;
+				++result.nbDatagrams;
+			}
+			for (const Bousk::Network::Payload& message : receiver.process(true))
+			{
+				lastReceived = message.toVector();
+				++result.nbReceived;
+			}
+		}
+		result.isReceiverInSync = (lastReceived == lastSnapshot);
+		return result;
+	}
+}
+
+int main()
+{
+	std::cout << NbObjects << " objects of 8 fields, " << NbTicks << " ticks, acks received " << AckDelay << " ticks later" << std::endl;
+	for (const unsigned int movingPerMille : { 0, 10, 50, 200 })
+	{
+		for (const unsigned int lossPercent : { 0, 5 })
+		{
+			const Result result = Run(movingPerMille, lossPercent);
+			std::cout << movingPerMille / 10. << "% moving per tick, " << lossPercent << "% loss : full " << result.fullSize / (NbTicks + NbFinalTicks)
+				<< "B per tick, snapshot " << result.snapshotsSize / (NbTicks + NbFinalTicks)
+				<< "B, delta " << result.deltaSize / (NbTicks + NbFinalTicks) << "B in " << static_cast<double>(result.nbDatagrams) / (NbTicks + NbFinalTicks)
+				<< " datagrams - " << static_cast<double>(result.fullSize) / result.deltaSize << "x less than full, "
+				<< result.nbReceived << " snapshots received" << (result.isReceiverInSync ? "" : ", RECEIVER OUT OF SYNC") << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "Sockets.hpp"
+#include "Address.hpp"
+#include "UDP/Datagram.hpp"
+#include "UDP/DatagramBatch.hpp"
+#include "Errors.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+// Compare plain batched datagrams with segmentation/receive offloads (GSO/GRO) on loopback
+// A single sender streams full datagrams to a single receiver, as a bulk peer (spectator relay, replay streaming) would get
+
+namespace
+{
+	constexpr Bousk::uint16 ReceiverPort = 8888;
+	constexpr size_t DatagramsToSend = 500000;
+	constexpr size_t DatagramsPerFrame = 64;
+
+	struct Result
+	{
+		size_t received{ 0 };
+		double seconds{ 0 };
+		double cpuSeconds{ 0 };
+		float averageReceiveBatch{ 0 };
+		Bousk::uint64 sendSystemCalls{ 0 };
+	};
+
+	SOCKET CreateSocket(Bousk::uint16 port)
+	{
+		SOCKET sckt = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (sckt == INVALID_SOCKET)
+			return sckt;
+		const int bufferSize = 8 * 1024 * 1024;
+		setsockopt(sckt, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+		setsockopt(sckt, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+		if (!Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, port).bind(sckt) || !Bousk::Network::SetNonBlocking(sckt))
+		{
+			Bousk::Network::CloseSocket(sckt);
+			return INVALID_SOCKET;
+		}
+		return sckt;
+	}
+
+	bool Run(bool offload, Result& result)
+	{
+		SOCKET receiverSocket = CreateSocket(ReceiverPort);
+		SOCKET senderSocket = CreateSocket(0);
+		if (receiverSocket == INVALID_SOCKET || senderSocket == INVALID_SOCKET)
+			return false;
+
+		Bousk::Network::UDP::ReceiveBatch receiveBatch;
+		Bousk::Network::UDP::SendBatch sendBatch;
+		if (offload)
+		{
+			const bool segmentation = sendBatch.setSegmentation(senderSocket, true);
+			const bool coalescing = receiveBatch.setCoalescing(receiverSocket, true);
+			std::cout << "  GSO " << (segmentation ? "enabled" : "unavailable") << ", GRO " << (coalescing ? "enabled" : "unavailable") << std::endl;
+		}
+
+		std::atomic<bool> senderDone{ false };
+		const auto start = std::chrono::steady_clock::now();
+		const std::clock_t cpuStart = std::clock();
+		std::thread receiver([&]()
+		{
+			auto lastReceived = std::chrono::steady_clock::now();
+			while (result.received < DatagramsToSend)
+			{
+				pollfd fd{ receiverSocket, POLLIN, 0 };
+				poll(&fd, 1, 10);
+				const int nbReceived = receiveBatch.receive(receiverSocket);
+				if (nbReceived > 0)
+				{
+					result.received += nbReceived;
+					lastReceived = std::chrono::steady_clock::now();
+				}
+				else if (senderDone && std::chrono::steady_clock::now() - lastReceived > std::chrono::milliseconds(200))
+				{
+					break; //!< Remaining datagrams have been lost
+				}
+			}
+		});
+
+		const Bousk::Network::Address target = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, ReceiverPort);
+		Bousk::Network::UDP::Datagram datagram;
+		datagram.header = {};
+		datagram.datasize = Bousk::Network::UDP::Datagram::DataMaxSize;
+		for (size_t sent = 0; sent < DatagramsToSend; )
+		{
+			for (size_t i = 0; i < DatagramsPerFrame && sent < DatagramsToSend; ++i, ++sent)
+			{
+				datagram.header.id = static_cast<Bousk::uint16>(sent);
+				sendBatch.queue(datagram, target.storage());
+			}
+			sendBatch.flush(senderSocket);
+			while (!sendBatch.empty())
+			{
+				//!< Socket buffer full : wait for it to be writable again
+				pollfd fd{ senderSocket, POLLOUT, 0 };
+				poll(&fd, 1, 10);
+				sendBatch.flush(senderSocket);
+			}
+		}
+		senderDone = true;
+		receiver.join();
+
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+		result.averageReceiveBatch = receiveBatch.averageSize();
+		result.sendSystemCalls = sendBatch.nbSystemCalls();
+		Bousk::Network::CloseSocket(receiverSocket);
+		Bousk::Network::CloseSocket(senderSocket);
+		return true;
+	}
+
+	void Print(const char* name, const Result& result)
+	{
+		std::cout << name << " : " << result.received << "/" << DatagramsToSend << " datagrams received in " << result.seconds << "s"
+			<< " - " << static_cast<Bousk::uint64>(result.received / result.seconds) << " pps"
+			<< " - CPU " << result.cpuSeconds << "s (" << static_cast<Bousk::uint64>(result.received / result.cpuSeconds) << " datagrams per CPU second)"
+			<< " - " << result.sendSystemCalls << " send system calls"
+			<< " - " << result.averageReceiveBatch << " datagrams per receive system call" << std::endl;
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	Result plain;
+	std::cout << "Plain batches..." << std::endl;
+	if (!Run(false, plain))
+	{
+		std::cout << "Socket initialisation error : " << Bousk::Network::Errors::Get();
+		return -2;
+	}
+	Result offload;
+	std::cout << "Segmentation offload batches..." << std::endl;
+	if (!Run(true, offload))
+	{
+		std::cout << "Socket initialisation error : " << Bousk::Network::Errors::Get();
+		return -2;
+	}
+	Print("Plain  ", plain);
+	Print("Offload", offload);
+
+	Bousk::Network::Release();
+	return 0;
+}
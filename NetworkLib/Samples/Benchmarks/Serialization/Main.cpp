@@ -0,0 +1,178 @@
+#include "RangedInteger.hpp"
+#include "Serialization/Deserializer.hpp"
+#include "Serialization/Serializer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Cost of serializing RangedInteger fields of mixed sizes
+// Against the previous Serializer, which wrote bits a byte at a time, kept here as reference : both must write the same bytes
+
+namespace
+{
+	constexpr size_t NbFields = 1000000;
+	constexpr size_t NbRepeats = 10;
+
+	//!< Previous implementation of Serializer::writeBits
+	class ReferenceSerializer
+	{
+	public:
+		bool write(const Bousk::uint64 data, const Bousk::uint64 range)
+		{
+			Bousk::uint8 conv[8];
+			for (int i = 0; i < 8; ++i)
+				conv[i] = static_cast<Bousk::uint8>(data >> (56 - 8 * i));
+			return writeBits(conv, 8, CountNeededBits(range));
+		}
+		const std::vector<Bousk::uint8>& buffer() const { return mBuffer; }
+
+	private:
+		static Bousk::uint8 CountNeededBits(Bousk::uint64 v)
+		{
+			Bousk::uint8 bits = 0;
+			while (v)
+			{
+				++bits;
+				v /= 2;
+			}
+			return bits;
+		}
+		static Bousk::uint8 CreateRightBitsMask(const Bousk::uint8 rightBits)
+		{
+			switch (rightBits)
+			{
+			case 1: return 0b00000001;
+			case 2: return 0b00000011;
+			case 3: return 0b00000111;
+			case 4: return 0b00001111;
+			case 5: return 0b00011111;
+			case 6: return 0b00111111;
+			case 7: return 0b01111111;
+			default: return 0b11111111;
+			}
+		}
+		bool writeBits(const Bousk::uint8* const buffer, const Bousk::uint8 buffersize, const Bousk::uint8 nbBits)
+		{
+			Bousk::uint8 totalWrittenBits = 0;
+			for (Bousk::uint8 readingBytesOffset = 1; readingBytesOffset <= buffersize && totalWrittenBits < nbBits; ++readingBytesOffset)
+			{
+				const Bousk::uint8 srcByte = *(buffer + buffersize - readingBytesOffset);
+				const Bousk::uint8 bitsToWrite = static_cast<Bousk::uint8>(std::min(8, nbBits - totalWrittenBits));
+				Bousk::uint8 writtenBits = 0;
+				if (mUsedBits)
+				{
+					const Bousk::uint8 remainingBitsInCurrentByte = 8 - mUsedBits;
+					const Bousk::uint8 nbBitsToPack = std::min(bitsToWrite, remainingBitsInCurrentByte);
+					const Bousk::uint8 rightBitsToPack = srcByte & CreateRightBitsMask(nbBitsToPack);
+					mBuffer.back() |= rightBitsToPack << (remainingBitsInCurrentByte - nbBitsToPack);
+					writtenBits += nbBitsToPack;
+				}
+				const Bousk::uint8 remainingBits = bitsToWrite - writtenBits;
+				if (remainingBits)
+				{
+					const Bousk::uint8 leftBitsToPack = srcByte & (CreateRightBitsMask(remainingBits) << writtenBits);
+					mBuffer.push_back(static_cast<Bousk::uint8>(leftBitsToPack << (8 - writtenBits - remainingBits)));
+					writtenBits += remainingBits;
+				}
+				totalWrittenBits += writtenBits;
+				mUsedBits += writtenBits;
+				mUsedBits %= 8;
+			}
+			return totalWrittenBits == nbBits;
+		}
+
+	private:
+		std::vector<Bousk::uint8> mBuffer;
+		Bousk::uint8 mUsedBits{ 0 };
+	};
+
+	//!< Typical fields of a game state : flags, small counters, angles, positions, identifiers
+	struct Fields
+	{
+		std::vector<Bousk::RangedInteger<0, 1>> flags;
+		std::vector<Bousk::RangedInteger<-100, 100>> counters;
+		std::vector<Bousk::RangedInteger<0, 3599>> angles;
+		std::vector<Bousk::RangedInteger<-1000000, 1000000>> positions;
+		std::vector<Bousk::RangedInteger<0, 0xFFFFFFFFFFll>> identifiers;
+	};
+	template<class RANGEDINTEGER>
+	void Generate(std::vector<RANGEDINTEGER>& values, const size_t nbValues, std::mt19937_64& random)
+	{
+		std::uniform_int_distribution<typename RANGEDINTEGER::Type> distribution(RANGEDINTEGER::Min(), RANGEDINTEGER::Max());
+		for (size_t i = 0; i < nbValues; ++i)
+			values.emplace_back(distribution(random));
+	}
+	template<class RANGEDINTEGER>
+	void WriteReference(ReferenceSerializer& serializer, const RANGEDINTEGER& value)
+	{
+		serializer.write(static_cast<Bousk::uint64>(value.get()) - static_cast<Bousk::uint64>(RANGEDINTEGER::Min()), static_cast<Bousk::uint64>(RANGEDINTEGER::Range));
+	}
+
+	template<class SERIALIZER, class WRITE>
+	std::chrono::nanoseconds Time(const Fields& fields, std::vector<Bousk::uint8>& buffer, WRITE&& write)
+	{
+		std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+		for (size_t repeat = 0; repeat < NbRepeats; ++repeat)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			SERIALIZER serializer;
+			for (size_t i = 0; i < fields.flags.size(); ++i)
+			{
+				write(serializer, fields.flags[i]);
+				write(serializer, fields.counters[i]);
+				write(serializer, fields.angles[i]);
+				write(serializer, fields.positions[i]);
+				write(serializer, fields.identifiers[i]);
+			}
+			best = std::min<std::chrono::nanoseconds>(best, std::chrono::steady_clock::now() - start);
+			buffer = std::vector<Bousk::uint8>(serializer.buffer(), serializer.buffer() + serializer.bufferSize());
+		}
+		return best;
+	}
+}
+
+int main()
+{
+	std::mt19937_64 random(42);
+	Fields fields;
+	Generate(fields.flags, NbFields / 5, random);
+	Generate(fields.counters, NbFields / 5, random);
+	Generate(fields.angles, NbFields / 5, random);
+	Generate(fields.positions, NbFields / 5, random);
+	Generate(fields.identifiers, NbFields / 5, random);
+
+	std::vector<Bousk::uint8> reference;
+	{
+		//!< ReferenceSerializer has no bufferSize, wrap it for Time
+		struct Reference : ReferenceSerializer
+		{
+			const Bousk::uint8* buffer() const { return ReferenceSerializer::buffer().data(); }
+			size_t bufferSize() const { return ReferenceSerializer::buffer().size(); }
+		};
+		const std::chrono::nanoseconds duration = Time<Reference>(fields, reference, [](Reference& serializer, const auto& value) { WriteReference(serializer, value); });
+		std::cout << "Byte at a time : " << duration.count() / 1000 << "us, " << static_cast<double>(duration.count()) / NbFields << "ns per field" << std::endl;
+	}
+	std::vector<Bousk::uint8> serialized;
+	const std::chrono::nanoseconds duration = Time<Bousk::Serialization::Serializer>(fields, serialized, [](Bousk::Serialization::Serializer& serializer, const auto& value) { value.write(serializer); });
+	std::cout << "Serializer : " << duration.count() / 1000 << "us, " << static_cast<double>(duration.count()) / NbFields << "ns per field" << std::endl;
+	std::cout << NbFields << " fields in " << serialized.size() << "B" << (serialized == reference ? ", same bytes as the reference" : ", BYTES DIFFER FROM THE REFERENCE") << std::endl;
+
+	Bousk::Serialization::Deserializer deserializer(serialized.data(), serialized.size());
+	bool readOk = true;
+	for (size_t i = 0; i < fields.flags.size() && readOk; ++i)
+	{
+		Bousk::RangedInteger<0, 1> flag;
+		Bousk::RangedInteger<-100, 100> counter;
+		Bousk::RangedInteger<0, 3599> angle;
+		Bousk::RangedInteger<-1000000, 1000000> position;
+		Bousk::RangedInteger<0, 0xFFFFFFFFFFll> identifier;
+		readOk = flag.read(deserializer) && counter.read(deserializer) && angle.read(deserializer) && position.read(deserializer) && identifier.read(deserializer)
+			&& flag.get() == fields.flags[i].get() && counter.get() == fields.counters[i].get() && angle.get() == fields.angles[i].get()
+			&& position.get() == fields.positions[i].get() && identifier.get() == fields.identifiers[i].get();
+	}
+	std::cout << (readOk ? "Read back" : "READ BACK FAILED") << std::endl;
+	return 0;
+}
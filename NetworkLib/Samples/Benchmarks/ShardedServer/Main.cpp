@@ -0,0 +1,127 @@
+#include "Sockets.hpp"
+#include "UDP/ShardedServer.hpp"
+#include "UDP/UDPClient.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+#include "Messages.hpp"
+#include "Errors.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Load test of ShardedServer : a fixed set of client threads floods the server, which is run with 1 to as many shards as the hardware has threads
+// Throughput should grow with the number of shards, as long as the hardware has cores left for the load generators
+
+namespace
+{
+	constexpr Bousk::uint16 ServerPort = 8888;
+	constexpr Bousk::uint16 FirstClientPort = 30000;
+	constexpr size_t ClientsPerThread = 16;
+	constexpr size_t MessagesPerFrame = 8;
+	constexpr size_t MessageSize = 64;
+	constexpr std::chrono::seconds WarmUpDuration{ 1 };
+	constexpr std::chrono::seconds MeasureDuration{ 3 };
+
+	void RunClients(size_t thread, const std::atomic<bool>& running)
+	{
+		const Bousk::Network::Address server = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, ServerPort);
+		std::vector<std::unique_ptr<Bousk::Network::UDP::Client>> clients;
+		for (size_t i = 0; i < ClientsPerThread; ++i)
+		{
+			auto client = std::make_unique<Bousk::Network::UDP::Client>();
+			client->registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+			if (!client->init(static_cast<Bousk::uint16>(FirstClientPort + thread * ClientsPerThread + i)))
+				continue;
+			client->connect(server);
+			clients.push_back(std::move(client));
+		}
+		const std::vector<Bousk::uint8> message(MessageSize, 42);
+		while (running)
+		{
+			for (auto& client : clients)
+			{
+				client->receive();
+				client->poll();
+				for (size_t i = 0; i < MessagesPerFrame; ++i)
+					client->sendTo(server, message.data(), message.size(), 0);
+				client->processSend();
+			}
+		}
+		for (auto& client : clients)
+			client->release();
+	}
+
+	// Returns the number of messages received per second
+	double Run(size_t nbShards, size_t nbClientThreads)
+	{
+		Bousk::Network::UDP::ShardedServer server;
+		server.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		if (!server.init(ServerPort, nbShards))
+		{
+			std::cout << "Server initialisation error : " << Bousk::Network::Errors::Get() << std::endl;
+			return 0;
+		}
+		if (server.nbShards() != nbShards)
+			std::cout << "  Only " << server.nbShards() << " shards could be opened" << std::endl;
+
+		std::atomic<bool> running{ true };
+		std::vector<std::thread> clientThreads;
+		for (size_t i = 0; i < nbClientThreads; ++i)
+			clientThreads.emplace_back([i, &running]() { RunClients(i, running); });
+
+		size_t nbMessages = 0;
+		std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages;
+		const auto start = std::chrono::steady_clock::now();
+		auto measureStart = start + WarmUpDuration;
+		for (auto now = start; now < measureStart + MeasureDuration; now = std::chrono::steady_clock::now())
+		{
+			messages.clear();
+			server.poll(messages);
+			for (auto&& message : messages)
+			{
+				if (message->is<Bousk::Network::Messages::IncomingConnection>())
+					server.connect(message->emitter());
+				else if (message->is<Bousk::Network::Messages::UserData>() && now >= measureStart)
+					++nbMessages;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		running = false;
+		for (std::thread& thread : clientThreads)
+			thread.join();
+		std::cout << "  " << server.nbClients() << " distant clients" << std::endl;
+		server.release();
+		return nbMessages / std::chrono::duration<double>(MeasureDuration).count();
+	}
+}
+
+int main()
+{
+	if (!Bousk::Network::Start())
+	{
+		std::cout << "Network lib initialisation error : " << Bousk::Network::Errors::Get();
+		return -1;
+	}
+
+	const size_t nbThreads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t nbClientThreads = std::max<size_t>(1, nbThreads / 2);
+	std::cout << nbThreads << " hardware threads, " << nbClientThreads << " client threads of " << ClientsPerThread << " clients" << std::endl;
+	double singleShardThroughput = 0;
+	for (size_t nbShards = 1; nbShards <= nbThreads; nbShards *= 2)
+	{
+		std::cout << nbShards << " shards..." << std::endl;
+		const double throughput = Run(nbShards, nbClientThreads);
+		if (nbShards == 1)
+			singleShardThroughput = throughput;
+		std::cout << "  " << static_cast<Bousk::uint64>(throughput) << " messages/s";
+		if (singleShardThroughput > 0)
+			std::cout << " - x" << throughput / singleShardThroughput;
+		std::cout << std::endl;
+	}
+
+	Bousk::Network::Release();
+	return 0;
+}
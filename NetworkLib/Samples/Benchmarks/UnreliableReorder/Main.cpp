@@ -0,0 +1,115 @@
+#include "Address.hpp"
+#include "BufferPool.hpp"
+#include "UDP/Datagram.hpp"
+#include "UDP/Simulator.hpp"
+#include "UDP/Protocols/UnreliableOrdered.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Cost of reordering unreliable messages on reception : time spent by the receiving channel, from the datagram received to the messages extracted
+// The simulator delays, reorders, duplicates and drops datagrams carrying small messages and fragmented ones
+
+namespace
+{
+	constexpr size_t NbFrames = 2000;
+	constexpr size_t SmallMessagesPerFrame = 16;
+	constexpr size_t SmallMessageSize = 32;
+	constexpr size_t FragmentedMessagesInterval = 4; //!< A fragmented message every few frames
+	constexpr size_t FragmentedMessageSize = 3 * Bousk::Network::UDP::Packet::DataMaxSize;
+
+	struct Result
+	{
+		Bousk::uint64 nbDatagrams{ 0 };
+		Bousk::uint64 nbSmallMessages{ 0 };
+		Bousk::uint64 nbFragmentedMessages{ 0 };
+		std::chrono::nanoseconds duration{ 0 };
+	};
+	Result Run(Bousk::uint8 randomDelay, Bousk::uint8 lossRate, Bousk::uint16 duplicateRate)
+	{
+		Bousk::Network::UDP::Simulator simulator;
+		simulator.enable();
+		simulator.seed(42);
+		simulator.setDelay(0, randomDelay);
+		simulator.setLossRate(lossRate);
+		simulator.setDuplicate(3);
+		simulator.setDuplicateRate(duplicateRate);
+		const Bousk::Network::Address from = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, 8888);
+
+		Bousk::Network::UDP::Protocols::UnreliableOrdered sender;
+		Bousk::Network::UDP::Protocols::UnreliableOrdered receiver;
+		//!< Datagrams are received in pooled buffers, like the client does
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(Bousk::Network::UDP::Datagram::DataMaxSize);
+
+		Result result;
+		auto Receive = [&]()
+		{
+			for (const auto& received : simulator.poll())
+			{
+				const Bousk::Network::UDP::Datagram& datagram = received.first;
+				Bousk::BufferPool::Buffer buffer = pool->acquire();
+				memcpy(buffer.data(), datagram.data.data(), datagram.datasize);
+
+				const auto start = std::chrono::steady_clock::now();
+				receiver.onDataReceived(buffer.data(), datagram.datasize, buffer);
+				for (const Bousk::Network::Payload& message : receiver.process())
+				{
+					if (message.size() == FragmentedMessageSize)
+						++result.nbFragmentedMessages;
+					else
+						++result.nbSmallMessages;
+				}
+				result.duration += std::chrono::steady_clock::now() - start;
+				++result.nbDatagrams;
+			}
+		};
+		for (size_t frame = 0; frame < NbFrames; ++frame)
+		{
+			for (size_t i = 0; i < SmallMessagesPerFrame; ++i)
+				sender.queue(std::vector<Bousk::uint8>(SmallMessageSize, static_cast<Bousk::uint8>(i)));
+			if (frame % FragmentedMessagesInterval == 0)
+				sender.queue(std::vector<Bousk::uint8>(FragmentedMessageSize, static_cast<Bousk::uint8>(frame)));
+
+			Bousk::Network::UDP::Datagram datagram;
+			while ((datagram.datasize = sender.serialize(datagram.data.data(), Bousk::Network::UDP::Datagram::DataMaxSize, 0)) != 0)
+				simulator.push(datagram, from);
+
+			Receive();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		//!< Let the last datagrams arrive
+		const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(randomDelay + 10);
+		while (std::chrono::steady_clock::now() < end)
+		{
+			Receive();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return result;
+	}
+}
+
+int main()
+{
+	const size_t nbSmallMessages = NbFrames * SmallMessagesPerFrame;
+	const size_t nbFragmentedMessages = (NbFrames + FragmentedMessagesInterval - 1) / FragmentedMessagesInterval;
+	std::cout << NbFrames << " frames of " << SmallMessagesPerFrame << " messages of " << SmallMessageSize << "B, and a message of " << FragmentedMessageSize << "B every " << FragmentedMessagesInterval << " frames" << std::endl;
+	struct Scenario
+	{
+		const char* name;
+		Bousk::uint8 randomDelay;
+		Bousk::uint8 lossRate;
+		Bousk::uint16 duplicateRate;
+	};
+	for (const Scenario& scenario : { Scenario{ "In order", 0, 0, 0 }, Scenario{ "Reordered", 20, 0, 0 }, Scenario{ "Reordered, duplicated", 20, 0, 100 }, Scenario{ "Reordered, duplicated, lossy", 20, 5, 100 } })
+	{
+		const Result result = Run(scenario.randomDelay, scenario.lossRate, scenario.duplicateRate);
+		std::cout << scenario.name << " : " << result.nbDatagrams << " datagrams received - "
+			<< result.nbSmallMessages << "/" << nbSmallMessages << " small messages, "
+			<< result.nbFragmentedMessages << "/" << nbFragmentedMessages << " fragmented messages delivered - "
+			<< std::chrono::duration_cast<std::chrono::nanoseconds>(result.duration).count() / std::max<Bousk::uint64>(1, result.nbDatagrams) << "ns per datagram" << std::endl;
+	}
+	return 0;
+}
@@ -145,8 +145,8 @@ void main_p2p()
 			client.receive();
 			// Send network data
 			client.processSend();
-			// Don't loop like crazy...
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			// Sleep until there's something to receive or send
+			client.wait(std::chrono::milliseconds(100));
 		}
 	});
 	while (!exit)
@@ -68,7 +68,7 @@ int main()
 				}
 			}
 			client.processSend();
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
+			client.wait(std::chrono::milliseconds(100));
 		}
 		client.release();
 	});
@@ -124,7 +124,7 @@ int main()
 				}
 			}
 			client.processSend();
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
+			client.wait(std::chrono::milliseconds(100));
 		}
 		std::cout << "Normal termination." << std::endl;
 		client.release();
@@ -130,4 +130,13 @@ void AckHandler_Test::Test()
 	CHECK(newAcks.size() == 2);
 	CHECK(newAcks[0] == 302);
 	CHECK(newAcks[1] == 303);
+	//!< Count acks following an id
+	CHECK(ackhandler.nbAckedAfter(303) == 0);
+	CHECK(ackhandler.nbAckedAfter(300) == 3);
+	CHECK(ackhandler.nbAckedAfter(200) == 65);
+	//!< Receive 305, 304 is missing
+	ackhandler.update(305, MASK_FIRST_MISSING, true);
+	CHECK(ackhandler.nbAckedAfter(304) == 1);
+	CHECK(ackhandler.nbAckedAfter(303) == 1);
+	CHECK(ackhandler.nbAckedAfter(302) == 2);
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include <Address_Test.hpp>
+#include <Tester.hpp>
+#include <Address.hpp>
+
+void Address_Test::Test()
+{
+	const Bousk::Network::Address address("127.0.0.1", 8888);
+	const Bousk::Network::Address::Key::Hash hash;
+	{
+		// Same address built differently gives the same key
+		const Bousk::Network::Address loopback = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, 8888);
+		const Bousk::Network::Address copy(address.storage());
+		CHECK(address.key() == loopback.key());
+		CHECK(address.key() == copy.key());
+		CHECK(hash(address.key()) == hash(loopback.key()));
+	}
+	{
+		// Any difference in ip, port or family gives another key
+		CHECK(address.key() != Bousk::Network::Address("127.0.0.1", 8889).key());
+		CHECK(address.key() != Bousk::Network::Address("127.0.0.2", 8888).key());
+		CHECK(address.key() != Bousk::Network::Address("::1", 8888).key());
+		CHECK(Bousk::Network::Address("::1", 8888).key() == Bousk::Network::Address("0:0:0:0:0:0:0:1", 8888).key());
+		CHECK(Bousk::Network::Address("::1", 8888).key() != Bousk::Network::Address("::2", 8888).key());
+		CHECK(hash(address.key()) != hash(Bousk::Network::Address("127.0.0.1", 8889).key()));
+	}
+	{
+		// Invalid addresses all share the same key
+		CHECK(Bousk::Network::Address().key() == Bousk::Network::Address("not an ip", 8888).key());
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class Address_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,104 @@
+#include <BufferPool_Test.hpp>
+#include <Tester.hpp>
+#include <BufferPool.hpp>
+#include <Messages.hpp>
+#include <MessagesQueue.hpp>
+#include <Payload.hpp>
+#include <UDP/Packet.hpp>
+#include <UDP/Protocols/UnreliableOrdered.hpp>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+void BufferPool_Test::Test()
+{
+	{
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(64);
+		Bousk::BufferPool::Buffer buffer = pool->acquire();
+		CHECK(buffer);
+		CHECK(buffer.size() == 64);
+		CHECK(buffer.unique());
+		CHECK(pool->nbBuffers() == 1);
+		{
+			const Bousk::BufferPool::Buffer copy = buffer;
+			CHECK(!buffer.unique());
+			CHECK(copy.data() == buffer.data());
+		}
+		CHECK(buffer.unique());
+		//!< Released buffers are reused instead of allocating new ones
+		Bousk::uint8* const data = buffer.data();
+		buffer.reset();
+		CHECK(!buffer);
+		buffer = pool->acquire();
+		CHECK(buffer.data() == data);
+		CHECK(pool->nbBuffers() == 1);
+		const Bousk::BufferPool::Buffer other = pool->acquire();
+		CHECK(other.data() != data);
+		CHECK(pool->nbBuffers() == 2);
+	}
+	{
+		//!< Buffers released by another thread go back to the pool, and keep it alive
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(16);
+		std::vector<Bousk::BufferPool::Buffer> buffers;
+		for (int i = 0; i < 10; ++i)
+			buffers.push_back(pool->acquire());
+		std::thread releaser([buffers = std::move(buffers)]() mutable { buffers.clear(); });
+		releaser.join();
+		for (int i = 0; i < 10; ++i)
+			buffers.push_back(pool->acquire());
+		CHECK(pool->nbBuffers() == 10);
+		pool.reset();
+		buffers.back().data()[0] = 42;
+		CHECK(buffers.back().data()[0] == 42);
+	}
+	{
+		//!< Full messages received in a pooled buffer are delivered as views into it
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(sizeof(Bousk::Network::UDP::Packet));
+		Bousk::Network::UDP::Protocols::UnreliableOrdered protocol;
+		const std::vector<Bousk::uint8> data = { 'z', 'e', 'r', 'o', 'c', 'o', 'p', 'y' };
+		std::vector<Bousk::Network::Payload> messages;
+		{
+			Bousk::BufferPool::Buffer buffer = pool->acquire();
+			protocol.queue(std::vector<Bousk::uint8>(data));
+			const Bousk::uint16 size = protocol.serialize(buffer.data(), static_cast<Bousk::uint16>(buffer.size()), 0);
+			protocol.onDataReceived(buffer.data(), size, buffer);
+			messages = protocol.process();
+			CHECK(messages.size() == 1);
+			CHECK(messages[0].isView());
+			CHECK(messages[0].data() >= buffer.data() && messages[0].data() < buffer.data() + buffer.size());
+		}
+		//!< The payload keeps its buffer alive
+		CHECK(messages[0] == data);
+		messages.clear();
+		CHECK(pool->acquire().unique());
+		CHECK(pool->nbBuffers() == 1);
+
+		//!< Without pooled buffer, the payload owns a copy
+		const Bousk::Network::Payload copy(data.data(), data.size(), Bousk::BufferPool::Buffer());
+		CHECK(!copy.isView());
+		CHECK(copy == data);
+	}
+	{
+		//!< A polled message dropped by the application gives its buffer back to the pool
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(64);
+		const std::vector<Bousk::uint8> data = { 'p', 'o', 'o', 'l' };
+		Bousk::Network::MessagesQueue queue;
+		Bousk::uint8* bufferData = nullptr;
+		{
+			Bousk::BufferPool::Buffer buffer = pool->acquire();
+			bufferData = buffer.data();
+			memcpy(buffer.data(), data.data(), data.size());
+			queue.push(std::make_unique<Bousk::Network::Messages::UserData>(Bousk::Network::Address(), 0, Bousk::Network::Payload(buffer.data(), data.size(), buffer)));
+		}
+		{
+			const std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages = queue.poll();
+			CHECK(messages.size() == 1);
+			CHECK(messages[0]->as<Bousk::Network::Messages::UserData>()->data.isView());
+			CHECK(messages[0]->as<Bousk::Network::Messages::UserData>()->data == data);
+		}
+		const Bousk::BufferPool::Buffer buffer = pool->acquire();
+		CHECK(buffer.data() == bufferData);
+		CHECK(pool->nbBuffers() == 1);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class BufferPool_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,115 @@
+#include "Compression_Test.hpp"
+#include "Tester.hpp"
+
+#include <Compression/LZ.hpp>
+#include <UDP/Protocols/Compressed.hpp>
+#include <UDP/Protocols/ReliableOrdered.hpp>
+
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+void Compression_Test::Test()
+{
+	using LZ = Bousk::Compression::LZ;
+	auto RoundTrip = [](const std::vector<uint8_t>& data, const Bousk::Compression::Dictionary* dictionary) -> size_t
+	{
+		std::vector<uint8_t> compressed(LZ::CompressBound(data.size()));
+		const size_t compressedSize = LZ::Compress(data.data(), data.size(), compressed.data(), compressed.size(), dictionary);
+		CHECK(compressedSize != 0);
+		std::vector<uint8_t> decompressed(data.size());
+		size_t decompressedSize = 0;
+		CHECK(LZ::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size(), decompressedSize, dictionary));
+		CHECK(decompressedSize == data.size());
+		CHECK(decompressed == data);
+		return compressedSize;
+	};
+	const std::string text = R"({"entity":42,"position":{"x":1.5,"y":-3.25,"z":0},"state":"running","health":100})";
+	std::vector<uint8_t> repetitive;
+	for (size_t i = 0; i < 20; ++i)
+		repetitive.insert(repetitive.end(), text.begin(), text.end());
+	std::vector<uint8_t> random(1000);
+	std::mt19937 generator(42);
+	for (uint8_t& byte : random)
+		byte = static_cast<uint8_t>(generator());
+	{
+		//!< Empty, short, repetitive with overlapping matches, long runs and incompressible data
+		RoundTrip({}, nullptr);
+		RoundTrip({ 1, 2, 3 }, nullptr);
+		CHECK(RoundTrip(std::vector<uint8_t>(5000, 7), nullptr) < 50);
+		CHECK(RoundTrip(repetitive, nullptr) < repetitive.size() / 10);
+		CHECK(RoundTrip(random, nullptr) <= LZ::CompressBound(random.size()));
+
+		//!< Doesn't fit
+		std::vector<uint8_t> compressed(random.size());
+		CHECK(LZ::Compress(random.data(), random.size(), compressed.data(), compressed.size()) == 0);
+	}
+	{
+		//!< A single message compresses with a dictionary, which the matches can run past
+		const Bousk::Compression::Dictionary dictionary(std::vector<uint8_t>(text.begin(), text.end()));
+		const std::vector<uint8_t> message(text.begin(), text.end());
+		const size_t withoutDictionary = RoundTrip(message, nullptr);
+		const size_t withDictionary = RoundTrip(message, &dictionary);
+		CHECK(withDictionary < 10);
+		CHECK(withDictionary < withoutDictionary);
+		CHECK(RoundTrip(repetitive, &dictionary) < RoundTrip(repetitive, nullptr));
+
+		//!< Larger dictionaries keep their end
+		std::vector<uint8_t> large(Bousk::Compression::Dictionary::MaxSize + 10, 0);
+		large.back() = 1;
+		const Bousk::Compression::Dictionary truncated(std::move(large));
+		CHECK(truncated.size() == Bousk::Compression::Dictionary::MaxSize);
+		CHECK(truncated.data()[truncated.size() - 1] == 1);
+	}
+	{
+		//!< Malformed data is rejected : truncated, match before the start, or larger than the destination
+		std::vector<uint8_t> compressed(LZ::CompressBound(repetitive.size()));
+		const size_t compressedSize = LZ::Compress(repetitive.data(), repetitive.size(), compressed.data(), compressed.size());
+		std::vector<uint8_t> decompressed(repetitive.size());
+		size_t decompressedSize = 0;
+		CHECK(!LZ::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size() - 1, decompressedSize));
+		const std::array<uint8_t, 4> matchBeforeStart{ 0x10, 'a', 2, 0 };
+		CHECK(!LZ::Decompress(matchBeforeStart.data(), matchBeforeStart.size(), decompressed.data(), decompressed.size(), decompressedSize));
+		const std::array<uint8_t, 2> truncatedLiterals{ 0x50, 'a' };
+		CHECK(!LZ::Decompress(truncatedLiterals.data(), truncatedLiterals.size(), decompressed.data(), decompressed.size(), decompressedSize));
+	}
+
+	using Compressed = Bousk::Network::UDP::Protocols::Compressed;
+	using ReliableOrdered = Bousk::Network::UDP::Protocols::ReliableOrdered;
+	std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+	const auto dictionary = std::make_shared<const Bousk::Compression::Dictionary>(std::vector<uint8_t>(text.begin(), text.end()));
+	for (const Compressed::Mode mode : { Compressed::Mode::PerMessage, Compressed::Mode::PerDatagram })
+	{
+		Compressed sender(std::make_unique<ReliableOrdered>(), mode, dictionary);
+		Compressed receiver(std::make_unique<ReliableOrdered>(), mode, dictionary);
+		//!< Small messages are sent as is in PerMessage mode, compressed together in PerDatagram mode
+		const std::vector<uint8_t> message(text.begin(), text.end());
+		const std::vector<uint8_t> small(text.begin(), text.begin() + 10);
+		for (size_t i = 0; i < 8; ++i)
+			sender.queue(std::vector<uint8_t>(message));
+		sender.queue(std::vector<uint8_t>(small));
+		const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+		CHECK(serializedSize != 0);
+		CHECK(serializedSize < 8 * message.size());
+		receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		const std::vector<Bousk::Network::Payload> messages = receiver.process();
+		CHECK(messages.size() == 9);
+		for (size_t i = 0; i < 8; ++i)
+			CHECK(messages[i] == message);
+		CHECK(messages[8] == small);
+	}
+	{
+		//!< Data which doesn't compress is sent as is
+		Compressed sender(std::make_unique<ReliableOrdered>(), Compressed::Mode::PerDatagram);
+		Compressed receiver(std::make_unique<ReliableOrdered>(), Compressed::Mode::PerDatagram);
+		sender.queue(std::vector<uint8_t>(random));
+		const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+		CHECK(serializedSize == Bousk::Network::UDP::Packet::HeaderSize + random.size());
+		receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		const std::vector<Bousk::Network::Payload> messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == random);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class Compression_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,159 @@
+#include <DatagramBatch_Test.hpp>
+#include <Tester.hpp>
+
+#include <Address.hpp>
+#include <Sockets.hpp>
+#include <UDP/Datagram.hpp>
+#include <UDP/DatagramBatch.hpp>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+void DatagramBatch_Test::Test()
+{
+	using Datagram = Bousk::Network::UDP::Datagram;
+	using SendBatch = Bousk::Network::UDP::SendBatch;
+	auto MakeDatagram = [](const uint16_t id, const uint16_t datasize)
+	{
+		Datagram datagram;
+		datagram.header.id = id;
+		datagram.header.ack = 0;
+		datagram.header.previousAcks = std::numeric_limits<uint64_t>::max();
+		datagram.header.type = Datagram::Type::ConnectedData;
+		datagram.datasize = datasize;
+		memset(datagram.data.data(), static_cast<int>(id), datasize);
+		return datagram;
+	};
+	//!< Loopback socket, to check what's actually sent
+	auto OpenReceiver = [](sockaddr_storage& address)
+	{
+		SOCKET receiver = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, 0).bind(receiver);
+		socklen_t addressLength = sizeof(address);
+		getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &addressLength);
+		Bousk::Network::SetNonBlocking(receiver);
+		return receiver;
+	};
+	auto ReceiveIds = [](SOCKET receiver, const size_t expected)
+	{
+		std::vector<uint16_t> ids;
+		pollfd fd{ receiver, POLLIN, 0 };
+		while (ids.size() < expected && poll(&fd, 1, 100) > 0)
+		{
+			Datagram datagram;
+			const int ret = recv(receiver, reinterpret_cast<char*>(&datagram), Datagram::BufferMaxSize, 0);
+			if (ret > 0 && datagram.deserialize(static_cast<uint16_t>(ret)))
+				ids.push_back(datagram.header.id);
+		}
+		return ids;
+	};
+
+	CHECK(Bousk::Network::Start());
+	SOCKET sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	CHECK(sender != INVALID_SOCKET);
+	Bousk::Network::SetNonBlocking(sender);
+	{
+		//!< More datagrams than a single system call accepts
+		sockaddr_storage target;
+		SOCKET receiver = OpenReceiver(target);
+		SendBatch batch;
+		constexpr size_t NbDatagrams = SendBatch::MaxMessagesPerCall + 10;
+		for (size_t i = 0; i < NbDatagrams; ++i)
+			CHECK(batch.queue(MakeDatagram(static_cast<uint16_t>(i), 8), target));
+		CHECK(batch.size() == NbDatagrams);
+		CHECK(batch.flush(sender) == NbDatagrams);
+		CHECK(batch.empty());
+		CHECK(batch.mBuffer.empty());
+		CHECK(batch.nbDatagramsSent() == NbDatagrams);
+	#ifdef BOUSKNET_HAS_MMSG
+		CHECK(batch.nbSystemCalls() == 2);
+	#else
+		CHECK(batch.nbSystemCalls() == NbDatagrams);
+	#endif // BOUSKNET_HAS_MMSG
+		Bousk::Network::CloseSocket(receiver);
+	}
+	{
+		//!< The socket would block after the system took the first datagrams : the remainder is kept, and sent first on next flush
+		sockaddr_storage target;
+		SOCKET receiver = OpenReceiver(target);
+		SendBatch batch;
+		for (uint16_t i = 0; i < 5; ++i)
+			batch.queue(MakeDatagram(i, 10 + i), target);
+		batch.onEntriesSent(2);
+		batch.compact();
+		CHECK(batch.size() == 3);
+		CHECK(batch.mFirstEntry == 0);
+		CHECK(batch.mEntries.size() == 3);
+		CHECK(batch.mEntries[0].offset == 0);
+		CHECK(batch.mBuffer.size() == batch.mEntries[0].size + batch.mEntries[1].size + batch.mEntries[2].size);
+		CHECK(batch.mBuffer[batch.mEntries[0].size - 1] == 2);
+		//!< Datagrams queued meanwhile go after the remainder
+		batch.queue(MakeDatagram(5, 15), target);
+		batch.queue(MakeDatagram(6, 16), target);
+		CHECK(batch.flush(sender) == 5);
+		CHECK(batch.empty());
+		CHECK(batch.nbDatagramsSent() == 7);
+		CHECK(ReceiveIds(receiver, 5) == std::vector<uint16_t>({ 2, 3, 4, 5, 6 }));
+		Bousk::Network::CloseSocket(receiver);
+	}
+	{
+		//!< A datagram the system refuses is dropped and counted, the next ones are still sent
+		sockaddr_storage target;
+		SOCKET receiver = OpenReceiver(target);
+		sockaddr_storage invalidTarget;
+		memset(&invalidTarget, 0, sizeof(invalidTarget));
+		invalidTarget.ss_family = AF_INET6; //!< Not reachable from an IPv4 socket
+		SendBatch batch;
+		batch.queue(MakeDatagram(0, 10), target);
+		batch.queue(MakeDatagram(1, 10), invalidTarget);
+		batch.queue(MakeDatagram(2, 10), target);
+		size_t nbSent = 0;
+		for (int i = 0; i < 3 && !batch.empty(); ++i)
+			nbSent += batch.flush(sender);
+		CHECK(batch.empty());
+		CHECK(nbSent == 2);
+		CHECK(batch.nbDatagramsSent() == 2);
+		CHECK(batch.nbDatagramsDropped() == 1);
+		CHECK(ReceiveIds(receiver, 2) == std::vector<uint16_t>({ 0, 2 }));
+		Bousk::Network::CloseSocket(receiver);
+	}
+	{
+		//!< Segments share the target and the size of the first one, only the last one can be smaller
+		sockaddr_storage targetA;
+		memset(&targetA, 0, sizeof(targetA));
+		targetA.ss_family = AF_INET;
+		sockaddr_storage targetB = targetA;
+		reinterpret_cast<sockaddr_in&>(targetB).sin_port = htons(1);
+		SendBatch batch;
+		batch.queue(MakeDatagram(0, 100), targetA);
+		batch.queue(MakeDatagram(1, 100), targetA);
+		batch.queue(MakeDatagram(2, 50), targetA);
+		batch.queue(MakeDatagram(3, 50), targetA);
+		batch.queue(MakeDatagram(4, 100), targetA);
+		batch.queue(MakeDatagram(5, 100), targetB);
+		CHECK(batch.segmentableEntries(0) == 3); //!< A smaller one ends the buffer
+		CHECK(batch.segmentableEntries(2) == 2);
+		CHECK(batch.segmentableEntries(3) == 1); //!< A bigger one can't follow
+		CHECK(batch.segmentableEntries(4) == 1); //!< Another target can't follow
+		CHECK(batch.segmentableEntries(5) == 1);
+	}
+	{
+		//!< Segmented buffers are limited in number of segments and in size
+		sockaddr_storage target;
+		memset(&target, 0, sizeof(target));
+		target.ss_family = AF_INET;
+		SendBatch smallBatch;
+		for (uint16_t i = 0; i < SendBatch::MaxSegments + 10; ++i)
+			smallBatch.queue(MakeDatagram(i, 10), target);
+		CHECK(smallBatch.segmentableEntries(0) == SendBatch::MaxSegments);
+		CHECK(smallBatch.segmentableEntries(SendBatch::MaxSegments) == 10);
+		SendBatch bigBatch;
+		for (uint16_t i = 0; i < SendBatch::MaxSegments; ++i)
+			bigBatch.queue(MakeDatagram(i, Datagram::DataMaxSize), target);
+		const size_t datagramSize = bigBatch.mEntries[0].size;
+		CHECK(bigBatch.segmentableEntries(0) == SendBatch::MaxSegmentedSize / datagramSize);
+	}
+	Bousk::Network::CloseSocket(sender);
+	Bousk::Network::Release();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class DatagramBatch_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,119 @@
+#include <Datagram_Test.hpp>
+#include <Tester.hpp>
+
+#include <UDP/Datagram.hpp>
+#include <UDP/ChannelHeader.hpp>
+#include <UDP/ChannelsHandler.hpp>
+#include <UDP/Packet.hpp>
+#include <UDP/Protocols/ReliableOrdered.hpp>
+#include <UDP/Protocols/UnreliableOrdered.hpp>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+void Datagram_Test::Test()
+{
+	using Datagram = Bousk::Network::UDP::Datagram;
+	//!< Wire buffer, received in place as a datagram
+	auto Transmit = [](const Datagram& sent, Datagram& received)
+	{
+		const uint16_t size = sent.serialize(reinterpret_cast<uint8_t*>(&received));
+		return received.deserialize(size) ? size : 0;
+	};
+	{
+		Datagram datagram;
+		datagram.header.id = 1234;
+		datagram.header.ack = 65535;
+		datagram.header.previousAcks = std::numeric_limits<uint64_t>::max();
+		datagram.header.type = Datagram::Type::ConnectedData;
+		datagram.datasize = 3;
+		datagram.data[0] = 1; datagram.data[1] = 2; datagram.data[2] = 3;
+
+		//!< Complete mask omitted
+		Datagram received;
+		CHECK(Transmit(datagram, received) == Datagram::HeaderMinSize + 3);
+		CHECK(received.header.id == 1234);
+		CHECK(received.header.ack == 65535);
+		CHECK(received.header.previousAcks == std::numeric_limits<uint64_t>::max());
+		CHECK(received.header.type == Datagram::Type::ConnectedData);
+		CHECK(received.datasize == 3);
+		CHECK(received.data[0] == 1 && received.data[1] == 2 && received.data[2] == 3);
+
+		//!< A few missing acks listed : 3 bits for their number, 6 bits each
+		datagram.header.previousAcks = ~((uint64_t(1) << 3) | (uint64_t(1) << 40));
+		CHECK(Transmit(datagram, received) == (38 + 3 + 2 * 6 + 7) / 8 + 3);
+		CHECK(received.header.previousAcks == datagram.header.previousAcks);
+		datagram.header.previousAcks = ~uint64_t(0x3F);
+		CHECK(Transmit(datagram, received) == (38 + 3 + Datagram::MaxListedMissingAcks * 6 + 7) / 8 + 3);
+		CHECK(received.header.previousAcks == datagram.header.previousAcks);
+
+		//!< Mask with many missing acks sent in full
+		datagram.header.previousAcks = ~uint64_t(0x7F);
+		CHECK(Transmit(datagram, received) == Datagram::HeaderMaxSize + 3);
+		CHECK(received.header.previousAcks == datagram.header.previousAcks);
+		datagram.header.previousAcks = 0x8000000000000001;
+		datagram.header.type = Datagram::Type::Disconnection;
+		CHECK(Transmit(datagram, received) == Datagram::HeaderMaxSize + 3);
+		CHECK(received.header.previousAcks == 0x8000000000000001);
+		CHECK(received.header.type == Datagram::Type::Disconnection);
+		CHECK(received.data[2] == 3);
+
+		//!< Truncated or from another wire version : dropped
+		const uint16_t size = datagram.serialize(reinterpret_cast<uint8_t*>(&received));
+		CHECK(!received.deserialize(Datagram::HeaderMinSize));
+		datagram.serialize(reinterpret_cast<uint8_t*>(&received));
+		reinterpret_cast<uint8_t*>(&received)[0] ^= 0x80;
+		CHECK(!received.deserialize(size));
+	}
+	{
+		using ChannelsHandler = Bousk::Network::UDP::ChannelsHandler;
+		using Packet = Bousk::Network::UDP::Packet;
+		ChannelsHandler sender;
+		sender.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		sender.registerChannel<Bousk::Network::UDP::Protocols::ReliableOrdered>();
+		ChannelsHandler receiver;
+		receiver.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
+		receiver.registerChannel<Bousk::Network::UDP::Protocols::ReliableOrdered>();
+
+		//!< Small messages on both channels and a fragmented one
+		const std::vector<uint8_t> small(32, 7);
+		const std::vector<uint8_t> big(Packet::DataMaxSize + 100, 9);
+		for (int i = 0; i < 4; ++i)
+			sender.queue(std::vector<uint8_t>(small), 0);
+		sender.queue(std::vector<uint8_t>(small), 1);
+		sender.queue(std::vector<uint8_t>(big), 1);
+
+		std::array<uint8_t, Datagram::DataMaxSize> buffer;
+		const uint16_t serializedSize = sender.serialize(buffer.data(), Datagram::DataMaxSize, 0);
+		//!< The first fragment takes a whole datagram, the last one fits with the small messages
+		const size_t rawSize = 2 * Bousk::Network::UDP::ChannelHeader::Size + 6 * Packet::HeaderSize + 5 * small.size() + (big.size() - Packet::DataMaxSize);
+		CHECK(serializedSize < rawSize);
+		receiver.onDataReceived(buffer.data(), serializedSize);
+		std::vector<Bousk::Network::Payload> messages = receiver.process(true);
+		CHECK(messages.size() == 5);
+		for (const Bousk::Network::Payload& message : messages)
+			CHECK(message.size() == small.size() && memcmp(message.data(), small.data(), small.size()) == 0);
+
+		//!< Then the first fragment
+		uint16_t fragmentsSize = 0;
+		Bousk::Network::UDP::Datagram::ID datagramId = 1;
+		messages.clear();
+		while ((fragmentsSize = sender.serialize(buffer.data(), Datagram::DataMaxSize, datagramId++)) != 0)
+		{
+			receiver.onDataReceived(buffer.data(), fragmentsSize);
+			for (Bousk::Network::Payload& message : receiver.process(true))
+				messages.push_back(std::move(message));
+		}
+		CHECK(datagramId == 3);
+		CHECK(messages.size() == 1);
+		CHECK(messages[0].size() == big.size() && memcmp(messages[0].data(), big.data(), big.size()) == 0);
+
+		//!< Malformed data is ignored
+		sender.queue(std::vector<uint8_t>(small), 0);
+		const uint16_t truncatedSize = sender.serialize(buffer.data(), Datagram::DataMaxSize, datagramId);
+		receiver.onDataReceived(buffer.data(), truncatedSize - 1);
+		CHECK(receiver.process(true).empty());
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class Datagram_Test
+{
+public:
+	static void Test();
+};
@@ -50,7 +50,9 @@ void DistantClient_Test::Test()
 	QueueDatagram();
 	CHECK(distantClient.mNextDatagramIdToSend == 1);
 	CHECK(datagram.header.id == 0);
-	CHECK(datagram.datasize == TestStringLength + Bousk::Network::UDP::Packet::HeaderSize + Bousk::Network::UDP::ChannelHeader::Size);
+	//!< Channel id and number of packets 5 bits each, packet type 2 bits, id 16 bits and size 7 bits : 5 bytes
+	CHECK(datagram.datasize == TestStringLength + 5);
+	CHECK(datagram.datasize < TestStringLength + Bousk::Network::UDP::Packet::HeaderSize + Bousk::Network::UDP::ChannelHeader::Size);
 
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
@@ -79,7 +81,7 @@ void DistantClient_Test::Test()
 
 	//!< Receive datagram #2, #1 is now missing
 	QueueDatagram();
-	datagram.header.id = htons(2);
+	datagram.header.id = 2;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 2);
@@ -96,7 +98,7 @@ void DistantClient_Test::Test()
 
 	//!< Now receive datagram #1
 	QueueDatagram();
-	datagram.header.id = htons(1);
+	datagram.header.id = 1;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 2);
@@ -115,7 +117,7 @@ void DistantClient_Test::Test()
 
 	//!< Jump 64 packets ahead, all missed in between
 	QueueDatagram();
-	datagram.header.id = htons(66);
+	datagram.header.id = 66;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 66);
@@ -134,7 +136,7 @@ void DistantClient_Test::Test()
 
 	//!< Receive next one and everything is missing in between
 	QueueDatagram();
-	datagram.header.id = htons(67);
+	datagram.header.id = 67;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 67);
@@ -153,7 +155,7 @@ void DistantClient_Test::Test()
 
 	//!< Receive next one, #3 is now lost
 	QueueDatagram();
-	datagram.header.id = htons(68);
+	datagram.header.id = 68;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 68);
@@ -171,7 +173,7 @@ void DistantClient_Test::Test()
 
 	//!< Receive datagram #3 : too old, ignored
 	QueueDatagram();
-	datagram.header.id = htons(3);
+	datagram.header.id = 3;
 	{
 		distantClient.onDatagramReceived(std::move(datagram));
 		CHECK(distantClient.mReceivedAcks.lastAck() == 68);
@@ -181,4 +183,66 @@ void DistantClient_Test::Test()
 		auto polledMessages = client.poll();
 		CHECK(polledMessages.size() == 0);
 	}
+
+	//!< Delayed acks : the keep alive waits for a second datagram or the deadline
+	Bousk::Network::UDP::DistantClient::SetAckPolicy(std::chrono::milliseconds(50), 2);
+	distantClient.send(Bousk::Network::UDP::Datagram());
+	CHECK(distantClient.mNbDatagramsToAck == 0);
+	QueueDatagram();
+	datagram.header.id = 69;
+	{
+		const auto before = Bousk::Utils::Now();
+		distantClient.onDatagramReceived(datagram);
+		CHECK(!distantClient.mKeepAliveNeeded);
+		CHECK(distantClient.mNbDatagramsToAck == 1);
+		CHECK(distantClient.mAckDeadline >= before + std::chrono::milliseconds(50));
+		CHECK(distantClient.nextDeadline() <= distantClient.mAckDeadline);
+		client.poll();
+	}
+	QueueDatagram();
+	datagram.header.id = 70;
+	{
+		distantClient.onDatagramReceived(datagram);
+		CHECK(distantClient.mKeepAliveNeeded);
+		CHECK(distantClient.mNbDatagramsToAck == 2);
+		client.poll();
+		//!< Acks sent with any datagram
+		distantClient.send(Bousk::Network::UDP::Datagram());
+		CHECK(!distantClient.mKeepAliveNeeded);
+		CHECK(distantClient.mNbDatagramsToAck == 0);
+	}
+	Bousk::Network::UDP::DistantClient::SetAckPolicy(BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY, BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY);
+
+	//!< Coalescing : messages wait for the fill threshold, the deadline or a flush
+	distantClient.processSend();
+	CHECK(distantClient.mNbBytesQueued == 0);
+	Bousk::Network::UDP::DistantClient::SetCoalescingPolicy(std::chrono::milliseconds(50), 100);
+	{
+		const auto before = Bousk::Utils::Now();
+		const auto nextDatagramId = distantClient.mNextDatagramIdToSend;
+		distantClient.send(std::vector<uint8_t>(10, 0), 0);
+		CHECK(distantClient.mNbBytesQueued == 10);
+		CHECK(distantClient.mCoalescingDeadline >= before + std::chrono::milliseconds(50));
+		CHECK(distantClient.nextDeadline() <= distantClient.mCoalescingDeadline);
+		distantClient.processSend();
+		CHECK(distantClient.mNextDatagramIdToSend == nextDatagramId);
+		CHECK(distantClient.mNbBytesQueued == 10);
+		//!< Threshold reached : both messages sent in a single datagram
+		distantClient.send(std::vector<uint8_t>(90, 0), 0);
+		distantClient.processSend();
+		CHECK(distantClient.mNextDatagramIdToSend == nextDatagramId + 1);
+		CHECK(distantClient.mNbBytesQueued == 0);
+	}
+	{
+		const auto nextDatagramId = distantClient.mNextDatagramIdToSend;
+		distantClient.send(std::vector<uint8_t>(10, 0), 0);
+		distantClient.processSend();
+		CHECK(distantClient.mNextDatagramIdToSend == nextDatagramId);
+		distantClient.flush();
+		distantClient.processSend();
+		CHECK(distantClient.mNextDatagramIdToSend == nextDatagramId + 1);
+		CHECK(distantClient.mNbBytesQueued == 0);
+		CHECK(!distantClient.mFlushRequested);
+	}
+	Bousk::Network::UDP::DistantClient::SetCoalescingPolicy(BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY, BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD);
 }
@@ -0,0 +1,76 @@
+#include <EventsQueue_Test.hpp>
+#include <Tester.hpp>
+#include <BufferPool.hpp>
+#include <EventsQueue.hpp>
+
+#include <vector>
+
+void EventsQueue_Test::Test()
+{
+	const Bousk::Network::Address address("127.0.0.1", 8888);
+	const std::vector<Bousk::uint8> data = { 'e', 'v', 'e', 'n', 't' };
+	{
+		Bousk::Network::EventsQueue queue;
+		queue.addEmitter(3, address);
+		queue.push(Bousk::Network::Messages::Event(3, Bousk::Network::Messages::EventData<Bousk::Network::Messages::Connection>{ Bousk::Network::Messages::Connection::Result::Success }));
+		queue.push(Bousk::Network::Messages::Event(3, Bousk::Network::Messages::EventData<Bousk::Network::Messages::UserData>{ std::vector<Bousk::uint8>(data) }));
+		std::vector<Bousk::Network::Messages::Event> events;
+		CHECK(queue.pollEvents(events) == 2);
+		CHECK(events.size() == 2);
+		CHECK(events[0].is<Bousk::Network::Messages::Connection>());
+		CHECK(events[0].as<Bousk::Network::Messages::Connection>()->result == Bousk::Network::Messages::Connection::Result::Success);
+		CHECK(events[1].is<Bousk::Network::Messages::UserData>());
+		CHECK(!events[1].is<Bousk::Network::Messages::Connection>());
+		CHECK(events[1].emitterId() == 3);
+		CHECK(events[1].as<Bousk::Network::Messages::UserData>()->data == data);
+		CHECK(queue.address(events[1].emitterId()) == address);
+		CHECK(!queue.address(4).isValid());
+	}
+	{
+		//!< Events polled as messages carry their emitter address
+		Bousk::Network::EventsQueue queue;
+		queue.addEmitter(1, address);
+		queue.push(Bousk::Network::Messages::Event(1, Bousk::Network::Messages::EventData<Bousk::Network::Messages::UserData>{ std::vector<Bousk::uint8>(data) }));
+		const std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages = queue.poll();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0]->is<Bousk::Network::Messages::UserData>());
+		CHECK(messages[0]->emitter() == address);
+		CHECK(messages[0]->emmiterId() == 1);
+		CHECK(messages[0]->as<Bousk::Network::Messages::UserData>()->data == data);
+	}
+	{
+		//!< A message polled from an event in a pooled buffer gives it back to the pool once dropped
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(64);
+		Bousk::Network::EventsQueue queue;
+		queue.addEmitter(1, address);
+		Bousk::uint8* bufferData = nullptr;
+		{
+			Bousk::BufferPool::Buffer buffer = pool->acquire();
+			bufferData = buffer.data();
+			memcpy(buffer.data(), data.data(), data.size());
+			queue.push(Bousk::Network::Messages::Event(1, Bousk::Network::Messages::EventData<Bousk::Network::Messages::UserData>{ Bousk::Network::Payload(buffer.data(), data.size(), buffer) }));
+		}
+		{
+			const std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages = queue.poll();
+			CHECK(messages.size() == 1);
+			CHECK(messages[0]->as<Bousk::Network::Messages::UserData>()->data.isView());
+			CHECK(messages[0]->as<Bousk::Network::Messages::UserData>()->data == data);
+		}
+		const Bousk::BufferPool::Buffer buffer = pool->acquire();
+		CHECK(buffer.data() == bufferData);
+		CHECK(pool->nbBuffers() == 1);
+	}
+	{
+		//!< Address of a removed emitter remains available until the poll after the one returning its last event
+		Bousk::Network::EventsQueue queue;
+		queue.addEmitter(1, address);
+		queue.push(Bousk::Network::Messages::Event(1, Bousk::Network::Messages::EventData<Bousk::Network::Messages::Disconnection>{ Bousk::Network::Messages::Disconnection::Reason::Lost }));
+		queue.removeEmitter(1);
+		std::vector<Bousk::Network::Messages::Event> events;
+		CHECK(queue.pollEvents(events) == 1);
+		CHECK(queue.address(1) == address);
+		events.clear();
+		CHECK(queue.pollEvents(events) == 0);
+		CHECK(!queue.address(1).isValid());
+	}
+}
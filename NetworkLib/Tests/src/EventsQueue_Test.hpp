@@ -0,0 +1,7 @@
+#pragma once
+
+class EventsQueue_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,142 @@
+#include <KeepAlive_Test.hpp>
+#include <Tester.hpp>
+
+#include <UDP/UDPClient.hpp>
+#include <UDP/Protocols/ReliableOrdered.hpp>
+#include <Events.hpp>
+#include <Sockets.hpp>
+#include <Utils.hpp>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace
+{
+	struct Peer
+	{
+		Bousk::Network::UDP::Client client;
+		Bousk::Network::Address address;
+		std::vector<Bousk::Network::Messages::Event> events;
+		std::vector<std::vector<uint8_t>> received;
+		bool connected{ false };
+		bool disconnected{ false };
+	};
+	bool Init(Peer& peer, const uint16_t port, const unsigned int seed)
+	{
+		peer.address = Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, port);
+		peer.client.registerChannel<Bousk::Network::UDP::Protocols::ReliableOrdered>();
+		peer.client.simulator().enable();
+		peer.client.simulator().seed(seed);
+		peer.client.simulator().setLossRate(10);
+		return peer.client.init(port);
+	}
+	void Step(Peer& peer)
+	{
+		peer.client.receive();
+		peer.events.clear();
+		peer.client.pollEvents(peer.events);
+		for (const Bousk::Network::Messages::Event& event : peer.events)
+		{
+			if (event.is<Bousk::Network::Messages::IncomingConnection>())
+				peer.client.connect(peer.client.address(event.emitterId()));
+			else if (event.is<Bousk::Network::Messages::Connection>())
+				peer.connected = event.as<Bousk::Network::Messages::Connection>()->result == Bousk::Network::Messages::Connection::Result::Success;
+			else if (event.is<Bousk::Network::Messages::Disconnection>())
+				peer.disconnected = true;
+			else if (event.is<Bousk::Network::Messages::UserData>())
+				peer.received.push_back(event.as<Bousk::Network::Messages::UserData>()->data.toVector());
+		}
+		peer.client.processSend();
+		peer.client.wait(std::chrono::milliseconds(1));
+	}
+	//!< Run both ends until the duration elapsed or done returns true
+	void Run(Peer& a, Peer& b, const std::chrono::milliseconds duration, const std::function<bool()>& done = nullptr)
+	{
+		const auto end = Bousk::Utils::Now() + duration;
+		while (Bousk::Utils::Now() < end && !(done && done()))
+		{
+			Step(a);
+			Step(b);
+		}
+	}
+}
+
+void KeepAlive_Test::Test()
+{
+	CHECK(Bousk::Network::Start());
+	Bousk::Network::UDP::Client::SetKeepAliveInterval(std::chrono::milliseconds(50));
+	Bousk::Network::UDP::Client::SetKeepAliveMode(Bousk::Network::UDP::KeepAliveMode::Periodic);
+	{
+		Peer a;
+		Peer b;
+		CHECK(Init(a, 8890, 1));
+		CHECK(Init(b, 8891, 2));
+
+		a.client.connect(b.address);
+		Run(a, b, std::chrono::seconds(3), [&]() { return a.connected && b.connected; });
+		CHECK(a.connected);
+		CHECK(b.connected);
+
+		// Idle ends send a keep alive per interval, not per frame
+		{
+			Run(a, b, std::chrono::milliseconds(100));
+			const uint64_t sentA = a.client.nbDatagramsSent();
+			const uint64_t sentB = b.client.nbDatagramsSent();
+			Run(a, b, std::chrono::milliseconds(500));
+			CHECK(a.client.nbDatagramsSent() - sentA >= 5);
+			CHECK(a.client.nbDatagramsSent() - sentA <= 15);
+			CHECK(b.client.nbDatagramsSent() - sentB >= 5);
+			CHECK(b.client.nbDatagramsSent() - sentB <= 15);
+			CHECK(!a.disconnected);
+			CHECK(!b.disconnected);
+		}
+
+		// Idle ends remain silent in ack only mode
+		Bousk::Network::UDP::Client::SetKeepAliveMode(Bousk::Network::UDP::KeepAliveMode::AckOnly);
+		{
+			Run(a, b, std::chrono::milliseconds(100));
+			const uint64_t sentA = a.client.nbDatagramsSent();
+			const uint64_t sentB = b.client.nbDatagramsSent();
+			Run(a, b, std::chrono::milliseconds(500));
+			CHECK(a.client.nbDatagramsSent() == sentA);
+			CHECK(b.client.nbDatagramsSent() == sentB);
+			CHECK(!a.disconnected);
+			CHECK(!b.disconnected);
+		}
+
+		// Acks alone let reliable data make progress despite losses
+		// A lost datagram is detected once 64 more have been acked : the sender keeps sending keep alives until then, let them flow faster
+		Bousk::Network::UDP::Client::SetKeepAliveInterval(std::chrono::milliseconds(10));
+		{
+			const uint64_t sentA = a.client.nbDatagramsSent();
+			const uint64_t sentB = b.client.nbDatagramsSent();
+			constexpr uint8_t NbMessages = 100;
+			uint8_t nextMessage = 0;
+			Run(a, b, std::chrono::seconds(10), [&]()
+			{
+				if (nextMessage < NbMessages)
+				{
+					a.client.sendTo(b.address, std::vector<uint8_t>{ nextMessage }, 0);
+					++nextMessage;
+				}
+				return b.received.size() == NbMessages;
+			});
+			CHECK(b.received.size() == NbMessages);
+			bool inOrder = true;
+			for (size_t i = 0; i < b.received.size(); ++i)
+				inOrder = inOrder && b.received[i] == std::vector<uint8_t>{ static_cast<uint8_t>(i) };
+			CHECK(inOrder);
+			// The receiving end only sends acks
+			CHECK(b.client.nbDatagramsSent() - sentB > 0);
+			CHECK(b.client.nbDatagramsSent() - sentB <= a.client.nbDatagramsSent() - sentA);
+			CHECK(!a.disconnected);
+			CHECK(!b.disconnected);
+		}
+
+		a.client.release();
+		b.client.release();
+	}
+	Bousk::Network::UDP::Client::SetKeepAliveMode(Bousk::Network::UDP::KeepAliveMode::Periodic);
+	Bousk::Network::UDP::Client::SetKeepAliveInterval(BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL);
+}
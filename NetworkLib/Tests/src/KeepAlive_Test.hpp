@@ -0,0 +1,7 @@
+#pragma once
+
+class KeepAlive_Test
+{
+public:
+	static void Test();
+};
@@ -0,0 +1,108 @@
+#include <MPSCQueue_Test.hpp>
+#include <Tester.hpp>
+#include <MPSCQueue.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+void MPSCQueue_Test::Test()
+{
+	{
+		Bousk::MPSCQueue<int> queue(5);
+		CHECK(queue.capacity() == 8);
+		CHECK(queue.empty());
+		for (int i = 0; i < 6; ++i)
+			queue.push([&](int& item) { item = i; });
+		CHECK(!queue.empty());
+		CHECK(queue.nbOverflows() == 0);
+		std::vector<int> consumed;
+		CHECK(queue.consume([&](int& item) { consumed.push_back(item); }) == 6);
+		CHECK(queue.empty());
+		CHECK(consumed == std::vector<int>({ 0, 1, 2, 3, 4, 5 }));
+	}
+	{
+		//!< Overflowing items keep their order, and further items wait behind them
+		Bousk::MPSCQueue<int> queue(4);
+		for (int i = 0; i < 10; ++i)
+			queue.push([&](int& item) { item = i; });
+		CHECK(queue.nbOverflows() == 6);
+		std::vector<int> consumed;
+		CHECK(queue.consume([&](int& item) { consumed.push_back(item); }) == 10);
+		CHECK(consumed == std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+		//!< Overflow is over : ring is used again
+		queue.push([&](int& item) { item = 10; });
+		CHECK(queue.nbOverflows() == 6);
+		consumed.clear();
+		CHECK(queue.consume([&](int& item) { consumed.push_back(item); }) == 1);
+		CHECK(consumed == std::vector<int>({ 10 }));
+	}
+	{
+		//!< A producer stalled between claiming a ring slot and publishing it : overflowing items pushed after must wait for it
+		Bousk::MPSCQueue<int> queue(4);
+		std::atomic<bool> isFilling{ false };
+		std::atomic<bool> canPublish{ false };
+		std::thread stalledProducer([&]()
+		{
+			queue.push([&](int& item)
+			{
+				isFilling = true;
+				while (!canPublish)
+					std::this_thread::yield();
+				item = -1;
+			});
+		});
+		while (!isFilling)
+			std::this_thread::yield();
+		for (int i = 1; i <= 5; ++i)
+			queue.push([&](int& item) { item = i; });
+		CHECK(queue.nbOverflows() == 2);
+		std::vector<int> consumed;
+		CHECK(queue.consume([&](int& item) { consumed.push_back(item); }) == 0);
+		CHECK(consumed.empty());
+		CHECK(!queue.empty());
+		canPublish = true;
+		stalledProducer.join();
+		CHECK(queue.consume([&](int& item) { consumed.push_back(item); }) == 6);
+		CHECK(consumed == std::vector<int>({ -1, 1, 2, 3, 4, 5 }));
+		CHECK(queue.empty());
+	}
+	{
+		//!< Concurrent producers : nothing is lost and each producer order is preserved
+		struct Item
+		{
+			int producer;
+			int index;
+		};
+		constexpr int NbProducers = 4;
+		constexpr int NbItemsPerProducer = 20000;
+		Bousk::MPSCQueue<Item> queue(64);
+		std::atomic<int> nbProducersDone{ 0 };
+		std::vector<std::thread> producers;
+		for (int producer = 0; producer < NbProducers; ++producer)
+		{
+			producers.emplace_back([&, producer]()
+			{
+				for (int i = 0; i < NbItemsPerProducer; ++i)
+					queue.push([&](Item& item) { item.producer = producer; item.index = i; });
+				++nbProducersDone;
+			});
+		}
+		std::vector<int> nextIndices(NbProducers, 0);
+		bool ordered = true;
+		size_t nbConsumed = 0;
+		for (bool producersDone = false; !producersDone || !queue.empty();)
+		{
+			producersDone = nbProducersDone == NbProducers;
+			nbConsumed += queue.consume([&](Item& item)
+			{
+				ordered = ordered && item.index == nextIndices[item.producer];
+				nextIndices[item.producer] = item.index + 1;
+			});
+		}
+		for (std::thread& producer : producers)
+			producer.join();
+		CHECK(ordered);
+		CHECK(nbConsumed == NbProducers * NbItemsPerProducer);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class MPSCQueue_Test
+{
+public:
+	static void Test();
+};
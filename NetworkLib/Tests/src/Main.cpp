@@ -1,10 +1,24 @@
 #include "Utils_Test.hpp"
 #include "AckHandler_Test.hpp"
 #include "DistantClient_Test.hpp"
+#include "Datagram_Test.hpp"
+#include "DatagramBatch_Test.hpp"
 #include "UnreliableOrdered_Test.hpp"
 #include "ReliableOrdered_Test.hpp"
+#include "ReliableUnordered_Test.hpp"
+#include "UnreliableSequenced_Test.hpp"
+#include "SnapshotDelta_Test.hpp"
+#include "Compression_Test.hpp"
 #include "Serialization_Test.hpp"
 #include "Types_Test.hpp"
+#include "Address_Test.hpp"
+#include "MPSCQueue_Test.hpp"
+#include "MessagesQueue_Test.hpp"
+#include "BufferPool_Test.hpp"
+#include "EventsQueue_Test.hpp"
+#include "TimerWheel_Test.hpp"
+#include "KeepAlive_Test.hpp"
+#include "RoundTripTime_Test.hpp"
 
 #include <Types.hpp>
 
@@ -20,8 +34,22 @@ int main()
 	AckHandler_Test::Test();
 	UnreliableOrdered_Test::Test();
 	DistantClient_Test::Test();
+	Datagram_Test::Test();
+	DatagramBatch_Test::Test();
 	ReliableOrdered_Test::Test();
+	ReliableUnordered_Test::Test();
+	UnreliableSequenced_Test::Test();
+	SnapshotDelta_Test::Test();
+	Compression_Test::Test();
 	Serialization_Test::Test();
 	Types_Test::Test();
+	Address_Test::Test();
+	MPSCQueue_Test::Test();
+	MessagesQueue_Test::Test();
+	BufferPool_Test::Test();
+	EventsQueue_Test::Test();
+	TimerWheel_Test::Test();
+	RoundTripTime_Test::Test();
+	KeepAlive_Test::Test();
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include <MessagesQueue_Test.hpp>
+#include <Tester.hpp>
+#include <MessagesQueue.hpp>
+
+#include <memory>
+#include <vector>
+
+void MessagesQueue_Test::Test()
+{
+	auto Push = [](Bousk::Network::MessagesQueue& queue, const Bousk::uint64 first, const Bousk::uint64 count)
+	{
+		for (Bousk::uint64 id = first; id < first + count; ++id)
+			queue.push(std::make_unique<Bousk::Network::Messages::UserData>(Bousk::Network::Address(), id, Bousk::Network::Payload(std::vector<Bousk::uint8>{ static_cast<Bousk::uint8>(id) })));
+	};
+	auto IsInOrder = [](const std::vector<std::unique_ptr<Bousk::Network::Messages::Base>>& messages, const Bousk::uint64 first)
+	{
+		bool inOrder = true;
+		for (size_t i = 0; i < messages.size(); ++i)
+			inOrder &= messages[i] && messages[i]->is<Bousk::Network::Messages::UserData>() && messages[i]->emmiterId() == first + i;
+		return inOrder;
+	};
+	{
+		//!< Polling into the same vector from frame to frame keeps its capacity
+		Bousk::Network::MessagesQueue queue;
+		std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> messages;
+		Push(queue, 0, 10);
+		queue.poll(messages);
+		CHECK(messages.size() == 10);
+		CHECK(IsInOrder(messages, 0));
+		const size_t capacity = messages.capacity();
+		const std::unique_ptr<Bousk::Network::Messages::Base>* const storage = messages.data();
+		messages.clear();
+		Push(queue, 10, 5);
+		queue.poll(messages);
+		CHECK(messages.size() == 5);
+		CHECK(IsInOrder(messages, 10));
+		CHECK(messages.capacity() == capacity);
+		CHECK(messages.data() == storage);
+		//!< Messages are appended behind those not handled yet
+		Push(queue, 15, 3);
+		queue.poll(messages);
+		CHECK(messages.size() == 8);
+		CHECK(IsInOrder(messages, 10));
+		queue.poll(messages);
+		CHECK(messages.size() == 8);
+	}
+	{
+		//!< Each message is given once to the callback, and doesn't stay in its slot whether the callback took it or not
+		Bousk::Network::MessagesQueue queue;
+		Push(queue, 0, 6);
+		std::vector<std::unique_ptr<Bousk::Network::Messages::Base>> taken;
+		size_t nbCalls = 0;
+		bool allValid = true;
+		CHECK(queue.poll([&](std::unique_ptr<Bousk::Network::Messages::Base>&& msg)
+		{
+			allValid &= msg && msg->emmiterId() == nbCalls;
+			if (nbCalls++ % 2 == 0)
+				taken.push_back(std::move(msg));
+		}) == 6);
+		CHECK(nbCalls == 6);
+		CHECK(allValid);
+		CHECK(taken.size() == 3);
+		bool slotsReset = true;
+		for (const auto& slot : queue.mMessages.mSlots)
+			slotsReset &= !slot.item;
+		CHECK(slotsReset);
+		CHECK(queue.poll([&](std::unique_ptr<Bousk::Network::Messages::Base>&&) { ++nbCalls; }) == 0);
+		CHECK(nbCalls == 6);
+		//!< Slots are reused
+		Push(queue, 6, 2);
+		CHECK(queue.poll([&](std::unique_ptr<Bousk::Network::Messages::Base>&& msg) { allValid &= msg->emmiterId() == nbCalls++; }) == 2);
+		CHECK(allValid);
+	}
+}
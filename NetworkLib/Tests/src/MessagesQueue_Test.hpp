@@ -0,0 +1,7 @@
+#pragma once
+
+class MessagesQueue_Test
+{
+public:
+	static void Test();
+};
@@ -7,12 +7,13 @@
 
 #include <limits>
 #include <chrono>
+#include <iterator>
 #include <random>
 
 void ReliableOrdered_Multiplexer_Test::Test()
 {
 	Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer mux;
-	CHECK(mux.mQueue.size() == 0);
+	CHECK(mux.nbUnackedPackets() == 0);
 	CHECK(mux.mNextId == 0);
 	CHECK(mux.mFirstAllowedPacket == 0);
 	Bousk::Network::UDP::Datagram::ID datagramId = 0;
@@ -20,7 +21,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 		const std::array<uint8_t, 5> arr{ 'T', 'o', 't', 'o', '\0' };
 		std::vector<uint8_t> data(arr.cbegin(), arr.cend());
 		mux.queue(std::move(data));
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		CHECK(mux.mNextId == 1);
 		CHECK(mux.mFirstAllowedPacket == 0);
 
@@ -32,10 +33,10 @@ void ReliableOrdered_Multiplexer_Test::Test()
 		CHECK(packet->datasize() == arr.size());
 		CHECK(memcmp(packet->data(), arr.data(), packet->datasize()) == 0);
 		//!<The message is still in the queue until acked
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		//!<Ack this datagram
 		mux.onDatagramAcked(sentDatagramId);
-		CHECK(mux.mQueue.size() == 0);
+		CHECK(mux.nbUnackedPackets() == 0);
 		CHECK(mux.mFirstAllowedPacket == 1);
 	}
 	{
@@ -49,11 +50,11 @@ void ReliableOrdered_Multiplexer_Test::Test()
 
 		const auto datacopy = data;
 		mux.queue(std::move(data));
-		CHECK(mux.mQueue.size() == 3);
+		CHECK(mux.nbUnackedPackets() == 3);
 		CHECK(mux.mNextId == 4);
 		size_t totalDataSize = 0;
 		const Bousk::Network::UDP::Datagram::ID firstSentDatagramId = datagramId;
-		const size_t nbPackets = mux.mQueue.size();
+		const size_t nbPackets = mux.nbUnackedPackets();
 		for (;;)
 		{
 			std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
@@ -65,7 +66,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 			totalDataSize += serializedData - Bousk::Network::UDP::Packet::HeaderSize;
 		}
 		CHECK(totalDataSize == datacopy.size());
-		CHECK(mux.mQueue.size() == 3);
+		CHECK(mux.nbUnackedPackets() == 3);
 		//!<Ack each of them
 		size_t acked = 0;
 		for (auto i = 0; i < nbPackets; ++i)
@@ -73,7 +74,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 			const Bousk::Network::UDP::Datagram::ID dgramId = static_cast<Bousk::Network::UDP::Datagram::ID>(firstSentDatagramId + i);
 			mux.onDatagramAcked(dgramId);
 			++acked;
-			CHECK(mux.mQueue.size() == 3 - acked);
+			CHECK(mux.nbUnackedPackets() == 3 - acked);
 		}
 		CHECK(mux.mFirstAllowedPacket == 4);
 	}
@@ -82,7 +83,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 		const std::array<uint8_t, 5> arr{ 'T', 'i', 't', 'i', '\0' };
 		std::vector<uint8_t> data(arr.cbegin(), arr.cend());
 		mux.queue(std::move(data));
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		const Bousk::Network::UDP::Datagram::ID lostDatagramId = datagramId;
 
 		{
@@ -93,7 +94,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 			CHECK(packet->datasize() == arr.size());
 			CHECK(memcmp(packet->data(), arr.data(), packet->datasize()) == 0);
 		}
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		CHECK(mux.mFirstAllowedPacket == 4);
 		
 		//!<The packet hasn't been lost yet, we should have nothing to serialize
@@ -102,7 +103,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 			const size_t serializedData = mux.serialize(buffer.data(), buffer.size(), datagramId++);
 			CHECK(serializedData == 0);
 		}
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		mux.onDatagramLost(lostDatagramId);
 		CHECK(mux.mFirstAllowedPacket == 4);
 
@@ -116,10 +117,10 @@ void ReliableOrdered_Multiplexer_Test::Test()
 			CHECK(packet->datasize() == arr.size());
 			CHECK(memcmp(packet->data(), arr.data(), packet->datasize()) == 0);
 		}
-		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.nbUnackedPackets() == 1);
 		mux.onDatagramAcked(datagramIdToAck);
 		//!< Now it's acked
-		CHECK(mux.mQueue.size() == 0);
+		CHECK(mux.nbUnackedPackets() == 0);
 		CHECK(mux.mFirstAllowedPacket == 5);
 	}
 	{
@@ -133,7 +134,7 @@ void ReliableOrdered_Multiplexer_Test::Test()
 
 		const auto datacopy = data;
 		mux.queue(std::move(data));
-		CHECK(mux.mQueue.size() == 3);
+		CHECK(mux.nbUnackedPackets() == 3);
 		CHECK(mux.mFirstAllowedPacket == 5);
 
 		const auto datagram1 = datagramId;
@@ -151,6 +152,39 @@ void ReliableOrdered_Multiplexer_Test::Test()
 		mux.onDatagramAcked(datagram1);
 		CHECK(mux.mFirstAllowedPacket == 8);
 	}
+	{
+		//!< Queue more packets than the other end can receive at once : the queue grows, and packets wait to be allowed
+		constexpr size_t NbMessages = Bousk::Network::UDP::Protocols::ReliableOrdered::DefaultWindowSize + 10;
+		for (size_t i = 0; i < NbMessages; ++i)
+			mux.queue(std::vector<uint8_t>{ static_cast<uint8_t>(i) });
+		CHECK(mux.nbUnackedPackets() == NbMessages);
+		CHECK(mux.mQueue.size() >= NbMessages);
+
+		std::array<uint8_t, Bousk::Network::UDP::Datagram::DataMaxSize> buffer;
+		const auto firstDatagram = datagramId;
+		const size_t serializedSize = mux.serialize(buffer.data(), buffer.size(), datagramId++);
+		CHECK(serializedSize == Bousk::Network::UDP::Protocols::ReliableOrdered::DefaultWindowSize * (Bousk::Network::UDP::Packet::HeaderSize + 1));
+		CHECK(mux.serialize(buffer.data(), buffer.size(), datagramId++) == 0);
+		mux.onDatagramAcked(firstDatagram);
+		CHECK(mux.nbUnackedPackets() == 10);
+		CHECK(mux.mFirstAllowedPacket == 8 + Bousk::Network::UDP::Protocols::ReliableOrdered::DefaultWindowSize);
+
+		//!< A datagram still in flight when its slot is reused is considered lost, its packets are sent again
+		const auto lostDatagram = datagramId;
+		CHECK(mux.serialize(buffer.data(), buffer.size(), datagramId++) == 10 * (Bousk::Network::UDP::Packet::HeaderSize + 1));
+		datagramId += Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer::SentDatagramsSize - 1;
+		CHECK(mux.serialize(buffer.data(), buffer.size(), datagramId++) == 0);
+		mux.queue(std::vector<uint8_t>{ 42 });
+		const auto datagramReusingSlot = static_cast<Bousk::Network::UDP::Datagram::ID>(lostDatagram + Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer::SentDatagramsSize);
+		CHECK(mux.serialize(buffer.data(), buffer.size(), datagramReusingSlot) == Bousk::Network::UDP::Packet::HeaderSize + 1);
+		CHECK(mux.serialize(buffer.data(), buffer.size(), datagramReusingSlot + 1) == 10 * (Bousk::Network::UDP::Packet::HeaderSize + 1));
+		//!< Late ack of the lost datagram is ignored, that of the last copy acks them
+		mux.onDatagramAcked(lostDatagram);
+		CHECK(mux.nbUnackedPackets() == 11);
+		mux.onDatagramAcked(datagramReusingSlot + 1);
+		mux.onDatagramAcked(datagramReusingSlot);
+		CHECK(mux.nbUnackedPackets() == 0);
+	}
 }
 
 void ReliableOrdered_Demultiplexer_Test::Test()
@@ -187,7 +221,7 @@ void ReliableOrdered_Demultiplexer_Test::Test()
 			CHECK(memcmp(packet.data(), arr1.data(), arr1.size()) == 0);
 			demux.onDataReceived(packet.buffer(), packet.size());
 		}
-		const std::vector<std::vector<uint8_t>> packets = demux.process();
+		const std::vector<Bousk::Network::Payload> packets = demux.process();
 		CHECK(packets.size() == 2);
 		CHECK(demux.mLastProcessed == 1);
 		CHECK(packets[0].size() == data0.size());
@@ -236,7 +270,7 @@ void ReliableOrdered_Demultiplexer_Test::Test()
 			CHECK(serializedData == 0);
 			mux.onDatagramAcked(sentDatagramdId);
 		}
-		const std::vector<std::vector<uint8_t>> packets = demux.process();
+		const std::vector<Bousk::Network::Payload> packets = demux.process();
 		CHECK(packets.size() == 1);
 		CHECK(demux.mLastProcessed == 4);
 		CHECK(packets[0].size() == datacopy.size());
@@ -282,10 +316,130 @@ void ReliableOrdered_Demultiplexer_Test::Test()
 			const size_t serializedData = mux.serialize(reinterpret_cast<uint8_t*>(&packet), Bousk::Network::UDP::Packet::PacketMaxSize, datagramId++);
 			demux.onDataReceived(packet.buffer(), packet.size());
 		}
-		const std::vector<std::vector<uint8_t>> packets = demux.process();
+		const std::vector<Bousk::Network::Payload> packets = demux.process();
 		CHECK(packets.size() == 1);
 		CHECK(demux.mLastProcessed == 7);
 		CHECK(packets[0].size() == datacopy.size());
 		CHECK(packets[0] == datacopy);
 	}
+	{
+		//!< Window larger than the default : up to windowSize packets in flight, stored out of order only once needed
+		constexpr uint16_t WindowSize = 4 * Bousk::Network::UDP::Protocols::ReliableOrdered::DefaultWindowSize;
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer bigMux(WindowSize);
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Demultiplexer bigDemux(WindowSize);
+		for (size_t i = 0; i < WindowSize + 1; ++i)
+			bigMux.queue(std::vector<uint8_t>{ static_cast<uint8_t>(i) });
+		std::vector<Bousk::Network::UDP::Packet> packets;
+		Bousk::Network::UDP::Datagram::ID bigDatagramId = 0;
+		for (;;)
+		{
+			Bousk::Network::UDP::Packet packet;
+			if (bigMux.serialize(reinterpret_cast<uint8_t*>(&packet), Bousk::Network::UDP::Packet::HeaderSize + 1, bigDatagramId++) == 0)
+				break;
+			packets.push_back(packet);
+		}
+		CHECK(packets.size() == WindowSize);
+
+		//!< In order packets don't need any storage
+		bigDemux.onDataReceived(packets[0].buffer(), packets[0].size());
+		CHECK(bigDemux.mPendingQueue.empty());
+		//!< Receive all others but the second one, backwards
+		for (size_t i = packets.size() - 1; i >= 2; --i)
+			bigDemux.onDataReceived(packets[i].buffer(), packets[i].size());
+		CHECK(bigDemux.mPendingQueue.size() == WindowSize);
+		CHECK(bigDemux.process().size() == 1);
+		CHECK(bigDemux.mLastProcessed == 0);
+		bigDemux.onDataReceived(packets[1].buffer(), packets[1].size());
+		const std::vector<Bousk::Network::Payload> messages = bigDemux.process();
+		CHECK(messages.size() == WindowSize - 1);
+		bool inOrder = true;
+		for (size_t i = 0; i < messages.size(); ++i)
+			inOrder &= messages[i].size() == 1 && messages[i][0] == static_cast<uint8_t>(i + 1);
+		CHECK(inOrder);
+		CHECK(bigDemux.mLastProcessed == WindowSize - 1);
+
+		//!< A packet beyond the window is ignored
+		Bousk::Network::UDP::Packet beyondWindow = packets[0];
+		beyondWindow.header.id = static_cast<Bousk::Network::UDP::Packet::Id>(bigDemux.mLastProcessed + 1 + WindowSize);
+		bigDemux.onDataReceived(beyondWindow.buffer(), beyondWindow.size());
+		CHECK(bigDemux.process().empty());
+	}
+	{
+		//!< Packets received out of order in a pooled buffer are kept in it, and delivered without copy
+		std::shared_ptr<Bousk::BufferPool> pool = Bousk::BufferPool::Create(sizeof(Bousk::Network::UDP::Packet));
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer viewMux;
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Demultiplexer viewDemux;
+		viewMux.queue(std::vector<uint8_t>{ 1 });
+		viewMux.queue(std::vector<uint8_t>{ 2 });
+		Bousk::BufferPool::Buffer first = pool->acquire();
+		Bousk::BufferPool::Buffer second = pool->acquire();
+		viewMux.serialize(first.data(), Bousk::Network::UDP::Packet::HeaderSize + 1, 0);
+		viewMux.serialize(second.data(), Bousk::Network::UDP::Packet::HeaderSize + 1, 1);
+		viewDemux.onDataReceived(second.data(), Bousk::Network::UDP::Packet::HeaderSize + 1, second);
+		second.reset();
+		CHECK(viewDemux.process().empty());
+		viewDemux.onDataReceived(first.data(), Bousk::Network::UDP::Packet::HeaderSize + 1, first);
+		const std::vector<Bousk::Network::Payload> messages = viewDemux.process();
+		CHECK(messages.size() == 2);
+		CHECK(messages[0].isView() && messages[0] == std::vector<uint8_t>{ 1 });
+		CHECK(messages[1].isView() && messages[1] == std::vector<uint8_t>{ 2 });
+	}
+	{
+		//!< Last fragment of a large message lost once : the sender must not send beyond the receiver window meanwhile
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Multiplexer lossMux;
+		Bousk::Network::UDP::Protocols::ReliableOrdered::Demultiplexer lossDemux;
+		std::vector<uint8_t> bigMessage(Bousk::Network::UDP::Packet::MaxMessageSize);
+		for (size_t i = 0; i < bigMessage.size(); ++i)
+			bigMessage[i] = static_cast<uint8_t>(i);
+		lossMux.queue(std::vector<uint8_t>(bigMessage));
+		constexpr size_t NbSmallMessages = Bousk::Network::UDP::Protocols::ReliableOrdered::DefaultWindowSize;
+		for (size_t i = 0; i < NbSmallMessages; ++i)
+			lossMux.queue(std::vector<uint8_t>{ static_cast<uint8_t>(i) });
+
+		std::vector<Bousk::Network::Payload> messages;
+		Bousk::Network::UDP::Datagram::ID lossDatagramId = 0;
+		bool isLastFragmentLost = false;
+		bool isLossPending = false;
+		Bousk::Network::UDP::Datagram::ID lostDatagramId = 0;
+		for (int frame = 0; frame < 1000 && messages.size() < NbSmallMessages + 1; ++frame)
+		{
+			std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+			const Bousk::Network::UDP::Datagram::ID sentDatagramId = lossDatagramId++;
+			const uint16_t serializedSize = lossMux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), sentDatagramId);
+			if (serializedSize == 0)
+			{
+				//!< Nothing left to send : the loss is detected
+				if (isLossPending)
+				{
+					CHECK(lossMux.mFirstAllowedPacket == 0);
+					lossMux.onDatagramLost(lostDatagramId);
+					isLossPending = false;
+				}
+				continue;
+			}
+			const Bousk::Network::UDP::Packet* firstPacket = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data());
+			if (!isLastFragmentLost && firstPacket->type() == Bousk::Network::UDP::Packet::Type::LastFragment)
+			{
+				isLastFragmentLost = true;
+				isLossPending = true;
+				lostDatagramId = sentDatagramId;
+				continue;
+			}
+			lossDemux.onDataReceived(buffer.data(), serializedSize);
+			lossMux.onDatagramAcked(sentDatagramId);
+			std::vector<Bousk::Network::Payload> received = lossDemux.process();
+			messages.insert(messages.end(), std::make_move_iterator(received.begin()), std::make_move_iterator(received.end()));
+		}
+		CHECK(isLastFragmentLost);
+		CHECK(messages.size() == NbSmallMessages + 1);
+		CHECK(lossMux.nbUnackedPackets() == 0);
+		if (messages.size() == NbSmallMessages + 1)
+		{
+			CHECK(messages[0] == bigMessage);
+			bool inOrder = true;
+			for (size_t i = 0; i < NbSmallMessages; ++i)
+				inOrder &= messages[i + 1].size() == 1 && messages[i + 1][0] == static_cast<uint8_t>(i);
+			CHECK(inOrder);
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "ReliableUnordered_Test.hpp"
+#include "Tester.hpp"
+
+#include <UDP/Protocols/ReliableUnordered.hpp>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	//!< Split queued packets to receive them one by one
+	std::vector<Bousk::Network::UDP::Packet> Serialize(Bousk::Network::UDP::Protocols::ReliableMultiplexer& mux, Bousk::Network::UDP::Datagram::ID& datagramId)
+	{
+		std::vector<Bousk::Network::UDP::Packet> packets;
+		std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+		while (const uint16_t serializedSize = mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), datagramId++))
+		{
+			for (uint16_t offset = 0; offset < serializedSize; offset += packets.back().size())
+			{
+				packets.emplace_back();
+				memcpy(&packets.back(), buffer.data() + offset, reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data() + offset)->size());
+			}
+		}
+		return packets;
+	}
+}
+
+void ReliableUnordered_Test::Test()
+{
+	Bousk::Network::UDP::Protocols::ReliableMultiplexer mux;
+	Bousk::Network::UDP::Protocols::ReliableUnordered::Demultiplexer demux;
+	Bousk::Network::UDP::Datagram::ID datagramId = 0;
+	CHECK(demux.mFirstMissing == 0);
+	{
+		//!< Messages received in order need no storage
+		mux.queue(std::vector<uint8_t>{ 0 });
+		mux.queue(std::vector<uint8_t>{ 1 });
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize(mux, datagramId);
+		CHECK(packets.size() == 2);
+		for (const Bousk::Network::UDP::Packet& packet : packets)
+			demux.onDataReceived(packet.buffer(), packet.size());
+		const std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 2);
+		CHECK(messages[0] == std::vector<uint8_t>{ 0 });
+		CHECK(messages[1] == std::vector<uint8_t>{ 1 });
+		CHECK(demux.mFirstMissing == 2);
+		CHECK(demux.mReceived.empty());
+		CHECK(demux.mPendingFragments.empty());
+	}
+	{
+		//!< A lost packet doesn't delay the next ones, duplicates are ignored
+		mux.queue(std::vector<uint8_t>{ 2 });
+		mux.queue(std::vector<uint8_t>{ 3 });
+		mux.queue(std::vector<uint8_t>{ 4 });
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize(mux, datagramId);
+		CHECK(packets.size() == 3);
+		demux.onDataReceived(packets[2].buffer(), packets[2].size());
+		demux.onDataReceived(packets[1].buffer(), packets[1].size());
+		demux.onDataReceived(packets[2].buffer(), packets[2].size());
+		std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 2);
+		CHECK(messages[0] == std::vector<uint8_t>{ 4 });
+		CHECK(messages[1] == std::vector<uint8_t>{ 3 });
+		CHECK(demux.mFirstMissing == 2);
+
+		demux.onDataReceived(packets[0].buffer(), packets[0].size());
+		demux.onDataReceived(packets[1].buffer(), packets[1].size());
+		messages = demux.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == std::vector<uint8_t>{ 2 });
+		CHECK(demux.mFirstMissing == 5);
+		CHECK(!demux.isReceived(5) && !demux.isReceived(6));
+	}
+	{
+		//!< Fragmented message completed after a newer message, each fragment received out of order
+		std::vector<uint8_t> data(Bousk::Network::UDP::Packet::DataMaxSize * 3);
+		for (size_t i = 0; i < data.size(); ++i)
+			data[i] = static_cast<uint8_t>(i);
+		mux.queue(std::vector<uint8_t>(data));
+		mux.queue(std::vector<uint8_t>{ 5 });
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize(mux, datagramId);
+		CHECK(packets.size() == 4);
+		for (size_t index : { 2, 3, 0 })
+			demux.onDataReceived(packets[index].buffer(), packets[index].size());
+		std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == std::vector<uint8_t>{ 5 });
+		CHECK(demux.mFirstMissing == 6);
+
+		demux.onDataReceived(packets[1].buffer(), packets[1].size());
+		messages = demux.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == data);
+		CHECK(demux.mFirstMissing == 9);
+		bool released = true;
+		for (const Bousk::Network::UDP::Protocols::PendingPacket& pendingPacket : demux.mPendingFragments)
+			released &= pendingPacket.packet() == nullptr;
+		CHECK(released);
+		//!< Late duplicates of its fragments are ignored
+		demux.onDataReceived(packets[2].buffer(), packets[2].size());
+		CHECK(demux.process().empty());
+	}
+	{
+		//!< Over a lossy link, every message is delivered once
+		Bousk::Network::UDP::Protocols::ReliableUnordered sender;
+		Bousk::Network::UDP::Protocols::ReliableUnordered receiver;
+		constexpr size_t NbMessages = 200;
+		for (size_t i = 0; i < NbMessages; ++i)
+			sender.queue(std::vector<uint8_t>((i % 10 == 0) ? Bousk::Network::UDP::Packet::DataMaxSize * 2 : 1, static_cast<uint8_t>(i)));
+		std::vector<size_t> nbReceived(NbMessages, 0);
+		std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+		for (Bousk::Network::UDP::Datagram::ID id = 0; id < 2000; ++id)
+		{
+			const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), id);
+			if (serializedSize == 0)
+				continue;
+			if (id % 3 == 0)
+			{
+				sender.onDatagramLost(id);
+				continue;
+			}
+			receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+			if (id % 4 == 0)
+				receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+			sender.onDatagramAcked(id);
+			for (const Bousk::Network::Payload& message : receiver.process())
+				++nbReceived[message[0]];
+		}
+		bool allOnce = true;
+		for (size_t count : nbReceived)
+			allOnce &= count == 1;
+		CHECK(allOnce);
+	}
+}
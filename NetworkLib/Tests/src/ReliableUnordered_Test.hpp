@@ -0,0 +1,7 @@
+#pragma once
+
+class ReliableUnordered_Test
+{
+public:
+	static void Test();
+};
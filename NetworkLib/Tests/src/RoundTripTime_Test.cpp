@@ -0,0 +1,51 @@
+#include <RoundTripTime_Test.hpp>
+#include <Tester.hpp>
+
+#include <UDP/RoundTripTime.hpp>
+
+#include <chrono>
+
+void RoundTripTime_Test::Test()
+{
+	using RoundTripTime = Bousk::Network::UDP::RoundTripTime;
+	{
+		RoundTripTime rtt;
+		CHECK(!rtt.hasSample());
+		CHECK(rtt.retransmissionTimeout() == RoundTripTime::InitialTimeout);
+		//!< First sample initializes the variation to half of it
+		rtt.onSample(std::chrono::milliseconds(100));
+		CHECK(rtt.hasSample());
+		CHECK(rtt.smoothed() == std::chrono::milliseconds(100));
+		CHECK(rtt.variation() == std::chrono::milliseconds(50));
+		CHECK(rtt.retransmissionTimeout() == std::chrono::milliseconds(300));
+		//!< Stable samples reduce the variation
+		rtt.onSample(std::chrono::milliseconds(100));
+		CHECK(rtt.smoothed() == std::chrono::milliseconds(100));
+		CHECK(rtt.variation() == std::chrono::microseconds(37500));
+		CHECK(rtt.retransmissionTimeout() == std::chrono::milliseconds(250));
+		//!< A late sample moves the average by an eighth of the difference
+		rtt.onSample(std::chrono::milliseconds(180));
+		CHECK(rtt.smoothed() == std::chrono::milliseconds(110));
+		CHECK(rtt.variation() == std::chrono::microseconds(48125));
+		//!< Timeouts back off until the next sample
+		const auto timeout = rtt.retransmissionTimeout();
+		rtt.onTimeout();
+		CHECK(rtt.retransmissionTimeout() == 2 * timeout);
+		rtt.onTimeout();
+		CHECK(rtt.retransmissionTimeout() == 4 * timeout);
+		rtt.onSample(std::chrono::milliseconds(110));
+		CHECK(rtt.retransmissionTimeout() < 2 * timeout);
+	}
+	{
+		//!< Timeout remains within bounds
+		RoundTripTime rtt;
+		for (int i = 0; i < 20; ++i)
+			rtt.onSample(std::chrono::milliseconds(0));
+		CHECK(rtt.retransmissionTimeout() == RoundTripTime::MinTimeout);
+		for (int i = 0; i < 10; ++i)
+			rtt.onTimeout();
+		CHECK(rtt.retransmissionTimeout() == RoundTripTime::MaxTimeout);
+		rtt.onSample(std::chrono::seconds(10));
+		CHECK(rtt.retransmissionTimeout() == RoundTripTime::MaxTimeout);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class RoundTripTime_Test
+{
+public:
+	static void Test();
+};
@@ -8,6 +8,7 @@
 #include <RangedInteger.hpp>
 #include <Float.hpp>
 
+#include <random>
 #include <string>
 #include <vector>
 
@@ -205,6 +206,31 @@ void Serialization_Test::TestBits()
 #undef READ_AND_CHECK
 #undef READ_AND_CHECK_BOOL
 	}
+	{
+		// Values of any size, at any bit offset, read back
+		std::mt19937_64 random(42);
+		std::vector<std::pair<Bousk::uint64, Bousk::uint64>> values; // value, max
+		Bousk::Serialization::Serializer serializer;
+		size_t nbBits = 0;
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			const Bousk::uint8 valueBits = static_cast<Bousk::uint8>(1 + random() % 64);
+			const Bousk::uint64 max = (valueBits == 64) ? std::numeric_limits<Bousk::uint64>::max() : (Bousk::uint64(1) << valueBits) - 1;
+			const Bousk::uint64 value = random() & max;
+			values.emplace_back(value, max);
+			CHECK(serializer.write(value, static_cast<Bousk::uint64>(0), max));
+			nbBits += valueBits;
+			CHECK(serializer.bufferSize() == (nbBits + 7) / 8);
+			CHECK(serializer.mUsedBits == nbBits % 8);
+		}
+		Bousk::Serialization::Deserializer deserializer(serializer.buffer(), serializer.bufferSize());
+		for (const auto& value : values)
+		{
+			Bousk::uint64 data;
+			CHECK(deserializer.read(data, static_cast<Bousk::uint64>(0), value.second));
+			CHECK(data == value.first);
+		}
+	}
 }
 
 void Serialization_Test::TestAdvanced()
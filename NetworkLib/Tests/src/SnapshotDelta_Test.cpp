@@ -0,0 +1,202 @@
+#include "SnapshotDelta_Test.hpp"
+#include "Tester.hpp"
+
+#include <Float.hpp>
+#include <RangedInteger.hpp>
+#include <Replication/Snapshot.hpp>
+#include <Serialization/Deserializer.hpp>
+#include <Serialization/Serializer.hpp>
+#include <UDP/Protocols/SnapshotDelta.hpp>
+
+#include <array>
+#include <vector>
+
+namespace
+{
+	struct Entity : public Bousk::Network::Replication::Object
+	{
+		Bousk::Float32<-100, 100, 2> x{ 0.f };
+		Bousk::Float32<-100, 100, 2> y{ 0.f };
+		Bousk::RangedInteger<0, 100> health{ 100 };
+		bool alive{ true };
+
+		void write(Bousk::Network::Replication::FieldsWriter& writer) const override
+		{
+			writer.write(x);
+			writer.write(y);
+			writer.write(health);
+			writer.write(alive);
+		}
+		bool read(Bousk::Network::Replication::FieldsReader& reader) override
+		{
+			return reader.read(x) && reader.read(y) && reader.read(health) && reader.read(alive);
+		}
+		bool operator==(const Entity& other) const { return x.quantized().get() == other.x.quantized().get() && y.quantized().get() == other.y.quantized().get() && health.get() == other.health.get() && alive == other.alive; }
+	};
+	Bousk::Network::Replication::Snapshot Scene(const size_t nbEntities, const size_t movingEntity = static_cast<size_t>(-1))
+	{
+		Bousk::Network::Replication::Snapshot snapshot;
+		for (size_t i = 0; i < nbEntities; ++i)
+		{
+			Entity entity;
+			entity.x = static_cast<float>(i % 100);
+			entity.y = (i == movingEntity) ? 50.f : -50.f;
+			snapshot.add(static_cast<Bousk::Network::Replication::ObjectId>(i), entity);
+		}
+		return snapshot;
+	}
+}
+
+void SnapshotDelta_Test::Test()
+{
+	using Snapshot = Bousk::Network::Replication::Snapshot;
+	using SnapshotDelta = Bousk::Network::UDP::Protocols::SnapshotDelta;
+	std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+	{
+		//!< Full snapshot round trip
+		const Snapshot snapshot = Scene(100);
+		const std::vector<uint8_t> data = snapshot.serialize();
+		Snapshot received;
+		CHECK(received.deserialize(data.data(), data.size()));
+		CHECK(received.nbObjects() == 100);
+		Entity entity;
+		CHECK(received.get(42, entity));
+		CHECK(entity.x.get() == 42.f && entity.health.get() == 100);
+		CHECK(!received.get(100, entity));
+		CHECK(received.serialize() == data);
+	}
+	{
+		//!< Against a baseline, unchanged objects cost their id and 1 bit, unchanged fields of changed objects 1 bit
+		const Snapshot baseline = Scene(100);
+		Bousk::Serialization::Serializer unchanged;
+		CHECK(baseline.write(unchanged, &baseline, 0, baseline.nbObjects()));
+		const size_t unchangedBits = Snapshot::NbObjectsBits(100) + 100 * (5 + 1);
+		CHECK(unchanged.bufferSize() == (unchangedBits + 7) / 8);
+
+		const Snapshot snapshot = Scene(100, 10);
+		Bousk::Serialization::Serializer changed;
+		CHECK(snapshot.write(changed, &baseline, 0, snapshot.nbObjects()));
+		CHECK(changed.bufferSize() == (unchangedBits + 1 + 4 + 15 + 7) / 8);
+		CHECK(snapshot.objectBits(10, &baseline, 10) == 5 + 1 + 1 + 4 + 15);
+		Bousk::Serialization::Deserializer deserializer(changed.buffer(), changed.bufferSize());
+		Snapshot received;
+		CHECK(received.read(deserializer, &baseline));
+		CHECK(received.serialize() == snapshot.serialize());
+		Entity entity;
+		CHECK(received.get(10, entity) && entity.y.get() == 50.f);
+	}
+	{
+		//!< Objects missing from the snapshot are removed, new ones are written in full
+		const Snapshot baseline = Scene(10);
+		Snapshot snapshot;
+		for (Bousk::Network::Replication::ObjectId id = 0; id < 10; ++id)
+		{
+			Entity entity;
+			if (id != 5 && baseline.get(id, entity))
+				snapshot.add(id, entity);
+		}
+		snapshot.add(1000, Entity());
+		Bousk::Serialization::Serializer serializer;
+		CHECK(snapshot.write(serializer, &baseline, 0, snapshot.nbObjects()));
+		Bousk::Serialization::Deserializer deserializer(serializer.buffer(), serializer.bufferSize());
+		Snapshot received;
+		CHECK(received.read(deserializer, &baseline));
+		CHECK(received.nbObjects() == 10);
+		CHECK(!received.contains(5));
+		CHECK(received.contains(1000));
+	}
+	{
+		//!< A snapshot becomes the baseline once its datagram is acked
+		SnapshotDelta sender;
+		SnapshotDelta receiver;
+		const std::vector<uint8_t> first = Scene(100).serialize();
+		sender.queue(std::vector<uint8_t>(first));
+		uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+		const uint16_t fullSize = serializedSize;
+		CHECK(fullSize > 0);
+		CHECK(sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 1) == 0);
+		receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		std::vector<Bousk::Network::Payload> messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == first);
+
+		//!< Not acked yet : sent in full again
+		sender.queue(std::vector<uint8_t>(first));
+		CHECK(!sender.mMultiplexer.mSendingHasBaseline);
+		serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 1);
+		CHECK(serializedSize == fullSize);
+		sender.onDatagramLost(1);
+		sender.onDatagramAcked(0);
+		CHECK(sender.mMultiplexer.mHasBaseline && sender.mMultiplexer.mBaseline == 0);
+
+		const std::vector<uint8_t> moved = Scene(100, 3).serialize();
+		sender.queue(std::vector<uint8_t>(moved));
+		CHECK(sender.mMultiplexer.mSendingHasBaseline);
+		serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 2);
+		CHECK(serializedSize < fullSize / 5);
+		receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == moved);
+
+		//!< The baseline is never an older snapshot
+		sender.onDatagramAcked(2);
+		CHECK(sender.mMultiplexer.mBaseline == 2);
+		sender.onDatagramAcked(1);
+		CHECK(sender.mMultiplexer.mBaseline == 2);
+
+		//!< Without its baseline, a delta can't be decoded
+		SnapshotDelta otherReceiver;
+		otherReceiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		CHECK(otherReceiver.process().empty());
+	}
+	{
+		//!< Snapshots larger than a packet are split into parts, received once all parts are
+		SnapshotDelta sender;
+		SnapshotDelta receiver;
+		const std::vector<uint8_t> large = Scene(2000).serialize();
+		sender.queue(std::vector<uint8_t>(large));
+		std::vector<std::vector<uint8_t>> datagrams;
+		while (const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), static_cast<uint16_t>(datagrams.size())))
+			datagrams.emplace_back(buffer.data(), buffer.data() + serializedSize);
+		CHECK(datagrams.size() > 1);
+		CHECK(sender.mMultiplexer.mSent[0].nbParts == datagrams.size());
+		for (size_t i = datagrams.size(); i-- > 0; )
+		{
+			CHECK(receiver.process().empty());
+			receiver.onDataReceived(datagrams[i].data(), static_cast<uint16_t>(datagrams[i].size()), Bousk::BufferPool::Buffer());
+			if (i != 0)
+				sender.onDatagramAcked(static_cast<uint16_t>(i));
+		}
+		std::vector<Bousk::Network::Payload> messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == large);
+		CHECK(!sender.mMultiplexer.mHasBaseline);
+		sender.onDatagramAcked(0);
+		CHECK(sender.mMultiplexer.mHasBaseline);
+
+		//!< Against it, the next one takes fewer parts
+		const std::vector<uint8_t> moved = Scene(2000, 1500).serialize();
+		sender.queue(std::vector<uint8_t>(moved));
+		const size_t nbFullParts = datagrams.size();
+		datagrams.clear();
+		while (const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), static_cast<uint16_t>(100 + datagrams.size())))
+			datagrams.emplace_back(buffer.data(), buffer.data() + serializedSize);
+		CHECK(datagrams.size() * 5 < nbFullParts);
+		for (const std::vector<uint8_t>& datagram : datagrams)
+			receiver.onDataReceived(datagram.data(), static_cast<uint16_t>(datagram.size()), Bousk::BufferPool::Buffer());
+		messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == moved);
+
+		//!< A part missing and the snapshot is never received
+		sender.queue(std::vector<uint8_t>(large));
+		datagrams.clear();
+		while (const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), static_cast<uint16_t>(200 + datagrams.size())))
+			datagrams.emplace_back(buffer.data(), buffer.data() + serializedSize);
+		CHECK(datagrams.size() > 1);
+		for (size_t i = 1; i < datagrams.size(); ++i)
+			receiver.onDataReceived(datagrams[i].data(), static_cast<uint16_t>(datagrams[i].size()), Bousk::BufferPool::Buffer());
+		CHECK(receiver.process().empty());
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class SnapshotDelta_Test
+{
+public:
+	static void Test();
+};
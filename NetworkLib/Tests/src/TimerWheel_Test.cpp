@@ -0,0 +1,113 @@
+#include <TimerWheel_Test.hpp>
+#include <Tester.hpp>
+#include <TimerWheel.hpp>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Owner
+	{
+		Owner() : timer(*this) {}
+		Bousk::TimerWheel<Owner>::Timer timer;
+		std::chrono::milliseconds expectedDeadline{ 0 };
+		std::chrono::milliseconds expiredAt{ -1 };
+	};
+}
+
+void TimerWheel_Test::Test()
+{
+	using ms = std::chrono::milliseconds;
+	const ms start(1000000);
+	{
+		Bousk::TimerWheel<Owner> wheel(start);
+		CHECK(wheel.empty());
+		CHECK(wheel.nextExpiration() == ms::max());
+		Owner soon, later, cancelled;
+		wheel.schedule(soon.timer, start + ms(10));
+		wheel.schedule(later.timer, start + ms(100));
+		wheel.schedule(cancelled.timer, start + ms(50));
+		CHECK(wheel.size() == 3);
+		CHECK(wheel.nextExpiration() == start + ms(10));
+		cancelled.timer.cancel();
+		CHECK(!cancelled.timer.isScheduled());
+		CHECK(wheel.size() == 2);
+
+		std::vector<Owner*> expired;
+		wheel.advance(start + ms(9), [&](Owner& owner) { expired.push_back(&owner); });
+		CHECK(expired.empty());
+		wheel.advance(start + ms(10), [&](Owner& owner) { expired.push_back(&owner); });
+		CHECK(expired.size() == 1 && expired[0] == &soon);
+		CHECK(!soon.timer.isScheduled());
+		//!< Upper levels only give a lower bound
+		CHECK(wheel.nextExpiration() <= start + ms(100));
+		wheel.advance(start + ms(99), [&](Owner& owner) { expired.push_back(&owner); });
+		CHECK(expired.size() == 1);
+		wheel.advance(start + ms(500), [&](Owner& owner) { expired.push_back(&owner); });
+		CHECK(expired.size() == 2 && expired[1] == &later);
+		CHECK(wheel.empty());
+	}
+	{
+		//!< A deadline already reached expires with next advance, and timers can be rescheduled while expiring
+		Bousk::TimerWheel<Owner> wheel(start);
+		Owner owner;
+		wheel.schedule(owner.timer, start - ms(5));
+		size_t nbExpirations = 0;
+		wheel.advance(start + ms(1), [&](Owner& o) { ++nbExpirations; wheel.schedule(o.timer, wheel.now() + ms(20)); });
+		CHECK(nbExpirations == 1);
+		CHECK(owner.timer.isScheduled());
+		wheel.advance(start + ms(30), [&](Owner&) { ++nbExpirations; });
+		CHECK(nbExpirations == 2);
+	}
+	{
+		//!< Random deadlines over every level expire on time, whatever the advance steps
+		Bousk::TimerWheel<Owner> wheel(start);
+		std::vector<std::unique_ptr<Owner>> owners;
+		std::mt19937 generator(42);
+		std::uniform_int_distribution<int> deadlines(1, 400000);
+		for (int i = 0; i < 2000; ++i)
+		{
+			owners.push_back(std::make_unique<Owner>());
+			owners.back()->expectedDeadline = start + ms(deadlines(generator));
+			wheel.schedule(owners.back()->timer, owners.back()->expectedDeadline);
+		}
+		std::uniform_int_distribution<int> steps(1, 3000);
+		bool nextExpirationIsLowerBound = true;
+		for (ms now = start; !wheel.empty(); )
+		{
+			const ms nextExpiration = wheel.nextExpiration();
+			now += ms(steps(generator));
+			wheel.advance(now, [&](Owner& owner)
+			{
+				owner.expiredAt = now;
+				nextExpirationIsLowerBound = nextExpirationIsLowerBound && nextExpiration <= owner.expectedDeadline;
+			});
+		}
+		CHECK(nextExpirationIsLowerBound);
+		size_t nbLate = 0;
+		size_t nbEarly = 0;
+		for (const auto& owner : owners)
+		{
+			nbEarly += owner->expiredAt < owner->expectedDeadline;
+			nbLate += owner->expiredAt >= owner->expectedDeadline + ms(3000);
+		}
+		CHECK(nbEarly == 0);
+		CHECK(nbLate == 0);
+	}
+	{
+		//!< Timers cancel themselves when destroyed
+		Bousk::TimerWheel<Owner> wheel(start);
+		{
+			Owner owner;
+			wheel.schedule(owner.timer, start + ms(10));
+			CHECK(wheel.size() == 1);
+		}
+		CHECK(wheel.empty());
+		size_t nbExpirations = 0;
+		wheel.advance(start + ms(20), [&](Owner&) { ++nbExpirations; });
+		CHECK(nbExpirations == 0);
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class TimerWheel_Test
+{
+public:
+	static void Test();
+};
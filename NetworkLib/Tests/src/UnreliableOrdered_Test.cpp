@@ -60,7 +60,7 @@ void Demultiplexer_Test::Test()
 	//!< It's been tested before so it's reliable
 	Bousk::Network::UDP::Protocols::UnreliableOrdered::Multiplexer mux;
 	Bousk::Network::UDP::Protocols::UnreliableOrdered::Demultiplexer demux;
-	CHECK(demux.mPendingQueue.empty());
+	CHECK(demux.mNbPending == 0);
 	CHECK(demux.mLastProcessed == std::numeric_limits<Bousk::Network::UDP::Packet::Id>::max());
 	{
 		const std::array<uint8_t, 5> arr0{ 'T', 'o', 't', 'o', '\0' };
@@ -88,8 +88,10 @@ void Demultiplexer_Test::Test()
 			CHECK(memcmp(packet.data(), arr1.data(), arr1.size()) == 0);
 			demux.onDataReceived(packet.buffer(), packet.size());
 		}
-		CHECK(demux.mPendingQueue.size() == 2);
-		const std::vector<std::vector<uint8_t>> packets = demux.process();
+		//!< Full messages with nothing pending are ready without going through the queue
+		CHECK(demux.mNbPending == 0);
+		CHECK(demux.mReadyMessages.size() == 2);
+		const std::vector<Bousk::Network::Payload> packets = demux.process();
 		CHECK(packets.size() == 2);
 		CHECK(demux.mLastProcessed == 1);
 		CHECK(packets[0].size() == data0.size());
@@ -116,11 +118,80 @@ void Demultiplexer_Test::Test()
 				break;
 			demux.onDataReceived(packet.buffer(), packet.size());
 		}
-		CHECK(demux.mPendingQueue.size() == 3);
-		const std::vector<std::vector<uint8_t>> packets = demux.process();
+		CHECK(demux.mNbPending == 3);
+		const std::vector<Bousk::Network::Payload> packets = demux.process();
 		CHECK(packets.size() == 1);
 		CHECK(demux.mLastProcessed == 4);
 		CHECK(packets[0].size() == datacopy.size());
 		CHECK(packets[0] == datacopy);
 	}
+	//!< Split queued packets to receive them one by one
+	auto Serialize = [&mux]()
+	{
+		std::vector<Bousk::Network::UDP::Packet> packets;
+		std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+		while (const uint16_t serializedSize = mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0))
+		{
+			for (uint16_t offset = 0; offset < serializedSize; offset += packets.back().size())
+			{
+				packets.emplace_back();
+				memcpy(&packets.back(), buffer.data() + offset, reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data() + offset)->size());
+			}
+		}
+		return packets;
+	};
+	{
+		//!< Fragments received out of order and duplicated
+		const std::vector<uint8_t> data(Bousk::Network::UDP::Packet::DataMaxSize * 3, 42);
+		mux.queue(std::vector<uint8_t>(data));
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize();
+		CHECK(packets.size() == 3);
+		for (size_t index : { 2, 0, 2, 0 })
+			demux.onDataReceived(packets[index].buffer(), packets[index].size());
+		CHECK(demux.mNbPending == 2);
+		CHECK(demux.process().empty());
+		demux.onDataReceived(packets[1].buffer(), packets[1].size());
+		const std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == data);
+		CHECK(demux.mNbPending == 0);
+		CHECK(demux.mLastProcessed == 7);
+	}
+	{
+		//!< A newer message is delivered : the incomplete one before it is abandoned
+		mux.queue(std::vector<uint8_t>(Bousk::Network::UDP::Packet::DataMaxSize * 3, 0));
+		mux.queue(std::vector<uint8_t>{ 1, 2, 3 });
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize();
+		CHECK(packets.size() == 4);
+		for (size_t index : { 0, 3, 2 })
+			demux.onDataReceived(packets[index].buffer(), packets[index].size());
+		CHECK(demux.mNbPending == 3);
+		const std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == std::vector<uint8_t>{ 1, 2, 3 });
+		CHECK(demux.mNbPending == 0);
+		CHECK(demux.mLastProcessed == 11);
+		//!< Late fragment is too old now
+		demux.onDataReceived(packets[1].buffer(), packets[1].size());
+		CHECK(demux.mNbPending == 0);
+	}
+	{
+		//!< Packets newer than the window push an incomplete message out
+		mux.queue(std::vector<uint8_t>(Bousk::Network::UDP::Packet::DataMaxSize * 3, 0));
+		for (uint16_t i = 0; i < Bousk::Network::UDP::Protocols::UnreliableOrdered::Demultiplexer::WindowSize; ++i)
+			mux.queue(std::vector<uint8_t>{ static_cast<uint8_t>(i) });
+		const std::vector<Bousk::Network::UDP::Packet> packets = Serialize();
+		demux.onDataReceived(packets[0].buffer(), packets[0].size());
+		demux.onDataReceived(packets[packets.size() - 4].buffer(), packets[packets.size() - 4].size());
+		CHECK(demux.mNbPending == 2);
+		demux.onDataReceived(packets.back().buffer(), packets.back().size());
+		CHECK(demux.mNbPending == 2);
+		CHECK(!demux.mPendingQueue[packets[0].id() % Bousk::Network::UDP::Protocols::UnreliableOrdered::Demultiplexer::WindowSize].packet());
+		const std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 2);
+		CHECK(messages[0] == std::vector<uint8_t>{ static_cast<uint8_t>(Bousk::Network::UDP::Protocols::UnreliableOrdered::Demultiplexer::WindowSize - 4) });
+		CHECK(messages[1] == std::vector<uint8_t>{ static_cast<uint8_t>(Bousk::Network::UDP::Protocols::UnreliableOrdered::Demultiplexer::WindowSize - 1) });
+		CHECK(demux.mNbPending == 0);
+		CHECK(demux.mLastProcessed == packets.back().id());
+	}
 }
\ No newline at end of file
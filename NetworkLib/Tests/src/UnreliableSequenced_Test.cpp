@@ -0,0 +1,139 @@
+#include "UnreliableSequenced_Test.hpp"
+#include "Tester.hpp"
+
+#include <UDP/Protocols/UnreliableSequenced.hpp>
+
+#include <array>
+#include <vector>
+
+void UnreliableSequenced_Test::Test()
+{
+	using UnreliableSequenced = Bousk::Network::UDP::Protocols::UnreliableSequenced;
+	std::array<uint8_t, Bousk::Network::UDP::Packet::PacketMaxSize> buffer;
+	{
+		//!< States queued before being sent replace the previous one of their key
+		UnreliableSequenced::Multiplexer mux(sizeof(uint16_t));
+		mux.queue(std::vector<uint8_t>{ 1, 0, 10 });
+		mux.queue(std::vector<uint8_t>{ 2, 0, 20 });
+		mux.queue(std::vector<uint8_t>{ 1, 0, 11 });
+		mux.queue(std::vector<uint8_t>{ 1, 0, 12 });
+		CHECK(mux.mQueue.size() == 2);
+		const uint16_t serializedSize = mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+		CHECK(serializedSize == 2 * (Bousk::Network::UDP::Packet::HeaderSize + 3));
+		const Bousk::Network::UDP::Packet* first = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data());
+		CHECK(first->id() == 2);
+		CHECK(first->datasize() == 3 && first->data()[2] == 12);
+		const Bousk::Network::UDP::Packet* second = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data() + first->size());
+		CHECK(second->id() == 0);
+		CHECK(second->datasize() == 3 && second->data()[2] == 20);
+		CHECK(mux.mQueue.empty());
+		CHECK(mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 1) == 0);
+
+		//!< Once sent, a new state is queued again
+		mux.queue(std::vector<uint8_t>{ 1, 0, 13 });
+		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.mQueue[0].sequence == 3);
+	}
+	{
+		//!< Messages which don't fit in the datagram wait for the next one, still replaced by newer states
+		UnreliableSequenced::Multiplexer mux(1);
+		for (uint8_t key = 0; key < 4; ++key)
+			mux.queue(std::vector<uint8_t>{ key, 0 });
+		CHECK(mux.serialize(buffer.data(), 2 * (Bousk::Network::UDP::Packet::HeaderSize + 2), 0) == 2 * (Bousk::Network::UDP::Packet::HeaderSize + 2));
+		mux.queue(std::vector<uint8_t>{ 3, 1 });
+		mux.queue(std::vector<uint8_t>{ 0, 1 });
+		CHECK(mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 1) == 3 * (Bousk::Network::UDP::Packet::HeaderSize + 2));
+		const Bousk::Network::UDP::Packet* packet = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data());
+		CHECK(packet->data()[0] == 2 && packet->data()[1] == 0);
+		packet = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data() + packet->size());
+		CHECK(packet->data()[0] == 3 && packet->data()[1] == 1);
+		packet = reinterpret_cast<const Bousk::Network::UDP::Packet*>(buffer.data() + 2 * packet->size());
+		CHECK(packet->data()[0] == 0 && packet->data()[1] == 1);
+		CHECK(mux.mQueue.empty());
+
+		//!< Sent messages are removed once they're most of the queue
+		for (uint8_t key = 0; key < 3; ++key)
+			mux.queue(std::vector<uint8_t>{ key, 2 });
+		mux.serialize(buffer.data(), 2 * (Bousk::Network::UDP::Packet::HeaderSize + 2), 2);
+		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.mFirstQueued == 0);
+		mux.queue(std::vector<uint8_t>{ 2, 3 });
+		CHECK(mux.mQueue.size() == 1);
+		CHECK(mux.mQueue[0].data == std::vector<uint8_t>{ 2, 3 });
+	}
+	{
+		//!< States older than the last one delivered for their key are dropped
+		UnreliableSequenced::Multiplexer mux(sizeof(uint16_t));
+		UnreliableSequenced::Demultiplexer demux(sizeof(uint16_t));
+		std::vector<std::vector<uint8_t>> datagrams;
+		for (uint8_t i = 0; i < 3; ++i)
+		{
+			mux.queue(std::vector<uint8_t>{ 1, 0, i });
+			mux.queue(std::vector<uint8_t>{ 2, 0, i });
+			const uint16_t serializedSize = mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), i);
+			datagrams.emplace_back(buffer.data(), buffer.data() + serializedSize);
+		}
+		demux.onDataReceived(datagrams[1].data(), static_cast<uint16_t>(datagrams[1].size()));
+		CHECK(demux.process().size() == 2);
+		demux.onDataReceived(datagrams[0].data(), static_cast<uint16_t>(datagrams[0].size()));
+		CHECK(demux.process().empty());
+		demux.onDataReceived(datagrams[2].data(), static_cast<uint16_t>(datagrams[2].size()));
+		demux.onDataReceived(datagrams[2].data(), static_cast<uint16_t>(datagrams[2].size()));
+		const std::vector<Bousk::Network::Payload> messages = demux.process();
+		CHECK(messages.size() == 2);
+		CHECK(messages[0] == std::vector<uint8_t>{ 1, 0, 2 });
+		CHECK(messages[1] == std::vector<uint8_t>{ 2, 0, 2 });
+		CHECK(demux.mLastDelivered.size() == 2);
+	}
+	{
+		//!< Keys are sent by the other end : only the most recently updated ones are remembered
+		UnreliableSequenced::Multiplexer mux(UnreliableSequenced::MaxKeySize);
+		UnreliableSequenced::Demultiplexer demux(UnreliableSequenced::MaxKeySize, 4);
+		auto Send = [&](const uint8_t key, const uint8_t value)
+		{
+			std::vector<uint8_t> msg(UnreliableSequenced::MaxKeySize + 1, 0);
+			msg[0] = key;
+			msg.back() = value;
+			mux.queue(std::move(msg));
+			const uint16_t serializedSize = mux.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+			return std::vector<uint8_t>(buffer.data(), buffer.data() + serializedSize);
+		};
+		auto Deliver = [&](const std::vector<uint8_t>& datagram)
+		{
+			demux.onDataReceived(datagram.data(), static_cast<uint16_t>(datagram.size()));
+			return demux.process().size();
+		};
+		std::vector<std::vector<uint8_t>> firstStates;
+		for (uint8_t key = 0; key < 4; ++key)
+		{
+			firstStates.push_back(Send(key, 0));
+			CHECK(Deliver(firstStates.back()) == 1);
+		}
+		CHECK(Deliver(Send(0, 1)) == 1);
+		CHECK(Deliver(Send(4, 0)) == 1);
+		CHECK(demux.mLastDelivered.size() == 4);
+		CHECK(demux.mLastDelivered.count(1) == 0); //!< Least recently updated
+		CHECK(demux.mLastDelivered.count(0) == 1);
+		CHECK(Deliver(firstStates[0]) == 0);
+		for (uint8_t key = 5; key < 100; ++key)
+			CHECK(Deliver(Send(key, 0)) == 1);
+		CHECK(demux.mLastDelivered.size() == 4);
+		CHECK(demux.mKeysOrder.size() == 4);
+		CHECK(demux.mLastDelivered.count(99) == 1);
+		//!< A forgotten key doesn't know its last state anymore
+		CHECK(Deliver(firstStates[1]) == 1);
+	}
+	{
+		//!< Without key, the whole channel carries a single state
+		UnreliableSequenced sender(0);
+		UnreliableSequenced receiver(0);
+		sender.queue(std::vector<uint8_t>{ 1 });
+		sender.queue(std::vector<uint8_t>{ 2 });
+		const uint16_t serializedSize = sender.serialize(buffer.data(), static_cast<uint16_t>(buffer.size()), 0);
+		CHECK(serializedSize == Bousk::Network::UDP::Packet::HeaderSize + 1);
+		receiver.onDataReceived(buffer.data(), serializedSize, Bousk::BufferPool::Buffer());
+		const std::vector<Bousk::Network::Payload> messages = receiver.process();
+		CHECK(messages.size() == 1);
+		CHECK(messages[0] == std::vector<uint8_t>{ 2 });
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class UnreliableSequenced_Test
+{
+public:
+	static void Test();
+};
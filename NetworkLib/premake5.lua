@@ -80,4 +80,16 @@ else
 	CreateProject("Samples/UDP/Timeout")
 	CreateProject("Samples/UDP/ConnectionTimeout")
 	CreateProject("Samples/Games/TicTacToe")
+	CreateProject("Samples/Benchmarks/SegmentationOffload")
+	CreateProject("Samples/Benchmarks/PeerLookup")
+	CreateProject("Samples/Benchmarks/ShardedServer")
+	CreateProject("Samples/Benchmarks/OperationsQueue")
+	CreateProject("Samples/Benchmarks/ReceiveBuffers")
+	CreateProject("Samples/Benchmarks/ActivePeers")
+	CreateProject("Samples/Benchmarks/ReliableLatency")
+	CreateProject("Samples/Benchmarks/UnreliableReorder")
+	CreateProject("Samples/Benchmarks/Goodput")
+	CreateProject("Samples/Benchmarks/Compression")
+	CreateProject("Samples/Benchmarks/Replication")
+	CreateProject("Samples/Benchmarks/Serialization")
 end
\ No newline at end of file
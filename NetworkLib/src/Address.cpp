@@ -176,6 +176,29 @@ namespace Bousk
 			return memcmp(&reinterpret_cast<const sockaddr_in6&>(mStorage).sin6_addr, &reinterpret_cast<const sockaddr_in6&>(other.mStorage).sin6_addr, sizeof(IN6_ADDR)) == 0;
 		}
 
+		Address::Key Address::key() const
+		{
+			Key key;
+			key.type = mType;
+			if (mType == Type::None)
+				return key;
+			key.port = mPort;
+			if (mType == Type::IPv4)
+				memcpy(key.ip, &reinterpret_cast<const sockaddr_in&>(mStorage).sin_addr, sizeof(in_addr));
+			else
+				memcpy(key.ip, &reinterpret_cast<const sockaddr_in6&>(mStorage).sin6_addr, sizeof(IN6_ADDR));
+			return key;
+		}
+		size_t Address::Key::Hash::operator()(const Key& key) const
+		{
+			// Multiply-xorshift mixing : ip words and port are spread over the whole value so that neighbor addresses and ports don't collide
+			uint64 hash = (key.ip[0] ^ (static_cast<uint64>(key.port) << 48) ^ static_cast<uint64>(key.type)) * 0x9E3779B97F4A7C15ull;
+			hash ^= hash >> 32;
+			hash = (hash ^ key.ip[1]) * 0xC2B2AE3D27D4EB4Full;
+			hash ^= hash >> 29;
+			return static_cast<size_t>(hash);
+		}
+
 		bool Address::connect(SOCKET sckt) const
 		{
 			return ::connect(sckt, reinterpret_cast<const sockaddr*>(&mStorage), sizeof(mStorage)) == 0;
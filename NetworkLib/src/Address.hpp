@@ -17,6 +17,21 @@ namespace Bousk
 				IPv4,
 				IPv6,
 			};
+			// Compact and normalized identity of an address : only family, ip and port are kept so that it can be hashed and compared cheaply
+			struct Key
+			{
+				uint64 ip[2]{ 0, 0 }; //!< IPv4 only uses the first 4 bytes
+				uint16 port{ 0 };
+				Type type{ Type::None };
+
+				bool operator==(const Key& other) const { return ip[0] == other.ip[0] && ip[1] == other.ip[1] && port == other.port && type == other.type; }
+				bool operator!=(const Key& other) const { return !(*this == other); }
+
+				struct Hash
+				{
+					size_t operator()(const Key& key) const;
+				};
+			};
 		public:
 			Address() = default;
 			Address(const Address&) noexcept;
@@ -35,6 +50,8 @@ namespace Bousk
 			inline Type type() const { return mType; }
 			std::string address() const;
 			inline uint16 port() const { return mPort; }
+			inline const sockaddr_storage& storage() const { return mStorage; }
+			Key key() const;
 			// Return a formatted string <address>:<port>
 			std::string toString() const;
 
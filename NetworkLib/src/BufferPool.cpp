@@ -0,0 +1,96 @@
+#include "BufferPool.hpp"
+
+#include <cassert>
+
+namespace Bousk
+{
+	BufferPool::Buffer::Buffer(Block* block)
+		: mBlock(block)
+	{
+		mBlock->references.store(1, std::memory_order_relaxed);
+	}
+	BufferPool::Buffer::Buffer(const Buffer& other)
+		: mBlock(other.mBlock)
+	{
+		if (mBlock)
+			mBlock->references.fetch_add(1, std::memory_order_relaxed);
+	}
+	BufferPool::Buffer& BufferPool::Buffer::operator=(const Buffer& other)
+	{
+		if (other.mBlock)
+			other.mBlock->references.fetch_add(1, std::memory_order_relaxed);
+		reset();
+		mBlock = other.mBlock;
+		return *this;
+	}
+	BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			mBlock = other.mBlock;
+			other.mBlock = nullptr;
+		}
+		return *this;
+	}
+	uint8* BufferPool::Buffer::data() const
+	{
+		assert(mBlock);
+		return mBlock->data.get();
+	}
+	size_t BufferPool::Buffer::size() const
+	{
+		return mBlock ? mBlock->pool->bufferSize() : 0;
+	}
+	bool BufferPool::Buffer::unique() const
+	{
+		return mBlock && mBlock->references.load(std::memory_order_acquire) == 1;
+	}
+	void BufferPool::Buffer::reset()
+	{
+		if (!mBlock)
+			return;
+		Block* const block = mBlock;
+		mBlock = nullptr;
+		if (block->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			//!< The pool may be destroyed along with this reference, the block must not be used afterwards
+			std::shared_ptr<BufferPool> pool = std::move(block->pool);
+			pool->recycle(block);
+		}
+	}
+
+	std::shared_ptr<BufferPool> BufferPool::Create(const size_t bufferSize)
+	{
+		return std::shared_ptr<BufferPool>(new BufferPool(bufferSize));
+	}
+	BufferPool::BufferPool(const size_t bufferSize)
+		: mBufferSize(bufferSize)
+		, mRecycled(1024)
+	{}
+	BufferPool::~BufferPool() = default;
+
+	BufferPool::Buffer BufferPool::acquire()
+	{
+		if (mFree.empty())
+			mRecycled.consume([&](Block* block) { mFree.push_back(block); });
+		Block* block;
+		if (!mFree.empty())
+		{
+			block = mFree.back();
+			mFree.pop_back();
+		}
+		else
+		{
+			mBlocks.push_back(std::make_unique<Block>());
+			block = mBlocks.back().get();
+			block->data = std::make_unique<uint8[]>(mBufferSize);
+		}
+		block->pool = shared_from_this();
+		return Buffer(block);
+	}
+	void BufferPool::recycle(Block* block)
+	{
+		mRecycled.push([&](Block*& slot) { slot = block; });
+	}
+}
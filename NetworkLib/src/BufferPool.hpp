@@ -0,0 +1,78 @@
+#pragma once
+
+#include "MPSCQueue.hpp"
+#include "Types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Bousk
+{
+	/*
+	Pool of fixed size buffers, shared by reference counting.
+	The owner thread acquires buffers, any thread can hold and release them : once the last holder releases a buffer, it goes back to its pool.
+	Buffers keep their pool alive, so they can outlive the object which created it.
+	*/
+	class BufferPool : public std::enable_shared_from_this<BufferPool>
+	{
+		struct Block
+		{
+			std::atomic<uint32> references{ 0 };
+			std::shared_ptr<BufferPool> pool; //!< Only set while the buffer is out of the pool
+			std::unique_ptr<uint8[]> data;
+		};
+	public:
+		class Buffer
+		{
+			friend class BufferPool;
+		public:
+			Buffer() = default;
+			Buffer(const Buffer& other);
+			Buffer(Buffer&& other) noexcept : mBlock(other.mBlock) { other.mBlock = nullptr; }
+			Buffer& operator=(const Buffer& other);
+			Buffer& operator=(Buffer&& other) noexcept;
+			~Buffer() { reset(); }
+
+			uint8* data() const;
+			// Access the buffer as an object of a trivial type, which must fit in it
+			template<class T>
+			T& as() const { return *reinterpret_cast<T*>(data()); }
+			size_t size() const;
+			// Whether this handle is the only holder of its buffer, so that its content can be overwritten
+			bool unique() const;
+			explicit operator bool() const { return mBlock != nullptr; }
+			void reset();
+
+		private:
+			explicit Buffer(Block* block);
+
+		private:
+			Block* mBlock{ nullptr };
+		};
+
+	public:
+		static std::shared_ptr<BufferPool> Create(size_t bufferSize);
+		BufferPool(const BufferPool&) = delete;
+		BufferPool& operator=(const BufferPool&) = delete;
+		~BufferPool();
+
+		// Owner thread only
+		Buffer acquire();
+
+		size_t bufferSize() const { return mBufferSize; }
+		// Number of buffers allocated so far
+		size_t nbBuffers() const { return mBlocks.size(); }
+
+	private:
+		explicit BufferPool(size_t bufferSize);
+		//!< Any thread
+		void recycle(Block* block);
+
+	private:
+		const size_t mBufferSize;
+		std::vector<std::unique_ptr<Block>> mBlocks; //!< Owner thread only
+		std::vector<Block*> mFree; //!< Owner thread only
+		MPSCQueue<Block*> mRecycled; //!< Released by any thread, taken back by the owner once mFree is empty
+	};
+}
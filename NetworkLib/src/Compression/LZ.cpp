@@ -0,0 +1,274 @@
+#include <Compression/LZ.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Bousk
+{
+	namespace Compression
+	{
+		namespace
+		{
+			constexpr uint8 TokenLengthMax = 15;
+
+			//!< Positions of the sequences hashed by the thread, valid above the generation of the data being compressed : no reset between calls
+			struct HashTable
+			{
+				std::array<uint32, 1 << 12> positions{};
+				uint32 generation{ 0 };
+			};
+			HashTable& ThreadHashTable()
+			{
+				thread_local HashTable table;
+				return table;
+			}
+
+			uint32 Read32(const uint8* data)
+			{
+				uint32 value;
+				memcpy(&value, data, sizeof(value));
+				return value;
+			}
+			//!< Length of the match between a and b, at most maxLength
+			size_t MatchLength(const uint8* a, const uint8* b, const size_t maxLength)
+			{
+				size_t length = 0;
+				while (length + sizeof(uint64) <= maxLength)
+				{
+					uint64 va, vb;
+					memcpy(&va, a + length, sizeof(va));
+					memcpy(&vb, b + length, sizeof(vb));
+					if (va != vb)
+						break;
+					length += sizeof(uint64);
+				}
+				while (length < maxLength && a[length] == b[length])
+					++length;
+				return length;
+			}
+
+			class Writer
+			{
+			public:
+				Writer(uint8* dst, size_t capacity) : mDst(dst), mCapacity(capacity) {}
+
+				bool write(uint8 byte)
+				{
+					if (mSize >= mCapacity)
+						return false;
+					mDst[mSize++] = byte;
+					return true;
+				}
+				bool write(const uint8* data, size_t size)
+				{
+					if (size > mCapacity - mSize)
+						return false;
+					if (size == 0)
+						return true;
+					memcpy(mDst + mSize, data, size);
+					mSize += size;
+					return true;
+				}
+				//!< Extra bytes of a length which doesn't fit in its token
+				bool writeLength(size_t length)
+				{
+					for (; length >= 255; length -= 255)
+					{
+						if (!write(255))
+							return false;
+					}
+					return write(static_cast<uint8>(length));
+				}
+				bool writeSequence(const uint8* literals, size_t nbLiterals, size_t distance, size_t matchLength)
+				{
+					const bool hasMatch = (matchLength != 0);
+					const size_t matchToken = hasMatch ? matchLength - 4 : 0;
+					const uint8 token = static_cast<uint8>((std::min<size_t>(nbLiterals, TokenLengthMax) << 4) | std::min<size_t>(matchToken, TokenLengthMax));
+					if (!write(token)
+						|| (nbLiterals >= TokenLengthMax && !writeLength(nbLiterals - TokenLengthMax))
+						|| !write(literals, nbLiterals))
+					{
+						return false;
+					}
+					if (!hasMatch)
+						return true;
+					return write(static_cast<uint8>(distance & 0xFF)) && write(static_cast<uint8>(distance >> 8))
+						&& (matchToken < TokenLengthMax || writeLength(matchToken - TokenLengthMax));
+				}
+				size_t size() const { return mSize; }
+
+			private:
+				uint8* mDst;
+				size_t mCapacity;
+				size_t mSize{ 0 };
+			};
+
+			//!< Extra bytes of a length, false if src ends before
+			bool ReadLength(const uint8* src, const size_t srcSize, size_t& offset, size_t& length)
+			{
+				for (;;)
+				{
+					if (offset >= srcSize)
+						return false;
+					const uint8 byte = src[offset++];
+					length += byte;
+					if (byte != 255)
+						return true;
+				}
+			}
+		}
+
+		Dictionary::Dictionary(std::vector<uint8>&& data)
+			: mData(std::move(data))
+			, mPositions(size_t(1) << LZ::HashBits, 0)
+		{
+			if (mData.size() > MaxSize)
+				mData.erase(mData.begin(), mData.end() - MaxSize);
+			for (size_t pos = 0; pos + LZ::MinMatch <= mData.size(); ++pos)
+				mPositions[LZ::Hash(mData.data() + pos)] = static_cast<uint16>(pos + 1);
+		}
+
+		uint32 LZ::Hash(const uint8* data)
+		{
+			return (Read32(data) * 2654435761u) >> (32 - HashBits);
+		}
+
+		size_t LZ::Compress(const uint8* const src, const size_t srcSize, uint8* const dst, const size_t dstCapacity, const Dictionary* const dictionary)
+		{
+			static_assert(sizeof(HashTable::positions) / sizeof(uint32) == (size_t(1) << HashBits), "Hash table doesn't match the hash");
+			HashTable& table = ThreadHashTable();
+			if (srcSize >= std::numeric_limits<uint32>::max() - table.generation)
+			{
+				table.positions.fill(0);
+				table.generation = 0;
+			}
+			//!< Entries at or below the generation belong to previous calls
+			const uint32 generation = table.generation;
+			table.generation += static_cast<uint32>(srcSize) + 1;
+
+			const uint8* const dictData = dictionary ? dictionary->data() : nullptr;
+			const size_t dictSize = dictionary ? dictionary->size() : 0;
+
+			Writer writer(dst, dstCapacity);
+			size_t anchor = 0;
+			size_t pos = 0;
+			size_t misses = 0;
+			while (pos + MinMatch <= srcSize)
+			{
+				const uint32 hash = Hash(src + pos);
+				const uint32 sequence = Read32(src + pos);
+				size_t bestLength = 0;
+				size_t bestDistance = 0;
+
+				const uint32 entry = table.positions[hash];
+				table.positions[hash] = generation + static_cast<uint32>(pos) + 1;
+				if (entry > generation)
+				{
+					const size_t candidate = entry - generation - 1;
+					if (pos - candidate <= MaxDistance && Read32(src + candidate) == sequence)
+					{
+						bestLength = MinMatch + MatchLength(src + candidate + MinMatch, src + pos + MinMatch, srcSize - pos - MinMatch);
+						bestDistance = pos - candidate;
+					}
+				}
+				if (dictionary && dictionary->mPositions[hash] != 0)
+				{
+					const size_t candidate = dictionary->mPositions[hash] - 1;
+					const size_t distance = dictSize - candidate + pos;
+					if (distance <= MaxDistance && Read32(dictData + candidate) == sequence)
+					{
+						//!< A match reaching the end of the dictionary goes on with the data
+						size_t length = MinMatch + MatchLength(dictData + candidate + MinMatch, src + pos + MinMatch, std::min(dictSize - candidate, srcSize - pos) - MinMatch);
+						if (candidate + length == dictSize)
+							length += MatchLength(src, src + pos + length, srcSize - pos - length);
+						if (length > bestLength)
+						{
+							bestLength = length;
+							bestDistance = distance;
+						}
+					}
+				}
+
+				if (bestLength == 0)
+				{
+					//!< Skip faster through data which doesn't compress
+					pos += 1 + (misses++ >> 5);
+					continue;
+				}
+				misses = 0;
+				if (!writer.writeSequence(src + anchor, pos - anchor, bestDistance, bestLength))
+					return 0;
+				pos += bestLength;
+				anchor = pos;
+				if (pos >= 2 && pos - 2 + MinMatch <= srcSize)
+					table.positions[Hash(src + pos - 2)] = generation + static_cast<uint32>(pos - 2) + 1;
+			}
+			if (!writer.writeSequence(src + anchor, srcSize - anchor, 0, 0))
+				return 0;
+			return writer.size();
+		}
+
+		bool LZ::Decompress(const uint8* const src, const size_t srcSize, uint8* const dst, const size_t dstCapacity, size_t& dstSize, const Dictionary* const dictionary)
+		{
+			const uint8* const dictData = dictionary ? dictionary->data() : nullptr;
+			const size_t dictSize = dictionary ? dictionary->size() : 0;
+
+			size_t offset = 0;
+			size_t written = 0;
+			while (offset < srcSize)
+			{
+				const uint8 token = src[offset++];
+				size_t nbLiterals = token >> 4;
+				if (nbLiterals == TokenLengthMax && !ReadLength(src, srcSize, offset, nbLiterals))
+					return false;
+				if (nbLiterals > srcSize - offset || nbLiterals > dstCapacity - written)
+					return false;
+				if (nbLiterals != 0)
+					memcpy(dst + written, src + offset, nbLiterals);
+				offset += nbLiterals;
+				written += nbLiterals;
+				if (offset == srcSize)
+					break; //!< Last sequence
+
+				if (srcSize - offset < 2)
+					return false;
+				const size_t distance = src[offset] | (src[offset + 1] << 8);
+				offset += 2;
+				size_t matchLength = token & TokenLengthMax;
+				if (matchLength == TokenLengthMax && !ReadLength(src, srcSize, offset, matchLength))
+					return false;
+				matchLength += MinMatch;
+				if (distance == 0 || distance > written + dictSize || matchLength > dstCapacity - written)
+					return false;
+
+				if (distance > written)
+				{
+					//!< Starts in the dictionary, may go on with the data
+					const size_t dictOffset = dictSize - (distance - written);
+					const size_t fromDict = std::min(matchLength, dictSize - dictOffset);
+					memcpy(dst + written, dictData + dictOffset, fromDict);
+					written += fromDict;
+					matchLength -= fromDict;
+					if (matchLength == 0)
+						continue;
+				}
+				uint8* out = dst + written;
+				const uint8* match = out - distance;
+				if (distance >= matchLength)
+				{
+					memcpy(out, match, matchLength);
+				}
+				else
+				{
+					//!< Overlapping copy repeats the last distance bytes
+					for (size_t i = 0; i < matchLength; ++i)
+						out[i] = match[i];
+				}
+				written += matchLength;
+			}
+			dstSize = written;
+			return true;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Types.hpp>
+
+#include <cstddef>
+#include <vector>
+
+class Compression_Test;
+namespace Bousk
+{
+	namespace Compression
+	{
+		/*
+		Bytes both ends know beforehand, such as samples of the messages exchanged : the first ones compressed can refer to it.
+		Only its last MaxSize bytes are kept, matches don't reach further.
+		*/
+		class Dictionary
+		{
+			friend class LZ;
+		public:
+			static constexpr size_t MaxSize = 32 * 1024;
+
+		public:
+			explicit Dictionary(std::vector<uint8>&& data);
+
+			const uint8* data() const { return mData.data(); }
+			size_t size() const { return mData.size(); }
+
+		private:
+			std::vector<uint8> mData;
+			std::vector<uint16> mPositions; //!< Position + 1 of the last sequence with each hash, 0 if none
+		};
+
+		/*
+		LZ77 family compressor : the data is a sequence of literals, each followed by a match copying bytes already decompressed, or from the dictionary.
+		Each sequence is a token holding both lengths on 4 bits, the literals, then the distance of the match on 2 bytes.
+		Lengths of 15 and more continue in extra bytes. The last sequence has literals only.
+		*/
+		class LZ
+		{
+			friend class Dictionary;
+			friend class ::Compression_Test;
+		public:
+			// Largest size data of size bytes can be compressed to
+			static constexpr size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+			// Returns the size compressed to dst, 0 if it doesn't fit in dstCapacity
+			static size_t Compress(const uint8* src, size_t srcSize, uint8* dst, size_t dstCapacity, const Dictionary* dictionary = nullptr);
+			// Returns false if src is malformed or doesn't fit in dstCapacity once decompressed
+			static bool Decompress(const uint8* src, size_t srcSize, uint8* dst, size_t dstCapacity, size_t& dstSize, const Dictionary* dictionary = nullptr);
+
+		private:
+			static constexpr uint8 MinMatch = 4;
+			static constexpr uint8 HashBits = 12;
+			static constexpr size_t MaxDistance = std::numeric_limits<uint16>::max();
+
+			static uint32 Hash(const uint8* data);
+		};
+	}
+}
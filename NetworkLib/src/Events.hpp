@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Messages.hpp"
+#include "Payload.hpp"
+
+#include <cassert>
+#include <memory>
+#include <variant>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace Messages
+		{
+			// Content of an event, as held by message M
+			template<class M>
+			struct EventData;
+			template<>
+			struct EventData<IncomingConnection> {};
+			template<>
+			struct EventData<Connection> { Connection::Result result; };
+			template<>
+			struct EventData<Disconnection> { Disconnection::Reason reason; };
+			template<>
+			struct EventData<UserData> { Payload data; };
+
+			/*
+			Compact counterpart of messages, stored by value : no allocation per event.
+			The emitter is identified by its id, its address can be looked up on demand from the client which emitted the event.
+			Use is<M>() and as<M>() with message types, as for messages.
+			*/
+			class Event
+			{
+			public:
+				Event() = default;
+				template<class M>
+				Event(uint64 emitterId, EventData<M>&& data)
+					: mEmitterId(emitterId)
+					, mData(std::move(data))
+				{}
+
+				template<class M>
+				bool is() const { return std::holds_alternative<EventData<M>>(mData); }
+				template<class M>
+				const EventData<M>* as() const { assert(is<M>()); return std::get_if<EventData<M>>(&mData); }
+
+				uint64 emitterId() const { return mEmitterId; }
+
+				// Convert to a heap allocated message. Moves the event data out
+				std::unique_ptr<Base> toMessage(const Address& emitter);
+
+			private:
+				uint64 mEmitterId{ 0 };
+				std::variant<EventData<IncomingConnection>, EventData<Connection>, EventData<Disconnection>, EventData<UserData>> mData;
+			};
+
+			inline std::unique_ptr<Base> Event::toMessage(const Address& emitter)
+			{
+				if (is<Connection>())
+					return std::make_unique<Connection>(emitter, mEmitterId, as<Connection>()->result);
+				if (is<Disconnection>())
+					return std::make_unique<Disconnection>(emitter, mEmitterId, as<Disconnection>()->reason);
+				if (is<UserData>())
+					return std::make_unique<UserData>(emitter, mEmitterId, std::move(std::get<EventData<UserData>>(mData).data));
+				return std::make_unique<IncomingConnection>(emitter, mEmitterId);
+			}
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#include "EventsQueue.hpp"
+
+namespace Bousk
+{
+	namespace Network
+	{
+		void EventsQueue::addEmitter(const uint64 emitterId, const Address& address)
+		{
+			EmittersLock lock(mEmittersLock);
+			mEmitters[emitterId] = Emitter{ address, false, 0 };
+		}
+		void EventsQueue::removeEmitter(const uint64 emitterId)
+		{
+			EmittersLock lock(mEmittersLock);
+			auto itEmitter = mEmitters.find(emitterId);
+			if (itEmitter == mEmitters.end())
+				return;
+			//!< Its last events may not be polled yet : keep its address until the application had a chance to use it
+			itEmitter->second.removed = true;
+			itEmitter->second.removedAtPoll = mNbPolls;
+			mRemovedEmitters.push_back(emitterId);
+		}
+
+		size_t EventsQueue::pollEvents(std::vector<Messages::Event>& events)
+		{
+			PollLock lock(mPollLock);
+			onPoll();
+			return mEvents.consume([&](Messages::Event& event) { events.push_back(std::move(event)); });
+		}
+		Address EventsQueue::address(const uint64 emitterId) const
+		{
+			EmittersLock lock(mEmittersLock);
+			auto itEmitter = mEmitters.find(emitterId);
+			return itEmitter != mEmitters.end() ? itEmitter->second.address : Address();
+		}
+
+		std::vector<std::unique_ptr<Messages::Base>> EventsQueue::poll()
+		{
+			std::vector<std::unique_ptr<Messages::Base>> messages;
+			poll(messages);
+			return messages;
+		}
+		void EventsQueue::poll(std::vector<std::unique_ptr<Messages::Base>>& messages)
+		{
+			poll([&](std::unique_ptr<Messages::Base>&& msg) { messages.push_back(std::move(msg)); });
+		}
+		void EventsQueue::clear()
+		{
+			PollLock lock(mPollLock);
+			onPoll();
+			mEvents.consume([](Messages::Event& event) { event = Messages::Event(); });
+		}
+
+		void EventsQueue::onPoll()
+		{
+			EmittersLock lock(mEmittersLock);
+			++mNbPolls;
+			//!< Events pushed before the removal are returned by the poll in progress during the removal, or the next one at last
+			auto itRemoved = mRemovedEmitters.begin();
+			while (itRemoved != mRemovedEmitters.end())
+			{
+				auto itEmitter = mEmitters.find(*itRemoved);
+				if (itEmitter == mEmitters.end() || !itEmitter->second.removed)
+				{
+					//!< Emitter id reused meanwhile, or already forgotten
+					itRemoved = mRemovedEmitters.erase(itRemoved);
+				}
+				else if (itEmitter->second.removedAtPoll + 2 <= mNbPolls)
+				{
+					mEmitters.erase(itEmitter);
+					itRemoved = mRemovedEmitters.erase(itRemoved);
+				}
+				else
+				{
+					++itRemoved;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Address.hpp"
+#include "Events.hpp"
+#include "MPSCQueue.hpp"
+#include "Settings.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		/*
+		Events ready to be handled by the application, along with the address of each emitter.
+		The network thread pushes them without any lock nor allocation into a ring of reusable slots.
+		Applications poll events into their own contiguous storage, cleared and refilled each frame, then look up emitter addresses on demand.
+		Events can also be polled as heap allocated messages, which carry their emitter address.
+
+		Address of a removed emitter remains available until the poll following the one which returned its last event.
+		Polling can be done from any thread, each event is polled only once.
+		*/
+		class EventsQueue
+		{
+		public:
+			EventsQueue() = default;
+			EventsQueue(const EventsQueue&) = delete;
+			EventsQueue& operator=(const EventsQueue&) = delete;
+			~EventsQueue() = default;
+
+			// Network thread only
+			void push(Messages::Event&& event) { mEvents.push([&](Messages::Event& slot) { slot = std::move(event); }); }
+			// Network thread only, emitter must be added before its first event is pushed
+			void addEmitter(uint64 emitterId, const Address& address);
+			void removeEmitter(uint64 emitterId);
+
+			// Append ready events to the given vector
+			// Returns the number of events polled
+			size_t pollEvents(std::vector<Messages::Event>& events);
+			// Call callback(Messages::Event&&) with each ready event. The callback must not poll the same queue
+			// Returns the number of events polled
+			template<class Callback>
+			size_t pollEvents(Callback&& callback);
+			// Address of an emitter, invalid if it's unknown
+			Address address(uint64 emitterId) const;
+
+			std::vector<std::unique_ptr<Messages::Base>> poll();
+			// Append ready events, converted to messages, to the given vector
+			void poll(std::vector<std::unique_ptr<Messages::Base>>& messages);
+			// Call callback(std::unique_ptr<Messages::Base>&&) with each ready event converted to a message. The callback must not poll the same queue
+			// Returns the number of messages polled
+			template<class Callback>
+			size_t poll(Callback&& callback);
+			void clear();
+
+		private:
+			//!< Forget removed emitters whose last event has been polled long enough
+			void onPoll();
+
+		private:
+			MPSCQueue<Messages::Event> mEvents{ BOUSKNET_MESSAGES_QUEUE_SIZE };
+			std::mutex mPollLock; //!< The ring has a single consumer : polling threads take turns
+			using PollLock = std::lock_guard<std::mutex>;
+
+			struct Emitter
+			{
+				Address address;
+				bool removed{ false };
+				uint64 removedAtPoll{ 0 };
+			};
+			mutable std::mutex mEmittersLock;
+			using EmittersLock = std::lock_guard<std::mutex>;
+			std::unordered_map<uint64, Emitter> mEmitters;
+			std::vector<uint64> mRemovedEmitters;
+			uint64 mNbPolls{ 0 }; //!< Protected by mEmittersLock
+		};
+
+		template<class Callback>
+		size_t EventsQueue::pollEvents(Callback&& callback)
+		{
+			PollLock lock(mPollLock);
+			onPoll();
+			return mEvents.consume([&](Messages::Event& event)
+			{
+				callback(std::move(event));
+				event = Messages::Event(); //!< Don't keep a payload alive in its slot if the callback didn't take it
+			});
+		}
+		template<class Callback>
+		size_t EventsQueue::poll(Callback&& callback)
+		{
+			PollLock lock(mPollLock);
+			onPoll();
+			return mEvents.consume([&](Messages::Event& event)
+			{
+				callback(event.toMessage(address(event.emitterId())));
+				event = Messages::Event(); //!< Don't keep a payload alive in its slot
+			});
+		}
+	}
+}
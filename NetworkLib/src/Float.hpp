@@ -25,6 +25,9 @@ namespace Bousk
 		static constexpr uint8 Step = STEP;
 		static constexpr uint32 Domain = (MAX - MIN) * Multiple / STEP;
 
+	public:
+		using Quantized = RangedInteger<0, Domain>;
+
 	public:
 		Float() = default;
 		Float(FloatType value)
@@ -40,12 +43,15 @@ namespace Bousk
 
 		inline FloatType get() const { return static_cast<FloatType>((mQuantizedValue.get() * Step * 1.) / Multiple + Min); }
 		inline operator FloatType() const { return get(); }
+		// Value as it's serialized
+		inline const Quantized& quantized() const { return mQuantizedValue; }
+		inline Quantized& quantized() { return mQuantizedValue; }
 
 		bool write(Serialization::Serializer& serializer) const override { return mQuantizedValue.write(serializer); }
 		bool read(Serialization::Deserializer& deserializer) override { return mQuantizedValue.read(deserializer); }
 
 	private:
-		RangedInteger<0, Domain> mQuantizedValue;
+		Quantized mQuantizedValue;
 	};
 
 	template<int32 MIN, int32 MAX, uint8 NBDECIMALS, uint8 STEP = 1>
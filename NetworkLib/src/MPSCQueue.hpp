@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace Bousk
+{
+	/*
+	Bounded multi-producer single-consumer queue of preallocated slots.
+	Producers fill a slot in place then publish it, without any lock : each slot has its own sequence number (Vyukov's bounded queue).
+	The consumer reads slots in place then releases them for reuse.
+
+	When the ring is full, producers fall back to a locked overflow queue instead of blocking, since the consumer may be the producing thread.
+	Order of items pushed by a given producer is always preserved : while some items overflow, every producer uses the overflow queue,
+	until the consumer takes them. They are consumed once every ring item pushed before them is, even if it was not published yet.
+	*/
+	template<class T>
+	class MPSCQueue
+	{
+	public:
+		// Capacity is rounded up to a power of 2
+		explicit MPSCQueue(size_t capacity);
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+		~MPSCQueue() = default;
+
+		// Fill a slot in place with fill(T&). Slots are reused so fill must set every member of the item. Can be called anytime from any thread
+		template<class Fill>
+		void push(Fill&& fill);
+		// Extract all items pushed so far, by calling consumer(T&) on each of them. Single consumer only
+		// Returns the number of items consumed
+		template<class Consume>
+		size_t consume(Consume&& consumer);
+		// Whether there is no item to consume. Single consumer only
+		bool empty() const;
+
+		size_t capacity() const { return mSlots.size(); }
+		// Number of items which couldn't fit in the ring
+		size_t nbOverflows() const { return mNbOverflows.load(std::memory_order_relaxed); }
+
+	private:
+		struct Slot
+		{
+			std::atomic<size_t> sequence; //!< == position when free to be filled, == position + 1 when ready to be consumed
+			T item;
+		};
+		//!< Returns false if the ring is full
+		template<class Fill>
+		bool tryPush(Fill& fill);
+
+	private:
+		std::vector<Slot> mSlots;
+		size_t mMask;
+		alignas(64) std::atomic<size_t> mEnqueuePosition{ 0 };
+		alignas(64) size_t mDequeuePosition{ 0 }; //!< Consumer only
+
+		std::mutex mOverflowLock;
+		using OverflowLock = std::lock_guard<std::mutex>;
+		std::vector<T> mOverflow;
+		std::vector<T> mOverflowConsumed; //!< Consumer only, swapped with mOverflow to keep their capacity
+		size_t mOverflowConsumedPosition{ 0 }; //!< Consumer only, mOverflowConsumed items come after ring items up to this position
+		std::atomic<bool> mOverflowing{ false };
+		std::atomic<size_t> mNbOverflows{ 0 };
+	};
+
+	template<class T>
+	MPSCQueue<T>::MPSCQueue(const size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size *= 2;
+		mSlots = std::vector<Slot>(size);
+		mMask = size - 1;
+		for (size_t i = 0; i < size; ++i)
+			mSlots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	template<class T>
+	template<class Fill>
+	void MPSCQueue<T>::push(Fill&& fill)
+	{
+		if (!mOverflowing.load(std::memory_order_seq_cst) && tryPush(fill))
+			return;
+		OverflowLock lock(mOverflowLock);
+		mOverflowing.store(true, std::memory_order_seq_cst);
+		mOverflow.emplace_back();
+		fill(mOverflow.back());
+		mNbOverflows.fetch_add(1, std::memory_order_relaxed);
+	}
+	template<class T>
+	template<class Fill>
+	bool MPSCQueue<T>::tryPush(Fill& fill)
+	{
+		size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Slot& slot = mSlots[position & mMask];
+			const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+			if (diff == 0)
+			{
+				if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					fill(slot.item);
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+				//!< Another producer took this position : position has been updated by compare_exchange
+			}
+			else if (diff < 0)
+			{
+				//!< The consumer didn't release this slot yet
+				return false;
+			}
+			else
+			{
+				position = mEnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	template<class T>
+	template<class Consume>
+	size_t MPSCQueue<T>::consume(Consume&& consumer)
+	{
+		size_t lastPosition = mDequeuePosition + mSlots.size(); //!< Items published meanwhile may be consumed too, but stop after a full ring to not starve the caller
+		//!< Overflowing items taken by a previous call are still waiting for ring items pushed before them : don't take the next ones yet
+		if (mOverflowConsumed.empty() && mOverflowing.load(std::memory_order_seq_cst))
+		{
+			OverflowLock lock(mOverflowLock);
+			mOverflowConsumed.swap(mOverflow);
+			//!< Producers go back to the ring from now on : their next items must be consumed after the overflowing ones
+			mOverflowConsumedPosition = mEnqueuePosition.load(std::memory_order_seq_cst);
+			mOverflowing.store(false, std::memory_order_seq_cst);
+		}
+		if (!mOverflowConsumed.empty())
+			lastPosition = std::min(lastPosition, mOverflowConsumedPosition);
+		size_t count = 0;
+		for (; mDequeuePosition < lastPosition; ++count)
+		{
+			Slot& slot = mSlots[mDequeuePosition & mMask];
+			if (slot.sequence.load(std::memory_order_acquire) != mDequeuePosition + 1)
+				break;
+			consumer(slot.item);
+			slot.sequence.store(mDequeuePosition + mSlots.size(), std::memory_order_release);
+			++mDequeuePosition;
+		}
+		//!< A producer may have claimed a ring position before them but not published it yet
+		if (!mOverflowConsumed.empty() && mDequeuePosition == mOverflowConsumedPosition)
+		{
+			for (T& item : mOverflowConsumed)
+				consumer(item);
+			count += mOverflowConsumed.size();
+			mOverflowConsumed.clear();
+		}
+		return count;
+	}
+	template<class T>
+	bool MPSCQueue<T>::empty() const
+	{
+		return mSlots[mDequeuePosition & mMask].sequence.load(std::memory_order_acquire) != mDequeuePosition + 1
+			&& mOverflowConsumed.empty() && !mOverflowing.load(std::memory_order_acquire);
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Address.hpp"
+#include "Payload.hpp"
 
 #include <cassert>
 #include <numeric>
@@ -15,6 +16,8 @@ namespace Bousk
 			class Base
 			{
 			public:
+				virtual ~Base() = default;
+
 				template<class M>
 				bool is() const { return mType == M::StaticType; }
 				template<class M>
@@ -82,11 +85,11 @@ namespace Bousk
 			{
 				DECLARE_MESSAGE(UserData);
 			public:
-				UserData(const Address& emitter, uint64 emitterid, std::vector<unsigned char>&& d)
+				UserData(const Address& emitter, uint64 emitterid, Payload&& d)
 					: Base(Type::UserData, emitter, emitterid)
 					, data(std::move(d))
 				{}
-				std::vector<unsigned char> data;
+				Payload data;
 			};
 			#undef DECLARE_MESSAGE
 		}
@@ -0,0 +1,24 @@
+#include "MessagesQueue.hpp"
+
+namespace Bousk
+{
+	namespace Network
+	{
+		std::vector<std::unique_ptr<Messages::Base>> MessagesQueue::poll()
+		{
+			std::vector<std::unique_ptr<Messages::Base>> messages;
+			poll(messages);
+			return messages;
+		}
+		void MessagesQueue::poll(std::vector<std::unique_ptr<Messages::Base>>& messages)
+		{
+			PollLock lock(mPollLock);
+			mMessages.consume([&](std::unique_ptr<Messages::Base>& msg) { messages.push_back(std::move(msg)); });
+		}
+		void MessagesQueue::clear()
+		{
+			PollLock lock(mPollLock);
+			mMessages.consume([](std::unique_ptr<Messages::Base>& msg) { msg.reset(); });
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Messages.hpp"
+#include "MPSCQueue.hpp"
+#include "Settings.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		/*
+		Messages ready to be handled by the application.
+		The network thread pushes them without any lock into a ring of reusable slots.
+		Applications poll them into their own storage : a vector which keeps its capacity from frame to frame, or a callback.
+		Polling can be done from any thread, each message is polled only once.
+		*/
+		class MessagesQueue
+		{
+		public:
+			MessagesQueue() = default;
+			MessagesQueue(const MessagesQueue&) = delete;
+			MessagesQueue& operator=(const MessagesQueue&) = delete;
+			~MessagesQueue() = default;
+
+			// Network thread only
+			void push(std::unique_ptr<Messages::Base>&& msg) { mMessages.push([&](std::unique_ptr<Messages::Base>& slot) { slot = std::move(msg); }); }
+
+			std::vector<std::unique_ptr<Messages::Base>> poll();
+			// Append ready messages to the given vector
+			void poll(std::vector<std::unique_ptr<Messages::Base>>& messages);
+			// Call callback(std::unique_ptr<Messages::Base>&&) with each ready message. The callback must not poll the same queue
+			// Returns the number of messages polled
+			template<class Callback>
+			size_t poll(Callback&& callback);
+			void clear();
+
+		private:
+			MPSCQueue<std::unique_ptr<Messages::Base>> mMessages{ BOUSKNET_MESSAGES_QUEUE_SIZE };
+			std::mutex mPollLock; //!< The ring has a single consumer : polling threads take turns
+			using PollLock = std::lock_guard<std::mutex>;
+		};
+
+		template<class Callback>
+		size_t MessagesQueue::poll(Callback&& callback)
+		{
+			PollLock lock(mPollLock);
+			return mMessages.consume([&](std::unique_ptr<Messages::Base>& msg)
+			{
+				callback(std::move(msg));
+				msg.reset(); //!< Don't keep the message alive in its slot if the callback didn't take it
+			});
+		}
+	}
+}
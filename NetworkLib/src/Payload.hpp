@@ -0,0 +1,69 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include "Types.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		/*
+		Read only bytes of a received message.
+		Either a view into the pooled buffer the message has been received in, which stays alive as long as the payload does,
+		or its own copy when the message had to be reassembled or doesn't come from a pooled buffer.
+		*/
+		class Payload
+		{
+		public:
+			Payload() = default;
+			Payload(std::vector<uint8>&& data) : mOwned(std::move(data)) {}
+			// View into buffer if any, copy of the data otherwise
+			Payload(const uint8* data, size_t size, const BufferPool::Buffer& buffer)
+			{
+				if (buffer)
+				{
+					mBuffer = buffer;
+					mView = data;
+					mViewSize = size;
+				}
+				else
+				{
+					mOwned.assign(data, data + size);
+				}
+			}
+
+			const uint8* data() const { return mBuffer ? mView : mOwned.data(); }
+			size_t size() const { return mBuffer ? mViewSize : mOwned.size(); }
+			bool empty() const { return size() == 0; }
+			const uint8* begin() const { return data(); }
+			const uint8* end() const { return data() + size(); }
+			const uint8& operator[](size_t index) const { return data()[index]; }
+
+			// Whether the payload references a pooled buffer instead of owning its data
+			bool isView() const { return static_cast<bool>(mBuffer); }
+			std::vector<uint8> toVector() const { return std::vector<uint8>(begin(), end()); }
+			// Drop the bytes after the first size ones
+			void truncate(size_t size)
+			{
+				assert(size <= this->size());
+				if (mBuffer)
+					mViewSize = size;
+				else
+					mOwned.resize(size);
+			}
+
+			bool operator==(const std::vector<uint8>& other) const { return size() == other.size() && (empty() || memcmp(data(), other.data(), size()) == 0); }
+			bool operator!=(const std::vector<uint8>& other) const { return !(*this == other); }
+
+		private:
+			std::vector<uint8> mOwned;
+			BufferPool::Buffer mBuffer;
+			const uint8* mView{ nullptr };
+			size_t mViewSize{ 0 };
+		};
+	}
+}
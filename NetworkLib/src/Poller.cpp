@@ -0,0 +1,137 @@
+#include "Poller.hpp"
+#include "Address.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		Poller::~Poller()
+		{
+			release();
+		}
+
+		bool Poller::init(SOCKET sckt)
+		{
+			release();
+			mSocket = sckt;
+		#ifdef BOUSKNET_HAS_EPOLL
+			mEpoll = epoll_create1(EPOLL_CLOEXEC);
+			mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (mEpoll < 0 || mEventFd < 0)
+			{
+				release();
+				return false;
+			}
+			epoll_event socketEvent{};
+			socketEvent.events = EPOLLIN;
+			socketEvent.data.fd = mSocket;
+			epoll_event wakeUpEvent{};
+			wakeUpEvent.events = EPOLLIN;
+			wakeUpEvent.data.fd = mEventFd;
+			if (epoll_ctl(mEpoll, EPOLL_CTL_ADD, mSocket, &socketEvent) != 0 || epoll_ctl(mEpoll, EPOLL_CTL_ADD, mEventFd, &wakeUpEvent) != 0)
+			{
+				release();
+				return false;
+			}
+			mWritable = false;
+		#else
+			mWakeUpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+			if (mWakeUpSocket == INVALID_SOCKET || !Address::Loopback(Address::Type::IPv4, 0).bind(mWakeUpSocket) || !SetNonBlocking(mWakeUpSocket))
+			{
+				release();
+				return false;
+			}
+			socklen_t addrlen = sizeof(mWakeUpAddress);
+			if (getsockname(mWakeUpSocket, reinterpret_cast<sockaddr*>(&mWakeUpAddress), &addrlen) != 0)
+			{
+				release();
+				return false;
+			}
+		#endif // BOUSKNET_HAS_EPOLL
+			return true;
+		}
+		void Poller::release()
+		{
+		#ifdef BOUSKNET_HAS_EPOLL
+			if (mEpoll >= 0)
+				close(mEpoll);
+			if (mEventFd >= 0)
+				close(mEventFd);
+			mEpoll = -1;
+			mEventFd = -1;
+		#else
+			if (mWakeUpSocket != INVALID_SOCKET)
+				CloseSocket(mWakeUpSocket);
+			mWakeUpSocket = INVALID_SOCKET;
+		#endif // BOUSKNET_HAS_EPOLL
+			mSocket = INVALID_SOCKET;
+		}
+
+		bool Poller::wait(const std::chrono::milliseconds timeout, const bool writable)
+		{
+			const int timeoutMs = static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(timeout.count(), 0, std::numeric_limits<int>::max()));
+		#ifdef BOUSKNET_HAS_EPOLL
+			if (mEpoll < 0)
+				return false;
+			if (writable != mWritable)
+			{
+				//!< Only register for writability while datagrams are waiting for room in the socket buffer, a socket is almost always writable
+				epoll_event socketEvent{};
+				socketEvent.events = writable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+				socketEvent.data.fd = mSocket;
+				if (epoll_ctl(mEpoll, EPOLL_CTL_MOD, mSocket, &socketEvent) == 0)
+					mWritable = writable;
+			}
+			epoll_event events[2];
+			const int nbEvents = epoll_wait(mEpoll, events, 2, timeoutMs);
+			for (int i = 0; i < nbEvents; ++i)
+			{
+				if (events[i].data.fd == mEventFd)
+				{
+					//!< Reset the counter so that next wait blocks again
+					uint64 counter;
+					const auto ret = read(mEventFd, &counter, sizeof(counter));
+					UNUSED(ret);
+				}
+			}
+			return nbEvents > 0;
+		#else
+			if (mWakeUpSocket == INVALID_SOCKET)
+				return false;
+			pollfd fds[2];
+			fds[0].fd = mSocket;
+			fds[0].events = writable ? (POLLIN | POLLOUT) : POLLIN;
+			fds[0].revents = 0;
+			fds[1].fd = mWakeUpSocket;
+			fds[1].events = POLLIN;
+			fds[1].revents = 0;
+			const int nbEvents = poll(fds, 2, timeoutMs);
+			if (nbEvents > 0 && (fds[1].revents & POLLIN))
+			{
+				char buffer;
+				while (recv(mWakeUpSocket, &buffer, sizeof(buffer), 0) >= 0)
+				{}
+			}
+			return nbEvents > 0;
+		#endif // BOUSKNET_HAS_EPOLL
+		}
+		void Poller::wakeUp()
+		{
+		#ifdef BOUSKNET_HAS_EPOLL
+			if (mEventFd >= 0)
+			{
+				const uint64 one = 1;
+				const auto ret = write(mEventFd, &one, sizeof(one));
+				UNUSED(ret);
+			}
+		#else
+			if (mWakeUpSocket != INVALID_SOCKET)
+				sendto(mWakeUpSocket, nullptr, 0, 0, reinterpret_cast<const sockaddr*>(&mWakeUpAddress), sizeof(mWakeUpAddress));
+		#endif // BOUSKNET_HAS_EPOLL
+		}
+	}
+}
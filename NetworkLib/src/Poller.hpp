@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Sockets.hpp"
+
+#include <chrono>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		/*
+		Blocks the calling thread until a socket is ready, another thread wakes it up, or a timeout expires.
+		Uses epoll and an eventfd on Linux. Elsewhere it falls back to poll, and wakes up by sending an empty datagram to a loopback socket.
+		*/
+		class Poller
+		{
+		public:
+			Poller() = default;
+			Poller(const Poller&) = delete;
+			Poller& operator=(const Poller&) = delete;
+			~Poller();
+
+			bool init(SOCKET sckt);
+			void release();
+
+			// Wait for the socket to be readable, or writable too if requested, for a call to wakeUp or for the timeout to expire
+			// Returns false if the timeout expired
+			bool wait(std::chrono::milliseconds timeout, bool writable);
+			// Interrupt current or next wait. Can be called anytime from any thread
+			void wakeUp();
+
+		private:
+			SOCKET mSocket{ INVALID_SOCKET };
+		#ifdef BOUSKNET_HAS_EPOLL
+			int mEpoll{ -1 };
+			int mEventFd{ -1 };
+			bool mWritable{ false }; //!< Whether the socket is currently registered for writability
+		#else
+			SOCKET mWakeUpSocket{ INVALID_SOCKET }; //!< Bound to loopback, sends to itself to wake up
+			sockaddr_storage mWakeUpAddress{ 0 };
+		#endif // BOUSKNET_HAS_EPOLL
+		};
+	}
+}
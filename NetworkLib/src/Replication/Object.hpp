@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Float.hpp>
+#include <RangedInteger.hpp>
+#include <Types.hpp>
+
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace Replication
+		{
+			using ObjectId = uint32;
+
+			//!< Value of a field as it's serialized : its offset from the minimum value, on nbBits bits
+			struct Field
+			{
+				uint64 value;
+				uint8 nbBits;
+
+				bool operator==(const Field& other) const { return value == other.value && nbBits == other.nbBits; }
+				bool operator!=(const Field& other) const { return !(*this == other); }
+			};
+
+			class FieldsWriter
+			{
+				friend class Snapshot;
+			public:
+				template<auto MIN, auto MAX>
+				void write(const RangedInteger<MIN, MAX>& value) { write(static_cast<uint64>(value.get()) - static_cast<uint64>(MIN), RangedInteger<MIN, MAX>::NbBits); }
+				template<class FLOATTYPE, int32 MIN, int32 MAX, uint8 NBDECIMALS, uint8 STEP>
+				void write(const Float<FLOATTYPE, MIN, MAX, NBDECIMALS, STEP>& value) { write(value.quantized()); }
+				void write(bool value) { write(value ? 1 : 0, 1); }
+
+			private:
+				explicit FieldsWriter(std::vector<Field>& fields) : mFields(fields) {}
+				void write(uint64 value, uint8 nbBits) { mFields.push_back({ value, nbBits }); }
+
+			private:
+				std::vector<Field>& mFields;
+			};
+
+			// Reads fields in the order they were written : fails if they don't match
+			class FieldsReader
+			{
+				friend class Snapshot;
+			public:
+				template<auto MIN, auto MAX>
+				bool read(RangedInteger<MIN, MAX>& value)
+				{
+					uint64 raw;
+					if (!read(raw, RangedInteger<MIN, MAX>::NbBits) || raw > RangedInteger<MIN, MAX>::Range)
+						return false;
+					value = static_cast<typename RangedInteger<MIN, MAX>::Type>(raw + static_cast<uint64>(MIN));
+					return true;
+				}
+				template<class FLOATTYPE, int32 MIN, int32 MAX, uint8 NBDECIMALS, uint8 STEP>
+				bool read(Float<FLOATTYPE, MIN, MAX, NBDECIMALS, STEP>& value) { return read(value.quantized()); }
+				bool read(bool& value)
+				{
+					uint64 raw;
+					if (!read(raw, 1))
+						return false;
+					value = (raw != 0);
+					return true;
+				}
+
+				bool isFinished() const { return mFields == mEnd; }
+
+			private:
+				FieldsReader(const Field* fields, const Field* end) : mFields(fields), mEnd(end) {}
+				bool read(uint64& value, uint8 nbBits)
+				{
+					if (mFields == mEnd || mFields->nbBits != nbBits)
+						return false;
+					value = (mFields++)->value;
+					return true;
+				}
+
+			private:
+				const Field* mFields;
+				const Field* mEnd;
+			};
+
+			/*
+			Object replicated by snapshots : it writes and reads its fields in the same order, each field being a RangedInteger, a Float or a bool.
+			*/
+			class Object
+			{
+			public:
+				virtual ~Object() = default;
+
+				virtual void write(FieldsWriter& writer) const = 0;
+				virtual bool read(FieldsReader& reader) = 0;
+			};
+		}
+	}
+}
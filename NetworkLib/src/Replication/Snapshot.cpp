@@ -0,0 +1,243 @@
+#include <Replication/Snapshot.hpp>
+#include <Serialization/Serializer.hpp>
+#include <Serialization/Deserializer.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace Replication
+		{
+			namespace
+			{
+				constexpr uint8 NbObjectsGroupBits = 6;
+				constexpr uint8 IdGapGroupBits = 4; //!< Ids are written as the gap to the previous one, usually small
+				constexpr uint8 NbFieldsGroupBits = 3;
+				constexpr uint8 NbFieldsMaxBits = 12;
+				constexpr uint8 FieldSizeBits = 6; //!< Fields have 1 to 64 bits
+
+				uint64 MaxValue(const uint8 nbBits) { return (nbBits >= 64) ? std::numeric_limits<uint64>::max() : (uint64(1) << nbBits) - 1; }
+
+				bool WriteValue(Serialization::Serializer& serializer, const Field& field)
+				{
+					return serializer.write(field.value, static_cast<uint64>(0), MaxValue(field.nbBits));
+				}
+				bool ReadValue(Serialization::Deserializer& deserializer, Field& field)
+				{
+					return deserializer.read(field.value, static_cast<uint64>(0), MaxValue(field.nbBits));
+				}
+			}
+
+			void Snapshot::add(const ObjectId id, const Object& object)
+			{
+				assert(mObjects.empty() || id > mObjects.back().id);
+				const uint32 firstField = static_cast<uint32>(mFields.size());
+				FieldsWriter writer(mFields);
+				object.write(writer);
+				mObjects.push_back({ id, firstField, static_cast<uint32>(mFields.size()) - firstField });
+			}
+			bool Snapshot::get(const ObjectId id, Object& object) const
+			{
+				const ObjectState* state = find(id);
+				if (!state)
+					return false;
+				FieldsReader reader(fields(*state), fields(*state) + state->nbFields);
+				return object.read(reader) && reader.isFinished();
+			}
+			void Snapshot::clear()
+			{
+				mObjects.clear();
+				mFields.clear();
+			}
+
+			std::vector<uint8> Snapshot::serialize() const
+			{
+				Serialization::Serializer serializer;
+				write(serializer, nullptr, 0, mObjects.size());
+				return std::vector<uint8>(serializer.buffer(), serializer.buffer() + serializer.bufferSize());
+			}
+			bool Snapshot::deserialize(const uint8* const data, const size_t datasize)
+			{
+				clear();
+				Serialization::Deserializer deserializer(data, datasize);
+				return read(deserializer, nullptr);
+			}
+
+			bool Snapshot::write(Serialization::Serializer& serializer, const Snapshot* const baseline, const size_t first, const size_t nbObjects) const
+			{
+				assert(first + nbObjects <= mObjects.size());
+				if (!serializer.writeVarUInt(static_cast<uint32>(nbObjects), NbObjectsGroupBits))
+					return false;
+				ObjectId minId = 0;
+				for (size_t index = first; index < first + nbObjects; ++index)
+				{
+					const ObjectState& object = mObjects[index];
+					const Field* const objectFields = fields(object);
+					if (!serializer.writeVarUInt(object.id - minId, IdGapGroupBits))
+						return false;
+					minId = object.id + 1;
+
+					const ObjectState* const baselineObject = baseline ? baseline->find(object.id) : nullptr;
+					if (baselineObject)
+					{
+						const bool changed = !sameFields(object, *baseline, *baselineObject);
+						if (!serializer.write(changed))
+							return false;
+						if (!changed)
+							continue;
+						const bool sameLayout = this->sameLayout(object, *baseline, *baselineObject);
+						if (!serializer.write(sameLayout))
+							return false;
+						if (sameLayout)
+						{
+							const Field* const baselineFields = baseline->fields(*baselineObject);
+							for (uint32 i = 0; i < object.nbFields; ++i)
+							{
+								const bool fieldChanged = (objectFields[i] != baselineFields[i]);
+								if (!serializer.write(fieldChanged) || (fieldChanged && !WriteValue(serializer, objectFields[i])))
+									return false;
+							}
+							continue;
+						}
+					}
+					//!< New object, or its fields don't match the baseline ones anymore
+					if (!serializer.writeVarUInt(object.nbFields, NbFieldsGroupBits))
+						return false;
+					for (uint32 i = 0; i < object.nbFields; ++i)
+					{
+						if (!serializer.write(static_cast<uint8>(objectFields[i].nbBits - 1), static_cast<uint8>(0), static_cast<uint8>(MaxValue(FieldSizeBits)))
+							|| !WriteValue(serializer, objectFields[i]))
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+			size_t Snapshot::NbObjectsBits(const size_t nbObjects)
+			{
+				return Serialization::Serializer::VarUIntBits(static_cast<uint32>(nbObjects), NbObjectsGroupBits);
+			}
+			size_t Snapshot::objectBits(const size_t index, const Snapshot* const baseline, const ObjectId minId) const
+			{
+				const ObjectState& object = mObjects[index];
+				const Field* const objectFields = fields(object);
+				size_t bits = Serialization::Serializer::VarUIntBits(object.id - minId, IdGapGroupBits);
+				const ObjectState* const baselineObject = baseline ? baseline->find(object.id) : nullptr;
+				if (baselineObject)
+				{
+					++bits;
+					if (sameFields(object, *baseline, *baselineObject))
+						return bits;
+					++bits;
+					if (sameLayout(object, *baseline, *baselineObject))
+					{
+						const Field* const baselineFields = baseline->fields(*baselineObject);
+						for (uint32 i = 0; i < object.nbFields; ++i)
+							bits += 1 + ((objectFields[i] != baselineFields[i]) ? objectFields[i].nbBits : 0);
+						return bits;
+					}
+				}
+				bits += Serialization::Serializer::VarUIntBits(object.nbFields, NbFieldsGroupBits);
+				for (uint32 i = 0; i < object.nbFields; ++i)
+					bits += FieldSizeBits + objectFields[i].nbBits;
+				return bits;
+			}
+			bool Snapshot::read(Serialization::Deserializer& deserializer, const Snapshot* const baseline)
+			{
+				uint32 nbObjects = 0;
+				if (!deserializer.readVarUInt(nbObjects, NbObjectsGroupBits))
+					return false;
+				uint64 minId = 0;
+				for (uint32 objectIndex = 0; objectIndex < nbObjects; ++objectIndex)
+				{
+					uint32 idGap = 0;
+					if (!deserializer.readVarUInt(idGap, IdGapGroupBits))
+						return false;
+					const uint64 id = minId + idGap;
+					if (id > std::numeric_limits<ObjectId>::max() || (!mObjects.empty() && id <= mObjects.back().id))
+						return false;
+					minId = id + 1;
+					ObjectState object{ static_cast<ObjectId>(id), static_cast<uint32>(mFields.size()), 0 };
+
+					const ObjectState* const baselineObject = baseline ? baseline->find(object.id) : nullptr;
+					bool isFull = true;
+					if (baselineObject)
+					{
+						bool changed = false;
+						bool sameLayout = false;
+						if (!deserializer.read(changed) || (changed && !deserializer.read(sameLayout)))
+							return false;
+						if (!changed || sameLayout)
+						{
+							isFull = false;
+							const Field* const baselineFields = baseline->fields(*baselineObject);
+							mFields.insert(mFields.end(), baselineFields, baselineFields + baselineObject->nbFields);
+							object.nbFields = baselineObject->nbFields;
+							for (uint32 i = 0; changed && i < object.nbFields; ++i)
+							{
+								bool fieldChanged = false;
+								if (!deserializer.read(fieldChanged) || (fieldChanged && !ReadValue(deserializer, mFields[object.firstField + i])))
+									return false;
+							}
+						}
+					}
+					if (isFull)
+					{
+						if (!deserializer.readVarUInt(object.nbFields, NbFieldsGroupBits, NbFieldsMaxBits))
+							return false;
+						for (uint32 i = 0; i < object.nbFields; ++i)
+						{
+							uint8 nbBits = 0;
+							Field field{ 0, 0 };
+							if (!deserializer.read(nbBits, static_cast<uint8>(0), static_cast<uint8>(MaxValue(FieldSizeBits))))
+								return false;
+							field.nbBits = nbBits + 1;
+							if (!ReadValue(deserializer, field))
+								return false;
+							mFields.push_back(field);
+						}
+					}
+					mObjects.push_back(object);
+				}
+				return true;
+			}
+			void Snapshot::append(const Snapshot& other)
+			{
+				assert(mObjects.empty() || other.mObjects.empty() || other.mObjects.front().id > mObjects.back().id);
+				const uint32 fieldsOffset = static_cast<uint32>(mFields.size());
+				mFields.insert(mFields.end(), other.mFields.begin(), other.mFields.end());
+				for (const ObjectState& object : other.mObjects)
+					mObjects.push_back({ object.id, object.firstField + fieldsOffset, object.nbFields });
+			}
+
+			const Snapshot::ObjectState* Snapshot::find(const ObjectId id) const
+			{
+				const auto it = std::lower_bound(mObjects.cbegin(), mObjects.cend(), id, [](const ObjectState& object, ObjectId id) { return object.id < id; });
+				return (it != mObjects.cend() && it->id == id) ? &*it : nullptr;
+			}
+			bool Snapshot::sameLayout(const ObjectState& object, const Snapshot& baseline, const ObjectState& baselineObject) const
+			{
+				if (object.nbFields != baselineObject.nbFields)
+					return false;
+				const Field* const objectFields = fields(object);
+				const Field* const baselineFields = baseline.fields(baselineObject);
+				for (uint32 i = 0; i < object.nbFields; ++i)
+				{
+					if (objectFields[i].nbBits != baselineFields[i].nbBits)
+						return false;
+				}
+				return true;
+			}
+			bool Snapshot::sameFields(const ObjectState& object, const Snapshot& baseline, const ObjectState& baselineObject) const
+			{
+				return object.nbFields == baselineObject.nbFields
+					&& std::equal(fields(object), fields(object) + object.nbFields, baseline.fields(baselineObject));
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Replication/Object.hpp>
+#include <Types.hpp>
+
+#include <vector>
+
+namespace Bousk
+{
+	namespace Serialization
+	{
+		class Serializer;
+		class Deserializer;
+	}
+	namespace Network
+	{
+		namespace Replication
+		{
+			/*
+			State of the replicated objects at a given time, with increasing ids.
+			Objects are written as a delta against a baseline snapshot the other end holds :
+			- an object in the baseline costs 1 bit if unchanged, otherwise 1 bit per field unchanged plus the fields changed
+			- an object not in the baseline is written in full, with the size of its fields
+			- an object of the baseline missing in the snapshot has been removed
+			Without baseline, all objects are written in full.
+			*/
+			class Snapshot
+			{
+			public:
+				// Objects must be added in increasing id order
+				void add(ObjectId id, const Object& object);
+				// Reads the object fields, false if it's not in the snapshot or its fields don't match
+				bool get(ObjectId id, Object& object) const;
+				bool contains(ObjectId id) const { return find(id) != nullptr; }
+				void clear();
+
+				size_t nbObjects() const { return mObjects.size(); }
+				ObjectId objectId(size_t index) const { return mObjects[index].id; }
+
+				// Full snapshot, to send on a SnapshotDelta channel or to store
+				std::vector<uint8> serialize() const;
+				bool deserialize(const uint8* data, size_t datasize);
+
+				// Delta of nbObjects objects from first, against baseline if any
+				bool write(Serialization::Serializer& serializer, const Snapshot* baseline, size_t first, size_t nbObjects) const;
+				// Bits write takes for the number of objects
+				static size_t NbObjectsBits(size_t nbObjects);
+				// Bits write takes for the object at index, following objects with ids lower than minId
+				size_t objectBits(size_t index, const Snapshot* baseline, ObjectId minId) const;
+				// Appends the objects of a delta written against baseline
+				bool read(Serialization::Deserializer& deserializer, const Snapshot* baseline);
+				// Appends the objects of other, whose ids must be greater
+				void append(const Snapshot& other);
+
+			private:
+				struct ObjectState
+				{
+					ObjectId id;
+					uint32 firstField;
+					uint32 nbFields;
+				};
+
+			private:
+				const ObjectState* find(ObjectId id) const;
+				const Field* fields(const ObjectState& object) const { return mFields.data() + object.firstField; }
+				bool sameLayout(const ObjectState& object, const Snapshot& baseline, const ObjectState& baselineObject) const;
+				bool sameFields(const ObjectState& object, const Snapshot& baseline, const ObjectState& baselineObject) const;
+
+			private:
+				std::vector<ObjectState> mObjects;
+				std::vector<Field> mFields; //!< Of all objects, one after the other
+			};
+		}
+	}
+}
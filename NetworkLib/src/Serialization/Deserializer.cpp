@@ -168,10 +168,10 @@ namespace Bousk
 		{
 			static_assert(sizeof(int32) == sizeof(uint32), "");
 			assert(minValue < maxValue);
-			const uint32 range = static_cast<uint32>(maxValue - minValue);
+			const uint32 range = static_cast<uint32>(maxValue) - static_cast<uint32>(minValue);
 			if (read(reinterpret_cast<uint32&>(data), 0, range))
 			{
-				data += minValue;
+				data = static_cast<int32>(static_cast<uint32>(data) + static_cast<uint32>(minValue));
 				return true;
 			}
 			return false;
@@ -180,10 +180,10 @@ namespace Bousk
 		{
 			static_assert(sizeof(int64) == sizeof(uint64), "");
 			assert(minValue < maxValue);
-			const uint64 range = static_cast<uint64>(maxValue - minValue);
+			const uint64 range = static_cast<uint64>(maxValue) - static_cast<uint64>(minValue);
 			if (read(reinterpret_cast<uint64&>(data), 0, range))
 			{
-				data += minValue;
+				data = static_cast<int64>(static_cast<uint64>(data) + static_cast<uint64>(minValue));
 				return true;
 			}
 			return false;
@@ -200,6 +200,24 @@ namespace Bousk
 			return false;
 		}
 
+		bool Deserializer::readVarUInt(uint32& data, const uint8 groupBits, const uint8 maxBits /*= 32*/)
+		{
+			assert(groupBits > 0 && groupBits < 8);
+			const uint8 groupMax = static_cast<uint8>((1 << groupBits) - 1);
+			data = 0;
+			for (uint8 shift = 0; shift < maxBits; shift += groupBits)
+			{
+				uint8 group = 0;
+				bool hasNext = false;
+				if (!read(group, static_cast<uint8>(0), groupMax) || !read(hasNext))
+					return false;
+				data |= static_cast<uint32>(group) << shift;
+				if (!hasNext)
+					return true;
+			}
+			return false;
+		}
+
 	#if BOUSKNET_ALLOW_FLOAT32_SERIALIZATION == BOUSKNET_SETTINGS_ENABLED
 		bool Deserializer::read(float32& data)
 		{
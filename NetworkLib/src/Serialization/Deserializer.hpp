@@ -42,6 +42,8 @@ namespace Bousk
 			inline bool read(int64& data) { return read(data, std::numeric_limits<int64>::min(), std::numeric_limits<int64>::max()); }
 
 			bool read(bool& data);
+			// Value written with Serializer::writeVarUInt, of at most maxBits bits
+			bool readVarUInt(uint32& data, uint8 groupBits, uint8 maxBits = 32);
 
 			// To use if your enum has Min & Max entries
 			template<class E>
@@ -71,6 +73,9 @@ namespace Bousk
 			inline bool read(std::vector<T>& data) { return readContainer(data); }
 			inline bool read(std::string& data) { return readContainer(data); }
 
+			// Bytes used so far, including the one being read : raw data written after the serialized bits starts there
+			inline size_t bytesRead() const { return mBytesRead + (mBitsRead ? 1 : 0); }
+
 		private:
 			bool readBits(uint8 nbBits, uint8* buffer, uint8 bufferSize);
 			template<class CONTAINER>
@@ -1,9 +1,9 @@
 #include <Serialization/Serializer.hpp>
-#include <Serialization/Convert.hpp>
 #include <Serialization/Serialization.hpp>
 #include <Utils.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 namespace Bousk
 {
@@ -14,47 +14,83 @@ namespace Bousk
 			return serializable.write(*this);
 		}
 
-		bool Serializer::writeBits(const uint8* const buffer, const uint8 buffersize, const uint8 nbBits)
+		namespace
+		{
+			//!< Each byte of value rotated left by rotation bits, on its own
+			uint64 RotateBytesLeft(const uint64 value, const uint8 rotation)
+			{
+				if (rotation == 0)
+					return value;
+				const uint64 lowBits = 0x0101010101010101ull * ((1u << rotation) - 1);
+				return ((value << rotation) & ~lowBits) | ((value >> (8 - rotation)) & lowBits);
+			}
+			uint64 ByteSwap(const uint64 value)
+			{
+			#ifdef _MSC_VER
+				return _byteswap_uint64(value);
+			#else
+				return __builtin_bswap64(value);
+			#endif // _MSC_VER
+			}
+			uint64 ToBigEndian(const uint64 value)
+			{
+			#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				return value;
+			#else
+				return ByteSwap(value);
+			#endif
+			}
+		}
+
+		bool Serializer::writeBits(const uint64 value, const uint8 nbBits)
 		{
 			static_assert(CHAR_BIT == 8, "");
-			uint8 totalWrittenBits = 0;
-			// buffer here is in network/big endian, so bytes to write must be read right (buffer + buffersize - 1) to left (buffer)
-			for (uint8 readingBytesOffset = 1; readingBytesOffset <= buffersize && totalWrittenBits < nbBits; ++readingBytesOffset)
+			assert(nbBits >= 1 && nbBits <= 64);
+			assert(nbBits == 64 || (value >> nbBits) == 0);
+			/*
+			Bits are packed in bytes from left to right, value bytes being written from the lowest one.
+			When the current byte is partially used, the right bits of each value byte complete it and its left bits start the next one,
+			so that each byte of value is written rotated left by the number of used bits.
+			Bits to write are reordered in stream, from the first one on the left, then written as a whole word.
+			*/
+			const uint8 nbFullBytes = nbBits / 8;
+			const uint8 nbLastBits = nbBits % 8;
+			uint64 stream = 0;
+			if (nbFullBytes)
+				stream = ByteSwap(RotateBytesLeft(value, mUsedBits)) >> (64 - nbFullBytes * 8);
+			if (nbLastBits)
 			{
-				const uint8 srcByte = *(buffer + buffersize - readingBytesOffset);
-				const uint8 bitsToWrite = static_cast<uint8>(std::min(8, nbBits - totalWrittenBits));
-				uint8 writtenBits = 0;
-				if (mUsedBits)
+				uint8 lastBits = static_cast<uint8>(value >> (nbFullBytes * 8));
+				const uint8 remainingBitsInCurrentByte = 8 - mUsedBits;
+				if (mUsedBits && nbLastBits > remainingBitsInCurrentByte)
 				{
-					// We have an existing byte to pack data to
-					const uint8 remainingBitsInCurrentByte = 8 - mUsedBits;
-					const uint8 nbBitsToPack = std::min(bitsToWrite, remainingBitsInCurrentByte);
-					// Extract bits from the right
-					const uint8 rightBitsToPack = srcByte & Utils::CreateRightBitsMask(nbBitsToPack);
-					// Align those bits on the left to pack to existing bits in buffer
-					const uint8 bitsShiftToAlignLeft = remainingBitsInCurrentByte - nbBitsToPack;
-					const uint8 leftAlignedBits = rightBitsToPack << bitsShiftToAlignLeft;
-					mBuffer.back() |= leftAlignedBits;
-					writtenBits += nbBitsToPack;
+					// Its right bits complete the current byte, the left ones start the next one
+					const uint8 nbLeftBits = nbLastBits - remainingBitsInCurrentByte;
+					lastBits = static_cast<uint8>(((lastBits & ((1u << remainingBitsInCurrentByte) - 1)) << nbLeftBits) | (lastBits >> remainingBitsInCurrentByte));
 				}
-				const uint8 remainingBits = bitsToWrite - writtenBits;
-				if (remainingBits)
-				{
-					// Extract bits to serialize
-					const uint8 leftBitsToPack = srcByte & Utils::CreateBitsMask(remainingBits, writtenBits);
-					// Align bits to the left on the new byte
-					const uint8 bitsShiftToAlignLeft = 8 - writtenBits - remainingBits;
-					const uint8 leftAlignedBits = leftBitsToPack << bitsShiftToAlignLeft;
-					// Add those bits as a new byte to the buffer, they are aligned on the left in new byte
-					mBuffer.push_back(leftAlignedBits);
-					writtenBits += remainingBits;
-				}
-				// Update our counters
-				totalWrittenBits += writtenBits;
-				mUsedBits += writtenBits;
-				mUsedBits %= 8;
+				stream = (stream << nbLastBits) | lastBits;
 			}
-			return totalWrittenBits == nbBits;
+
+			uint8 nbRemainingBits = nbBits;
+			if (mUsedBits)
+			{
+				// Complete the current byte
+				const uint8 remainingBitsInCurrentByte = 8 - mUsedBits;
+				const uint8 nbBitsToPack = std::min(nbBits, remainingBitsInCurrentByte);
+				mBuffer.back() |= static_cast<uint8>((stream >> (nbBits - nbBitsToPack)) << (remainingBitsInCurrentByte - nbBitsToPack));
+				nbRemainingBits -= nbBitsToPack;
+				mUsedBits = (mUsedBits + nbBitsToPack) % 8;
+				if (nbRemainingBits == 0)
+					return true;
+			}
+			// Remaining bits start on a new byte : append the bytes they use of a word where they're aligned on the left
+			if (mBuffer.capacity() < mBuffer.size() + sizeof(uint64))
+				mBuffer.reserve(std::max<size_t>(2 * mBuffer.capacity(), 64));
+			const uint64 word = ToBigEndian(stream << (64 - nbRemainingBits));
+			const uint8* bytes = reinterpret_cast<const uint8*>(&word);
+			mBuffer.insert(mBuffer.end(), bytes, bytes + (nbRemainingBits + 7) / 8);
+			mUsedBits = nbRemainingBits % 8;
+			return true;
 		}
 
 		bool Serializer::write(const uint8 data, const uint8 minValue, const uint8 maxValue)
@@ -63,7 +99,7 @@ namespace Bousk
 			assert(minValue <= data && data <= maxValue);
 			const uint8 rangedData = data - minValue;
 			const uint8 range = maxValue - minValue;
-			return writeBits(&rangedData, 1, Utils::CountNeededBits(range));
+			return writeBits(rangedData, Utils::CountNeededBits(range));
 		}
 		bool Serializer::write(uint16 data, uint16 minValue, uint16 maxValue)
 		{
@@ -71,9 +107,7 @@ namespace Bousk
 			assert(minValue <= data && data <= maxValue);
 			const uint16 rangedData = data - minValue;
 			const uint16 range = maxValue - minValue;
-			uint8 conv[2];
-			Conversion::ToNetwork(rangedData, conv);
-			return writeBits(conv, 2, Utils::CountNeededBits(range));
+			return writeBits(rangedData, Utils::CountNeededBits(range));
 		}
 		bool Serializer::write(const uint32 data, const uint32 minValue, const uint32 maxValue)
 		{
@@ -81,9 +115,7 @@ namespace Bousk
 			assert(minValue <= data && data <= maxValue);
 			const uint32 rangedData = data - minValue;
 			const uint32 range = maxValue - minValue;
-			uint8 conv[4];
-			Conversion::ToNetwork(rangedData, conv);
-			return writeBits(conv, 4, Utils::CountNeededBits(range));
+			return writeBits(rangedData, Utils::CountNeededBits(range));
 		}
 		bool Serializer::write(uint64 data, uint64 minValue, uint64 maxValue)
 		{
@@ -91,9 +123,7 @@ namespace Bousk
 			assert(minValue <= data && data <= maxValue);
 			const uint64 rangedData = data - minValue;
 			const uint64 range = maxValue - minValue;
-			uint8 conv[8];
-			Conversion::ToNetwork(rangedData, conv);
-			return writeBits(conv, 8, Utils::CountNeededBits(range));
+			return writeBits(rangedData, Utils::CountNeededBits(range));
 		}
 
 		bool Serializer::write(const int8 data, const int8 minValue, const int8 maxValue)
@@ -119,8 +149,8 @@ namespace Bousk
 			static_assert(sizeof(int32) == sizeof(uint32), "");
 			assert(minValue < maxValue);
 			assert(minValue <= data && data <= maxValue);
-			const uint32 rangedData = static_cast<uint32>(data - minValue);
-			const uint32 range = static_cast<uint32>(maxValue - minValue);
+			const uint32 rangedData = static_cast<uint32>(data) - static_cast<uint32>(minValue);
+			const uint32 range = static_cast<uint32>(maxValue) - static_cast<uint32>(minValue);
 			return write(rangedData, static_cast<uint32>(0), range);
 		}
 		bool Serializer::write(int64 data, int64 minValue, int64 maxValue)
@@ -128,17 +158,34 @@ namespace Bousk
 			static_assert(sizeof(int64) == sizeof(uint64), "");
 			assert(minValue < maxValue);
 			assert(minValue <= data && data <= maxValue);
-			const uint64 rangedData = static_cast<uint64>(data - minValue);
-			const uint64 range = static_cast<uint64>(maxValue - minValue);
+			const uint64 rangedData = static_cast<uint64>(data) - static_cast<uint64>(minValue);
+			const uint64 range = static_cast<uint64>(maxValue) - static_cast<uint64>(minValue);
 			return write(rangedData, static_cast<uint64>(0), range);
 		}
 
+		bool Serializer::writeVarUInt(uint32 data, const uint8 groupBits)
+		{
+			assert(groupBits > 0 && groupBits < 8);
+			const uint8 groupMax = static_cast<uint8>((1 << groupBits) - 1);
+			for (;;)
+			{
+				if (!write(static_cast<uint8>(data & groupMax), static_cast<uint8>(0), groupMax))
+					return false;
+				data >>= groupBits;
+				if (!write(data != 0))
+					return false;
+				if (data == 0)
+					return true;
+			}
+		}
+
 	#if BOUSKNET_ALLOW_FLOAT32_SERIALIZATION == BOUSKNET_SETTINGS_ENABLED
 		bool Serializer::write(const float32 data)
 		{
-			uint32 conv;
-			Conversion::ToNetwork(data, conv);
-			return writeBits(reinterpret_cast<const uint8*>(&conv), 4, 32);
+			static_assert(sizeof(float32) == sizeof(uint32), "");
+			uint32 bits;
+			memcpy(&bits, &data, sizeof(bits));
+			return writeBits(bits, 32);
 		}
 	#endif // BOUSKNET_ALLOW_FLOAT32_SERIALIZATION == BOUSKNET_SETTINGS_ENABLED
 	}
@@ -39,6 +39,9 @@ namespace Bousk
 			inline bool write(int64 data) { return write(data, std::numeric_limits<int64>::min(), std::numeric_limits<int64>::max()); }
 
 			inline bool write(bool data) { return write(data ? BoolTrue : BoolFalse, static_cast<uint8>(0), static_cast<uint8>(1)); }
+			// Groups of groupBits bits, each followed by a bit telling whether another group follows : small values take a few bits only
+			bool writeVarUInt(uint32 data, uint8 groupBits);
+			static constexpr size_t VarUIntBits(uint32 data, uint8 groupBits) { return (data >> groupBits) ? groupBits + 1 + VarUIntBits(data >> groupBits, groupBits) : groupBits + 1; }
 
 			// To use if your enum has Min & Max entries
 			template<class E>
@@ -65,9 +68,12 @@ namespace Bousk
 
 			inline const uint8* buffer() const { return mBuffer.data(); }
 			inline size_t bufferSize() const { return mBuffer.size(); }
+			// Bytes to reserve when the size to serialize is known
+			inline void reserve(size_t nbBytes) { mBuffer.reserve(nbBytes); }
 
 		private:
-			bool writeBits(const uint8* buffer, const uint8 buffersize, const uint8 nbBits);
+			// Writes the nbBits right bits of value
+			bool writeBits(uint64 value, uint8 nbBits);
 			template<class CONTAINER>
 			bool writeContainer(const CONTAINER& container);
 
@@ -11,9 +11,39 @@
 // Default UDP timeout
 #define BOUSKNET_DEFAULT_UDP_TIMEOUT std::chrono::seconds(1)
 
+// Default interval between 2 keep alives of an idle UDP connection
+#define BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL std::chrono::milliseconds(250)
+
+// Default bound an UDP connection may wait for before acknowledging received data, in case more data arrives meanwhile : acks of several datagrams then share a keep alive
+#define BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY std::chrono::milliseconds(0)
+
+// Default number of received datagrams an UDP connection acknowledges at once, without waiting for the max ack delay
+#define BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY 1
+
+// Default bound an UDP connection may hold back a partly filled datagram for, waiting for more messages to coalesce into it
+#define BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY std::chrono::milliseconds(0)
+
+// Default bytes of messages queued for an UDP connection to send them without waiting for the coalescing max delay
+#define BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD 1024
+
 // Allow use of network simulator
 #define BOUSKNET_ALLOW_NETWORK_SIMULATOR BOUSKNET_SETTINGS_ENABLED
 
+// Maximum number of datagrams pulled from the UDP socket per system call
+#define BOUSKNET_UDP_RECEIVE_BATCH_SIZE 32
+
+// Maximum number of datagrams waiting in the UDP outbound queue when the socket can't take them all. Extra datagrams are dropped
+#define BOUSKNET_UDP_SEND_QUEUE_MAX_SIZE 4096
+
+// Number of preallocated slots for operations (connect, sendTo, disconnect) queued between 2 UDP processSend. More operations are still queued, but behind a lock
+#define BOUSKNET_UDP_OPERATIONS_QUEUE_SIZE 4096
+
+// Number of preallocated slots for messages waiting to be polled by the application. More messages are still queued, but behind a lock
+#define BOUSKNET_MESSAGES_QUEUE_SIZE 1024
+
+// Default number of packets a reliable channel may have in flight, which the receiving end can store out of order. Power of 2, both ends must use the same
+#define BOUSKNET_UDP_RELIABLE_WINDOW_SIZE 64
+
 
 // Default value for unset settings
 #ifndef BOUSKNET_ALLOW_FLOAT32_SERIALIZATION
@@ -24,6 +54,46 @@
 	#define BOUSKNET_DEFAULT_UDP_TIMEOUT std::chrono::seconds(1)
 #endif // BOUSKNET_DEFAULT_UDP_TIMEOUT
 
+#ifndef BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL
+	#define BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL std::chrono::milliseconds(250)
+#endif // BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL
+
+#ifndef BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY
+	#define BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY std::chrono::milliseconds(0)
+#endif // BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY
+
+#ifndef BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY
+	#define BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY 1
+#endif // BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY
+
+#ifndef BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY
+	#define BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY std::chrono::milliseconds(0)
+#endif // BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY
+
+#ifndef BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD
+	#define BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD 1024
+#endif // BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD
+
 #ifndef BOUSKNET_ALLOW_NETWORK_SIMULATOR
 	#define BOUSKNET_ALLOW_NETWORK_SIMULATOR BOUSKNET_SETTINGS_DISABLED
-#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR
\ No newline at end of file
+#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR
+
+#ifndef BOUSKNET_UDP_RECEIVE_BATCH_SIZE
+	#define BOUSKNET_UDP_RECEIVE_BATCH_SIZE 32
+#endif // BOUSKNET_UDP_RECEIVE_BATCH_SIZE
+
+#ifndef BOUSKNET_UDP_SEND_QUEUE_MAX_SIZE
+	#define BOUSKNET_UDP_SEND_QUEUE_MAX_SIZE 4096
+#endif // BOUSKNET_UDP_SEND_QUEUE_MAX_SIZE
+
+#ifndef BOUSKNET_UDP_OPERATIONS_QUEUE_SIZE
+	#define BOUSKNET_UDP_OPERATIONS_QUEUE_SIZE 4096
+#endif // BOUSKNET_UDP_OPERATIONS_QUEUE_SIZE
+
+#ifndef BOUSKNET_MESSAGES_QUEUE_SIZE
+	#define BOUSKNET_MESSAGES_QUEUE_SIZE 1024
+#endif // BOUSKNET_MESSAGES_QUEUE_SIZE
+
+#ifndef BOUSKNET_UDP_RELIABLE_WINDOW_SIZE
+	#define BOUSKNET_UDP_RELIABLE_WINDOW_SIZE 64
+#endif // BOUSKNET_UDP_RELIABLE_WINDOW_SIZE
\ No newline at end of file
@@ -41,6 +41,16 @@ namespace Bousk
 			return setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) == 0;
 		#endif
 		}
+		bool SetReusePort(SOCKET socket)
+		{
+		#ifdef SO_REUSEPORT
+			int optval = 1;
+			return setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&optval), sizeof(optval)) == 0;
+		#else
+			UNUSED(socket);
+			return false;
+		#endif
+		}
 		void CloseSocket(SOCKET s)
 		{
 		#ifdef _WIN32
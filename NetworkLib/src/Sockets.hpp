@@ -43,6 +43,23 @@
 	#include <cerrno> // errno
 	#include <poll.h> // poll
 	#include <fcntl.h>
+	#ifdef __linux__
+		#include <netinet/udp.h> // UDP_SEGMENT, UDP_GRO
+		#define BOUSKNET_HAS_MMSG // recvmmsg & sendmmsg : several datagrams per system call
+		#ifndef UDP_SEGMENT
+			#define UDP_SEGMENT 103
+		#endif
+		#ifndef UDP_GRO
+			#define UDP_GRO 104
+		#endif
+		#ifndef SOL_UDP
+			#define SOL_UDP 17
+		#endif
+		#define BOUSKNET_HAS_UDP_OFFLOAD // UDP_SEGMENT & UDP_GRO, still needs to be supported by the running kernel
+		#include <sys/epoll.h>
+		#include <sys/eventfd.h>
+		#define BOUSKNET_HAS_EPOLL // epoll & eventfd to wait for a socket or a wake up from another thread
+	#endif
 	#define SOCKET int
 	#define INVALID_SOCKET ((int)-1)
 	#define SOCKET_ERROR (int(-1))
@@ -58,6 +75,9 @@ namespace Bousk
 		void Release();
 		bool SetNonBlocking(SOCKET socket);
 		bool SetReuseAddr(SOCKET socket);
+		// Allow several sockets to bind the same port, the system then spreads incoming datagrams between them by sender
+		// Returns false if the platform doesn't support it
+		bool SetReusePort(SOCKET socket);
 		void CloseSocket(SOCKET socket);
 		std::string GetAddress(const sockaddr_in& addr);
 		unsigned short GetPort(const sockaddr_in& addr);
@@ -69,11 +69,7 @@ namespace Bousk
 					Client newClient;
 					if (newClient.init(std::move(newClientSocket), addr))
 					{
-						auto message = std::make_unique<Messages::IncomingConnection>(newClient.address(), newClient.id());
-						{
-							MessagesLock lock(mMessagesLock);
-							mMessages.push_back(std::move(message));
-						}
+						mMessages.push(std::make_unique<Messages::IncomingConnection>(newClient.address(), newClient.id()));
 						mClients[newClient.id()] = std::move(newClient);
 					}
 				}
@@ -95,10 +91,7 @@ namespace Bousk
 						{
 							++itClient;
 						}
-						{
-							MessagesLock lock(mMessagesLock);
-							mMessages.push_back(std::move(msg));
-						}
+						mMessages.push(std::move(msg));
 					}
 					else
 						++itClient;
@@ -125,11 +118,6 @@ namespace Bousk
 					ret &= client.second.send(data, len);
 				return ret;
 			}
-			std::vector<std::unique_ptr<Messages::Base>> Server::poll()
-			{
-				MessagesLock lock(mMessagesLock);
-				return std::move(mMessages);
-			}
 		}
 	}
 }
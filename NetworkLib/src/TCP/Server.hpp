@@ -1,5 +1,6 @@
 #pragma once
 
+#include <MessagesQueue.hpp>
 #include <Sockets.hpp>
 #include <Types.hpp>
 #include <TCP/Client.hpp>
@@ -41,13 +42,16 @@ namespace Bousk
 				bool sendTo(uint64 clientid, const uint8* data, size_t len);
 				// Cannot be called during update
 				bool sendToAll(const uint8* data, size_t len);
-				std::vector<std::unique_ptr<Messages::Base>> poll();
+				std::vector<std::unique_ptr<Messages::Base>> poll() { return mMessages.poll(); }
+				// Append ready messages to the given vector, which keeps its capacity from frame to frame
+				void poll(std::vector<std::unique_ptr<Messages::Base>>& messages) { mMessages.poll(messages); }
+				// Call callback(std::unique_ptr<Messages::Base>&&) with each ready message. Returns the number of messages polled
+				template<class Callback>
+				size_t poll(Callback&& callback) { return mMessages.poll(std::forward<Callback>(callback)); }
 
 			private:
 				std::map<uint64, Client> mClients;
-				std::mutex mMessagesLock;
-				using MessagesLock = std::lock_guard<decltype(mMessagesLock)>;
-				std::vector<std::unique_ptr<Messages::Base>> mMessages;
+				MessagesQueue mMessages;
 				SOCKET mSocket{ INVALID_SOCKET };
 			};
 		}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <limits>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif // _MSC_VER
+
+namespace Bousk
+{
+	/*
+	Hierarchical timer wheel with a resolution of a millisecond.
+	Each level has 64 slots, a slot of level L covering 64^L milliseconds : 4 levels reach deadlines up to 4.6 hours, further ones are clamped.
+	Scheduling and cancelling a timer is O(1), advancing the time only visits due timers and skips empty slots.
+	A timer expires once its deadline is reached, at most a millisecond late.
+
+	Timers are intrusive : the owner of type T holds its timer, which cancels itself when destroyed.
+	*/
+	template<class T>
+	class TimerWheel
+	{
+	public:
+		class Timer
+		{
+			friend class TimerWheel;
+		public:
+			explicit Timer(T& owner) : mOwner(owner) {}
+			Timer(const Timer&) = delete;
+			Timer& operator=(const Timer&) = delete;
+			~Timer() { cancel(); }
+
+			bool isScheduled() const { return mWheel != nullptr; }
+			std::chrono::milliseconds deadline() const { return std::chrono::milliseconds(mDeadline); }
+			void cancel() { if (mWheel) mWheel->unlink(*this); }
+
+		private:
+			T& mOwner;
+			TimerWheel* mWheel{ nullptr };
+			Timer* mPrevious{ nullptr };
+			Timer* mNext{ nullptr };
+			uint64 mDeadline{ 0 };
+			uint8 mLevel{ 0 };
+			uint8 mSlot{ 0 };
+		};
+
+		static constexpr size_t NbLevels = 4;
+		static constexpr size_t SlotsPerLevel = 64;
+
+	public:
+		explicit TimerWheel(std::chrono::milliseconds now) : mCurrent(static_cast<uint64>(now.count())) {}
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+		~TimerWheel();
+
+		// Schedule the timer, or reschedule it if it's already scheduled. A deadline already reached expires with next advance
+		void schedule(Timer& timer, std::chrono::milliseconds deadline);
+		// Move time forward, calling onExpired(T&) for each timer reaching its deadline. Timers can be scheduled from the callback
+		template<class OnExpired>
+		void advance(std::chrono::milliseconds now, OnExpired&& onExpired);
+		// Earliest time a timer may expire : never later than the actual next expiration, max if no timer is scheduled
+		std::chrono::milliseconds nextExpiration() const;
+
+		std::chrono::milliseconds now() const { return std::chrono::milliseconds(mCurrent); }
+		bool empty() const { return mNbTimers == 0; }
+		size_t size() const { return mNbTimers; }
+
+	private:
+		static constexpr uint64 SlotMask = SlotsPerLevel - 1;
+		static constexpr uint64 LevelBits = 6;
+		static constexpr uint64 MaxDelta = (uint64(1) << (LevelBits * NbLevels)) - 1;
+		static size_t CountTrailingZeros(uint64 value);
+
+		//!< Put the timer in the slot matching its deadline. Deadlines already reached go to the current slot of level 0
+		void insert(Timer& timer);
+		void unlink(Timer& timer);
+		//!< Redistribute the current slot of level, and of upper levels first if they wrapped too
+		void cascade(size_t level);
+
+	private:
+		std::array<std::array<Timer*, SlotsPerLevel>, NbLevels> mSlots{};
+		std::array<uint64, NbLevels> mOccupied{}; //!< Bit per non empty slot
+		uint64 mCurrent; //!< Time of the last expired slot
+		size_t mNbTimers{ 0 };
+	};
+
+	template<class T>
+	TimerWheel<T>::~TimerWheel()
+	{
+		for (auto& level : mSlots)
+			for (Timer* timer : level)
+				for (; timer; timer = timer->mNext)
+					timer->mWheel = nullptr;
+	}
+	template<class T>
+	void TimerWheel<T>::schedule(Timer& timer, const std::chrono::milliseconds deadline)
+	{
+		if (timer.isScheduled())
+			unlink(timer);
+		const uint64 ms = static_cast<uint64>(std::max<std::chrono::milliseconds::rep>(0, deadline.count()));
+		//!< The current slot has already expired
+		timer.mDeadline = std::max(ms, mCurrent + 1);
+		insert(timer);
+	}
+	template<class T>
+	template<class OnExpired>
+	void TimerWheel<T>::advance(const std::chrono::milliseconds now, OnExpired&& onExpired)
+	{
+		const uint64 target = static_cast<uint64>(std::max<std::chrono::milliseconds::rep>(0, now.count()));
+		while (mCurrent < target)
+		{
+			//!< Skip slots of the levels without timers : only the next slot of the lowest used level matters
+			size_t level = 0;
+			while (level < NbLevels && mOccupied[level] == 0)
+				++level;
+			if (level == NbLevels)
+			{
+				mCurrent = target;
+				break;
+			}
+			uint64 next = mCurrent + 1;
+			if (level > 0)
+			{
+				const uint64 levelShift = LevelBits * level;
+				next = std::min(target, ((mCurrent >> levelShift) + 1) << levelShift);
+			}
+			mCurrent = next;
+			if ((mCurrent & SlotMask) == 0)
+				cascade(1);
+
+			Timer*& slot = mSlots[0][mCurrent & SlotMask];
+			while (Timer* timer = slot)
+			{
+				unlink(*timer);
+				onExpired(timer->mOwner);
+			}
+		}
+	}
+	template<class T>
+	std::chrono::milliseconds TimerWheel<T>::nextExpiration() const
+	{
+		//!< A timer of an upper level may have been scheduled before a later one of a lower level : check them all
+		uint64 earliest = std::numeric_limits<uint64>::max();
+		for (size_t level = 0; level < NbLevels; ++level)
+		{
+			if (mOccupied[level] == 0)
+				continue;
+			const uint64 levelShift = LevelBits * level;
+			const uint64 currentSlot = (mCurrent >> levelShift) & SlotMask;
+			//!< Rotate so that the slot following the current one comes first : the current slot itself comes last, a full turn later
+			const uint64 rotation = (currentSlot + 1) & SlotMask;
+			const uint64 rotated = rotation ? ((mOccupied[level] >> rotation) | (mOccupied[level] << (SlotsPerLevel - rotation))) : mOccupied[level];
+			const uint64 distance = CountTrailingZeros(rotated) + 1;
+			//!< Timers of upper levels expire somewhere in their slot, which starts that late at least
+			const uint64 expiration = (level == 0) ? mCurrent + distance : ((mCurrent >> levelShift) + distance) << levelShift;
+			earliest = std::min(earliest, expiration);
+		}
+		if (earliest == std::numeric_limits<uint64>::max())
+			return std::chrono::milliseconds::max();
+		return std::chrono::milliseconds(earliest);
+	}
+
+	template<class T>
+	size_t TimerWheel<T>::CountTrailingZeros(const uint64 value)
+	{
+		assert(value != 0);
+	#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+	#else
+		return static_cast<size_t>(__builtin_ctzll(value));
+	#endif // _MSC_VER
+	}
+	template<class T>
+	void TimerWheel<T>::insert(Timer& timer)
+	{
+		const uint64 deadline = std::max(timer.mDeadline, mCurrent);
+		const uint64 delta = std::min(deadline - mCurrent, MaxDelta);
+		size_t level = 0;
+		while (level + 1 < NbLevels && delta >= (uint64(1) << (LevelBits * (level + 1))))
+			++level;
+		const size_t slot = static_cast<size_t>(((mCurrent + delta) >> (LevelBits * level)) & SlotMask);
+
+		Timer*& head = mSlots[level][slot];
+		timer.mWheel = this;
+		timer.mLevel = static_cast<uint8>(level);
+		timer.mSlot = static_cast<uint8>(slot);
+		timer.mPrevious = nullptr;
+		timer.mNext = head;
+		if (head)
+			head->mPrevious = &timer;
+		head = &timer;
+		mOccupied[level] |= uint64(1) << slot;
+		++mNbTimers;
+	}
+	template<class T>
+	void TimerWheel<T>::unlink(Timer& timer)
+	{
+		assert(timer.mWheel == this);
+		if (timer.mPrevious)
+			timer.mPrevious->mNext = timer.mNext;
+		else
+			mSlots[timer.mLevel][timer.mSlot] = timer.mNext;
+		if (timer.mNext)
+			timer.mNext->mPrevious = timer.mPrevious;
+		if (!mSlots[timer.mLevel][timer.mSlot])
+			mOccupied[timer.mLevel] &= ~(uint64(1) << timer.mSlot);
+		timer.mWheel = nullptr;
+		timer.mPrevious = nullptr;
+		timer.mNext = nullptr;
+		--mNbTimers;
+	}
+	template<class T>
+	void TimerWheel<T>::cascade(const size_t level)
+	{
+		if (level >= NbLevels)
+			return;
+		const uint64 slot = (mCurrent >> (LevelBits * level)) & SlotMask;
+		if (slot == 0)
+			cascade(level + 1);
+		Timer* timer = mSlots[level][slot];
+		if (!timer)
+			return;
+		//!< Detach the whole slot then put its timers back : they land in lower levels
+		mSlots[level][slot] = nullptr;
+		mOccupied[level] &= ~(uint64(1) << slot);
+		while (timer)
+		{
+			Timer* next = timer->mNext;
+			--mNbTimers;
+			insert(*timer);
+			timer = next;
+		}
+	}
+}
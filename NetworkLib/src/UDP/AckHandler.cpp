@@ -124,6 +124,18 @@ namespace Bousk
 				const uint8 bitPosition = static_cast<uint8>(diff - 1);
 				return Utils::HasBit(mNewAcks, bitPosition);
 			}
+			uint8 AckHandler::nbAckedAfter(const uint16 ack) const
+			{
+				if (!Utils::IsSequenceNewer(mLastAck, ack))
+					return 0;
+				//!< Last ack, plus the previous ones from the mask down to the given id excluded
+				const auto diff = Utils::SequenceDiff(mLastAck, ack);
+				uint64 acksAfter = (diff > 64) ? mPreviousAcks : mPreviousAcks & ((uint64(1) << (diff - 1)) - 1);
+				uint8 nbAcks = 1;
+				for (; acksAfter; acksAfter &= acksAfter - 1)
+					++nbAcks;
+				return nbAcks;
+			}
 			std::vector<uint16> AckHandler::getNewAcks() const
 			{
 				std::vector<uint16> newAcks;
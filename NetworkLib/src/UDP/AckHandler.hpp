@@ -24,6 +24,8 @@ namespace Bousk
 				void update(uint16 newAck, uint64 previousAcks, bool trackLoss = false);
 				bool isAcked(uint16 ack) const;
 				bool isNewlyAcked(uint16 ack) const;
+				// Number of acked ids newer than the given one, within the acks range
+				uint8 nbAckedAfter(uint16 ack) const;
 
 				uint16 lastAck() const { return mLastAck; }
 				uint64 previousAcksMask() const { return mPreviousAcks; }
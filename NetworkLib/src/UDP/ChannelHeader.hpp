@@ -8,6 +8,10 @@ namespace Bousk
 	{
 		namespace UDP
 		{
+			/*
+			Room reserved in a datagram per channel sending data.
+			Channels are encoded compactly on the wire, see ChannelsHandler : that encoding never takes more room than this header and the packets as they are in memory.
+			*/
 			struct ChannelHeader
 			{
 				static constexpr uint8 Size = sizeof(uint32) + sizeof(uint16);
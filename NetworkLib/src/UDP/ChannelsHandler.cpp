@@ -1,9 +1,14 @@
 #include <UDP/ChannelsHandler.hpp>
 #include <UDP/ChannelHeader.hpp>
+#include <UDP/Packet.hpp>
 #include <UDP/Protocols/UnreliableOrdered.hpp>
 #include <UDP/Protocols/ReliableOrdered.hpp>
+#include <Serialization/Serializer.hpp>
+#include <Serialization/Deserializer.hpp>
 
+#include <array>
 #include <cassert>
+#include <cstring>
 #include <iterator>
 
 namespace Bousk
@@ -12,6 +17,125 @@ namespace Bousk
 	{
 		namespace UDP
 		{
+			namespace
+			{
+				/*
+				Protocols exchange packets as they are in memory, each channel is encoded compactly on the wire :
+				- bit packed : channel id, number of packets, then for each packet its type, its id and its data size
+				  the first id is written in full, the next ones as their distance to the previous one, which is usually 1
+				- the data of the packets, one after the other
+				Integers are variable length, small values take a few bits only.
+				With at most 32 bits ids, an encoded channel is never larger than its packets plus a ChannelHeader.
+				*/
+				constexpr uint8 ChannelIdGroupBits = 3;
+				constexpr uint8 NbPacketsGroupBits = 4;
+				constexpr uint8 IdDistanceGroupBits = 3;
+				constexpr uint8 DataSizeGroupBits = 6;
+
+				//!< Distance to the id following the previous one, signed so that packets sent again, older than the previous one, remain small
+				uint32 IdDistance(const Packet::Id previousId, const Packet::Id id)
+				{
+					const uint16 distance = static_cast<uint16>(id - previousId - 1);
+					return static_cast<uint16>((distance << 1) ^ ((distance & 0x8000) ? 0xFFFF : 0));
+				}
+				Packet::Id IdFromDistance(const Packet::Id previousId, const uint32 encoded)
+				{
+					const uint16 distance = static_cast<uint16>((encoded >> 1) ^ ((encoded & 1) ? 0xFFFF : 0));
+					return static_cast<Packet::Id>(previousId + 1 + distance);
+				}
+
+				//!< Encode the packets of a channel to buffer, returns the size written
+				uint16 EncodeChannel(const uint32 channelId, const uint8* const packets, const uint16 packetsSize, uint8* const buffer)
+				{
+					uint32 nbPackets = 0;
+					for (uint16 offset = 0; offset < packetsSize; offset += reinterpret_cast<const Packet*>(packets + offset)->size())
+						++nbPackets;
+
+					Serialization::Serializer serializer;
+					serializer.writeVarUInt(channelId, ChannelIdGroupBits);
+					serializer.writeVarUInt(nbPackets, NbPacketsGroupBits);
+					Packet::Id previousId = 0;
+					for (uint16 offset = 0; offset < packetsSize; )
+					{
+						const Packet* const packet = reinterpret_cast<const Packet*>(packets + offset);
+						serializer.write(packet->type(), Packet::Type::FullMessage, Packet::Type::LastFragment);
+						if (offset == 0)
+							serializer.write(packet->id());
+						else
+							serializer.writeVarUInt(IdDistance(previousId, packet->id()), IdDistanceGroupBits);
+						serializer.writeVarUInt(packet->datasize(), DataSizeGroupBits);
+						previousId = packet->id();
+						offset += packet->size();
+					}
+					const uint16 headersSize = static_cast<uint16>(serializer.bufferSize());
+					memcpy(buffer, serializer.buffer(), headersSize);
+					uint8* data = buffer + headersSize;
+					for (uint16 offset = 0; offset < packetsSize; )
+					{
+						const Packet* const packet = reinterpret_cast<const Packet*>(packets + offset);
+						memcpy(data, packet->data(), packet->datasize());
+						data += packet->datasize();
+						offset += packet->size();
+					}
+					return static_cast<uint16>(data - buffer);
+				}
+				//!< Decode a channel from data and rebuild its packets in packets, which holds Datagram::DataMaxSize bytes
+				//!< Returns the size read, or 0 if data is malformed
+				uint16 DecodeChannel(const uint8* const data, const uint16 datasize, uint32& channelId, uint8* const packets, uint16& packetsSize)
+				{
+					Serialization::Deserializer deserializer(data, datasize);
+					uint32 nbPackets = 0;
+					if (!deserializer.readVarUInt(channelId, ChannelIdGroupBits, 32)
+						|| !deserializer.readVarUInt(nbPackets, NbPacketsGroupBits, 16)
+						|| nbPackets == 0)
+					{
+						return 0;
+					}
+					//!< Headers first, their data follows them all
+					packetsSize = 0;
+					Packet::Id previousId = 0;
+					for (uint32 i = 0; i < nbPackets; ++i)
+					{
+						if (packetsSize + Packet::HeaderSize > Datagram::DataMaxSize)
+							return 0;
+						Packet::Header header;
+						uint32 idDistance = 0;
+						uint32 packetDatasize = 0;
+						if (!deserializer.read(header.type, Packet::Type::FullMessage, Packet::Type::LastFragment)
+							|| (i == 0 && !deserializer.read(header.id))
+							|| (i != 0 && !deserializer.readVarUInt(idDistance, IdDistanceGroupBits, 18))
+							|| !deserializer.readVarUInt(packetDatasize, DataSizeGroupBits, 12)
+							|| packetsSize + Packet::HeaderSize + packetDatasize > Datagram::DataMaxSize)
+						{
+							return 0;
+						}
+						if (i != 0)
+							header.id = IdFromDistance(previousId, idDistance);
+						header.size = static_cast<uint16>(packetDatasize);
+						memcpy(packets + packetsSize, &header, Packet::HeaderSize);
+						previousId = header.id;
+						packetsSize += Packet::HeaderSize + header.size;
+					}
+					uint16 readSize = static_cast<uint16>(deserializer.bytesRead());
+					for (uint16 offset = 0; offset < packetsSize; )
+					{
+						Packet* const packet = reinterpret_cast<Packet*>(packets + offset);
+						if (readSize + packet->datasize() > datasize)
+							return 0;
+						memcpy(packet->data(), data + readSize, packet->datasize());
+						readSize += packet->datasize();
+						offset += packet->size();
+					}
+					return readSize;
+				}
+
+				BufferPool& PacketsPool()
+				{
+					thread_local const std::shared_ptr<BufferPool> pool = BufferPool::Create(Datagram::DataMaxSize);
+					return *pool;
+				}
+			}
+
 			ChannelsHandler::ChannelsHandler() = default;
 			ChannelsHandler::~ChannelsHandler() = default;
 
@@ -23,25 +147,21 @@ namespace Bousk
 			}
 			uint16 ChannelsHandler::serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId)
 			{
+				assert(buffersize <= Datagram::DataMaxSize);
+				std::array<uint8, Datagram::DataMaxSize> packets;
 				uint16 remainingBuffersize = buffersize;
-				for (uint32 channelId = 0; channelId < mChannels.size(); ++channelId)
+				for (uint32 channelId = 0; channelId < mChannels.size() && remainingBuffersize > ChannelHeader::Size; ++channelId)
 				{
 					Protocols::IProtocol* protocol = mChannels[channelId].get();
 
-					uint8* const channelHeaderStart = buffer;
-					uint8* const channelDataStart = buffer + ChannelHeader::Size;
+					//!< Room is reserved as if packets and channel header were sent as is : encoded, they take less
 					const uint16 channelAvailableSize = remainingBuffersize - ChannelHeader::Size;
-
-					const uint16 serializedData = protocol->serialize(channelDataStart, channelAvailableSize, datagramId);
+					const uint16 serializedData = protocol->serialize(packets.data(), channelAvailableSize, datagramId);
 					assert(serializedData <= channelAvailableSize);
 					if (serializedData)
 					{
-						// Data added, let's add the protocol header
-						ChannelHeader* const channelHeader = reinterpret_cast<ChannelHeader*>(channelHeaderStart);
-						channelHeader->channelId = channelId;
-						channelHeader->datasize = static_cast<uint32>(serializedData);
-
-						const uint16 channelTotalSize = serializedData + ChannelHeader::Size;
+						const uint16 channelTotalSize = EncodeChannel(channelId, packets.data(), serializedData, buffer);
+						assert(channelTotalSize <= serializedData + ChannelHeader::Size);
 						buffer += channelTotalSize;
 						remainingBuffersize -= channelTotalSize;
 					}
@@ -70,31 +190,39 @@ namespace Bousk
 				uint16 processedData = 0;
 				while (processedData < datasize)
 				{
-					const ChannelHeader* channelHeader = reinterpret_cast<const ChannelHeader*>(data);
-					if (processedData + channelHeader->datasize > datasize || channelHeader->datasize > Datagram::DataMaxSize)
+					//!< Packets are rebuilt in a pooled buffer : protocols deliver messages as views into it
+					BufferPool::Buffer packets = PacketsPool().acquire();
+					uint32 channelId = 0;
+					uint16 packetsSize = 0;
+					const uint16 channelTotalSize = DecodeChannel(data, datasize - processedData, channelId, packets.data(), packetsSize);
+					if (channelTotalSize == 0)
 					{
 						// Malformed buffer
 						return;
 					}
-					if (channelHeader->channelId >= mChannels.size())
+					if (channelId >= mChannels.size())
 					{
 						// Channel id requested doesn't exist
 						return;
 					}
-					mChannels[channelHeader->channelId]->onDataReceived(data + ChannelHeader::Size, channelHeader->datasize);
-					const uint16 channelTotalSize = channelHeader->datasize + ChannelHeader::Size;
+					mChannels[channelId]->onDataReceived(packets.data(), packetsSize, packets);
 					data += channelTotalSize;
 					processedData += channelTotalSize;
 				}
 			}
-			std::vector<std::vector<uint8>> ChannelsHandler::process(bool isConnected)
+			std::vector<Payload> ChannelsHandler::process(bool isConnected)
 			{
-				std::vector<std::vector<uint8>> messages;
+				std::vector<Payload> messages;
 				for (auto& channel : mChannels)
 				{
-					std::vector<std::vector<uint8>> protocolMessages = channel->process();
+					std::vector<Payload> protocolMessages = channel->process();
 					if (!protocolMessages.empty() && (channel->isReliable() || isConnected))
 					{
+						if (messages.empty())
+						{
+							messages = std::move(protocolMessages);
+							continue;
+						}
 						messages.reserve(messages.size() + protocolMessages.size());
 						messages.insert(messages.end(), std::make_move_iterator(protocolMessages.begin()), std::make_move_iterator(protocolMessages.end()));
 					}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <UDP/Datagram.hpp>
+#include <BufferPool.hpp>
+#include <Payload.hpp>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace Bousk
@@ -22,8 +25,9 @@ namespace Bousk
 				ChannelsHandler();
 				~ChannelsHandler();
 
-				template<class T>
-				void registerChannel();
+				// Channel of type T, built with the given arguments
+				template<class T, class... Args>
+				void registerChannel(Args&&... args);
 
 				// Multiplexer
 				void queue(std::vector<uint8>&& msgData, uint32 channelIndex);
@@ -33,17 +37,18 @@ namespace Bousk
 				void onDatagramLost(Datagram::ID datagramId);
 
 				// Demultiplexer
+				// Channels are decoded into pooled buffers, their messages are delivered as views into them
 				void onDataReceived(const uint8* data, uint16 datasize);
-				std::vector<std::vector<uint8>> process(bool isConnected);
+				std::vector<Payload> process(bool isConnected);
 
 			private:
 				std::vector<std::unique_ptr<Protocols::IProtocol>> mChannels;
 			};
 
-			template<class T>
-			void ChannelsHandler::registerChannel()
+			template<class T, class... Args>
+			void ChannelsHandler::registerChannel(Args&&... args)
 			{
-				mChannels.push_back(std::make_unique<T>());
+				mChannels.push_back(std::make_unique<T>(std::forward<Args>(args)...));
 			}
 		}
 	}
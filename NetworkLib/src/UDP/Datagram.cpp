@@ -0,0 +1,109 @@
+#include <UDP/Datagram.hpp>
+#include <Serialization/Serializer.hpp>
+#include <Serialization/Deserializer.hpp>
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace
+			{
+				constexpr uint64 CompleteAcks = std::numeric_limits<uint64>::max();
+				constexpr uint8 MaskBits = 64;
+			}
+
+			uint16 Datagram::serialize(uint8* const buffer) const
+			{
+				Serialization::Serializer serializer;
+				serializer.write(WireVersion, static_cast<uint8>(0), MaxWireVersion);
+				serializer.write(header.type, Type::ConnectedData, Type::Disconnection);
+				serializer.write(header.id);
+				serializer.write(header.ack);
+				const bool completeAcks = (header.previousAcks == CompleteAcks);
+				serializer.write(completeAcks);
+				if (!completeAcks)
+				{
+					//!< A loss costs a few bits instead of the whole mask
+					std::array<uint8, MaxListedMissingAcks> missingAcks;
+					uint8 nbMissingAcks = 0;
+					for (uint8 bit = 0; bit < MaskBits && nbMissingAcks <= MaxListedMissingAcks; ++bit)
+					{
+						if ((header.previousAcks & (uint64(1) << bit)) == 0)
+						{
+							if (nbMissingAcks < MaxListedMissingAcks)
+								missingAcks[nbMissingAcks] = bit;
+							++nbMissingAcks;
+						}
+					}
+					serializer.write(nbMissingAcks, static_cast<uint8>(1), static_cast<uint8>(MaxListedMissingAcks + 1));
+					if (nbMissingAcks <= MaxListedMissingAcks)
+					{
+						for (uint8 i = 0; i < nbMissingAcks; ++i)
+							serializer.write(missingAcks[i], static_cast<uint8>(0), static_cast<uint8>(MaskBits - 1));
+					}
+					else
+					{
+						serializer.write(header.previousAcks);
+					}
+				}
+
+				const uint16 headerSize = static_cast<uint16>(serializer.bufferSize());
+				memcpy(buffer, serializer.buffer(), headerSize);
+				memcpy(buffer + headerSize, data.data(), datasize);
+				return headerSize + datasize;
+			}
+			bool Datagram::deserialize(const uint16 receivedSize)
+			{
+				const uint8* const received = reinterpret_cast<const uint8*>(this);
+				Serialization::Deserializer deserializer(received, receivedSize);
+				uint8 version = 0;
+				Header decoded;
+				bool completeAcks = false;
+				if (!deserializer.read(version, static_cast<uint8>(0), MaxWireVersion) || version != WireVersion
+					|| !deserializer.read(decoded.type, Type::ConnectedData, Type::Disconnection)
+					|| !deserializer.read(decoded.id)
+					|| !deserializer.read(decoded.ack)
+					|| !deserializer.read(completeAcks))
+				{
+					return false;
+				}
+				decoded.previousAcks = CompleteAcks;
+				if (!completeAcks)
+				{
+					uint8 nbMissingAcks = 0;
+					if (!deserializer.read(nbMissingAcks, static_cast<uint8>(1), static_cast<uint8>(MaxListedMissingAcks + 1)))
+						return false;
+					if (nbMissingAcks <= MaxListedMissingAcks)
+					{
+						for (uint8 i = 0; i < nbMissingAcks; ++i)
+						{
+							uint8 bit = 0;
+							if (!deserializer.read(bit, static_cast<uint8>(0), static_cast<uint8>(MaskBits - 1)))
+								return false;
+							decoded.previousAcks &= ~(uint64(1) << bit);
+						}
+					}
+					else if (!deserializer.read(decoded.previousAcks))
+					{
+						return false;
+					}
+				}
+
+				const uint16 headerSize = static_cast<uint16>(deserializer.bytesRead());
+				if (receivedSize - headerSize > DataMaxSize)
+					return false;
+				//!< The header decoded is larger than the one received : data moves behind it
+				datasize = receivedSize - headerSize;
+				memmove(data.data(), received + headerSize, datasize);
+				header = decoded;
+				return true;
+			}
+		}
+	}
+}
@@ -10,6 +10,12 @@ namespace Bousk
 	{
 		namespace UDP
 		{
+			/*
+			Datagrams are sent with a compact header, bit packed with the Serializer : wire version, type, id and ack, then the mask of previous acks.
+			That mask is omitted while it's complete, which is the case most of the time : on a link without loss, the mask doesn't change from a datagram to the next.
+			Missing acks are listed while there are a few of them, the whole mask is sent otherwise.
+			The receiving end drops datagrams of another wire version.
+			*/
 			struct Datagram
 			{
 				using ID = uint16;
@@ -18,6 +24,9 @@ namespace Bousk
 					KeepAlive,
 					Disconnection,
 				};
+				static constexpr uint8 WireVersion = 2;
+				static constexpr uint8 MaxWireVersion = 7;
+				static constexpr uint8 MaxListedMissingAcks = 6;
 				struct Header
 				{
 					ID id;
@@ -26,16 +35,22 @@ namespace Bousk
 					Type type;
 				};
 				static constexpr uint16 BufferMaxSize = 1400;
-				static constexpr uint16 HeaderSize = sizeof(Header);
-				static constexpr uint16 DataMaxSize = BufferMaxSize - HeaderSize;
+				//!< Wire version 3 bits, type 2 bits, id and ack 16 bits each, complete mask flag, number of missing acks 3 bits, then their 6 bits indices or the 64 bits mask
+				static constexpr uint16 HeaderMinSize = (3 + 2 + 16 + 16 + 1 + 7) / 8;
+				static constexpr uint16 HeaderMaxSize = (3 + 2 + 16 + 16 + 1 + 3 + 64 + 7) / 8;
+				static constexpr uint16 DataMaxSize = BufferMaxSize - HeaderMaxSize;
 
 				Header header;
 				std::array<uint8, DataMaxSize> data;
 
 				// Not serialized
 				uint16 datasize{ 0 };
-				//!< Datagram full size : Header + data
-				uint16 size() const { return HeaderSize + datasize; }
+
+				// Write the header then the data to buffer, which must hold BufferMaxSize bytes. Returns the size written
+				uint16 serialize(uint8* buffer) const;
+				// This datagram holds the receivedSize bytes of a datagram received : decode its header in place, the data is moved behind it
+				// Returns false if the datagram is malformed or from another wire version
+				bool deserialize(uint16 receivedSize);
 			};
 		}
 	}
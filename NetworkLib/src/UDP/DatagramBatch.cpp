@@ -0,0 +1,376 @@
+#include <UDP/DatagramBatch.hpp>
+#include <Errors.hpp>
+#include <Utils.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			ReceiveBatch::ReceiveBatch()
+				: mPool(BufferPool::Create(sizeof(Datagram)))
+				, mBuffers(MaxSize)
+				, mAddresses(MaxSize)
+				, mReceivedSizes(MaxSize, 0)
+			{
+			#ifdef BOUSKNET_HAS_MMSG
+				mIovecs.resize(MaxSize);
+				mHeaders.resize(MaxSize);
+				memset(mHeaders.data(), 0, mHeaders.size() * sizeof(mmsghdr));
+				for (size_t i = 0; i < MaxSize; ++i)
+				{
+					mIovecs[i].iov_len = Datagram::BufferMaxSize;
+					msghdr& hdr = mHeaders[i].msg_hdr;
+					hdr.msg_name = &mAddresses[i];
+					hdr.msg_iov = &mIovecs[i];
+					hdr.msg_iovlen = 1;
+				}
+			#endif // BOUSKNET_HAS_MMSG
+			}
+
+			bool ReceiveBatch::setCoalescing(SOCKET sckt, const bool enable)
+			{
+				mCoalescing = false;
+			#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+				const int optval = enable ? 1 : 0;
+				if (setsockopt(sckt, SOL_UDP, UDP_GRO, &optval, sizeof(optval)) != 0 || !enable)
+					return false;
+				mCoalescedBuffers.resize(CoalescedMaxSize * CoalescedBufferSize);
+				mCoalescedAddresses.resize(CoalescedMaxSize);
+				mCoalescedIovecs.resize(CoalescedMaxSize);
+				mCoalescedHeaders.resize(CoalescedMaxSize);
+				mCoalescedControls.resize(CoalescedMaxSize);
+				memset(mCoalescedHeaders.data(), 0, mCoalescedHeaders.size() * sizeof(mmsghdr));
+				for (size_t i = 0; i < CoalescedMaxSize; ++i)
+				{
+					mCoalescedIovecs[i].iov_base = mCoalescedBuffers.data() + i * CoalescedBufferSize;
+					mCoalescedIovecs[i].iov_len = CoalescedBufferSize;
+					msghdr& hdr = mCoalescedHeaders[i].msg_hdr;
+					hdr.msg_name = &mCoalescedAddresses[i];
+					hdr.msg_iov = &mCoalescedIovecs[i];
+					hdr.msg_iovlen = 1;
+					hdr.msg_control = mCoalescedControls[i].buffer;
+				}
+				mCoalescing = true;
+				return true;
+			#else
+				UNUSED(sckt);
+				UNUSED(enable);
+				return false;
+			#endif // BOUSKNET_HAS_UDP_OFFLOAD
+			}
+
+			int ReceiveBatch::receive(SOCKET sckt)
+			{
+			#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+				if (mCoalescing)
+					return receiveCoalesced(sckt);
+			#endif // BOUSKNET_HAS_UDP_OFFLOAD
+				mSocketDrained = true;
+			#ifdef BOUSKNET_HAS_MMSG
+				for (size_t i = 0; i < MaxSize; ++i)
+					prepare(i);
+				//!< Address lengths are updated by the system call, so reset them each time
+				for (mmsghdr& header : mHeaders)
+					header.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+				const int ret = recvmmsg(sckt, mHeaders.data(), static_cast<unsigned int>(MaxSize), MSG_DONTWAIT, nullptr);
+				if (ret <= 0)
+					return ret;
+				for (int i = 0; i < ret; ++i)
+				{
+					mReceivedSizes[i] = static_cast<uint16>(mHeaders[i].msg_len);
+				}
+				const int nbReceived = ret;
+			#else
+				int nbReceived = 0;
+				for (; nbReceived < static_cast<int>(MaxSize); ++nbReceived)
+				{
+					prepare(nbReceived);
+					sockaddr_storage& from = mAddresses[nbReceived];
+					socklen_t fromlen = sizeof(from);
+					const int ret = recvfrom(sckt, reinterpret_cast<char*>(&datagram(nbReceived)), Datagram::BufferMaxSize, 0, reinterpret_cast<sockaddr*>(&from), &fromlen);
+					if (ret < 0)
+					{
+						if (nbReceived == 0)
+							return ret;
+						//!< Report the error with next call, return what we already have
+						break;
+					}
+					mReceivedSizes[nbReceived] = static_cast<uint16>(ret);
+				}
+				if (nbReceived == 0)
+					return 0;
+			#endif // BOUSKNET_HAS_MMSG
+				mSocketDrained = nbReceived < static_cast<int>(MaxSize);
+				++mNbBatches;
+				mNbDatagrams += nbReceived;
+				return nbReceived;
+			}
+		#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+			int ReceiveBatch::receiveCoalesced(SOCKET sckt)
+			{
+				mSocketDrained = true;
+				//!< Lengths are updated by the system call, so reset them each time
+				for (mmsghdr& header : mCoalescedHeaders)
+				{
+					header.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+					header.msg_hdr.msg_controllen = sizeof(ControlBuffer);
+				}
+				const int ret = recvmmsg(sckt, mCoalescedHeaders.data(), static_cast<unsigned int>(CoalescedMaxSize), MSG_DONTWAIT, nullptr);
+				if (ret <= 0)
+					return ret;
+
+				//!< Split each buffer back into datagrams
+				size_t nbDatagrams = 0;
+				for (int i = 0; i < ret; ++i)
+				{
+					msghdr& hdr = mCoalescedHeaders[i].msg_hdr;
+					const uint8* const buffer = static_cast<const uint8*>(mCoalescedIovecs[i].iov_base);
+					const size_t bufferSize = mCoalescedHeaders[i].msg_len;
+					//!< Without segment size information, the buffer holds a single datagram
+					size_t segmentSize = bufferSize;
+					for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+					{
+						if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+						{
+							int gsoSize = 0;
+							memcpy(&gsoSize, CMSG_DATA(cmsg), sizeof(gsoSize));
+							if (gsoSize > 0)
+								segmentSize = static_cast<size_t>(gsoSize);
+						}
+					}
+					for (size_t offset = 0; offset < bufferSize || (bufferSize == 0 && offset == 0); offset += segmentSize)
+					{
+						if (nbDatagrams == mBuffers.size())
+							grow(mBuffers.size() + MaxSize);
+						prepare(nbDatagrams);
+						const size_t datagramSize = std::min(segmentSize, bufferSize - offset);
+						//!< Bigger datagrams are truncated, as recvfrom would do
+						const size_t copySize = std::min(datagramSize, static_cast<size_t>(Datagram::BufferMaxSize));
+						memcpy(&datagram(nbDatagrams), buffer + offset, copySize);
+						mReceivedSizes[nbDatagrams] = static_cast<uint16>(copySize);
+						mAddresses[nbDatagrams] = mCoalescedAddresses[i];
+						++nbDatagrams;
+						if (segmentSize == 0)
+							break;
+					}
+				}
+				mSocketDrained = ret < static_cast<int>(CoalescedMaxSize);
+				++mNbBatches;
+				mNbDatagrams += nbDatagrams;
+				return static_cast<int>(nbDatagrams);
+			}
+			void ReceiveBatch::grow(const size_t nbDatagrams)
+			{
+				mBuffers.resize(nbDatagrams);
+				mAddresses.resize(nbDatagrams);
+				mReceivedSizes.resize(nbDatagrams, 0);
+				//!< Addresses moved : update the regular batch to point to their new location
+				for (size_t i = 0; i < MaxSize; ++i)
+				{
+					mHeaders[i].msg_hdr.msg_name = &mAddresses[i];
+				}
+			}
+		#endif // BOUSKNET_HAS_UDP_OFFLOAD
+			void ReceiveBatch::prepare(const size_t index)
+			{
+				BufferPool::Buffer& buffer = mBuffers[index];
+				if (buffer.unique())
+					return;
+				buffer = mPool->acquire();
+			#ifdef BOUSKNET_HAS_MMSG
+				if (index < MaxSize)
+					mIovecs[index].iov_base = buffer.data();
+			#endif // BOUSKNET_HAS_MMSG
+			}
+
+			bool SendBatch::setSegmentation(SOCKET sckt, const bool enable)
+			{
+				mSegmentation = false;
+			#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+				//!< Setting a null segment size is accepted by systems supporting it, and does not segment datagrams sent without explicit size
+				const int segmentSize = 0;
+				mSegmentation = enable && setsockopt(sckt, SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize)) == 0;
+				return mSegmentation;
+			#else
+				UNUSED(sckt);
+				UNUSED(enable);
+				return false;
+			#endif // BOUSKNET_HAS_UDP_OFFLOAD
+			}
+			bool SendBatch::queue(const Datagram& dgram, const sockaddr_storage& target)
+			{
+				if (size() >= MaxQueueSize)
+				{
+					++mNbDatagramsDropped;
+					return false;
+				}
+				Entry entry;
+				entry.target = target;
+				entry.offset = mBuffer.size();
+				mBuffer.resize(entry.offset + Datagram::BufferMaxSize);
+				entry.size = dgram.serialize(mBuffer.data() + entry.offset);
+				mBuffer.resize(entry.offset + entry.size);
+				mEntries.push_back(entry);
+				return true;
+			}
+			size_t SendBatch::flush(SOCKET sckt)
+			{
+				size_t nbSent = 0;
+			#ifdef BOUSKNET_HAS_MMSG
+				while (!empty())
+				{
+					//!< Build messages : a single datagram each, or a segmented buffer of several datagrams
+					const size_t maxEntries = std::min(size(), MaxMessagesPerCall * (mSegmentation ? MaxSegments : 1));
+					if (mIovecs.size() < maxEntries)
+						mIovecs.resize(maxEntries);
+					mMessagesEntries.clear();
+					size_t nbEntries = 0;
+					while (nbEntries < maxEntries && mMessagesEntries.size() < MaxMessagesPerCall)
+					{
+						const size_t firstEntry = mFirstEntry + nbEntries;
+						const size_t messageEntries = mSegmentation ? std::min(segmentableEntries(firstEntry), maxEntries - nbEntries) : 1;
+						for (size_t i = 0; i < messageEntries; ++i)
+						{
+							const Entry& entry = mEntries[firstEntry + i];
+							mIovecs[nbEntries + i].iov_base = mBuffer.data() + entry.offset;
+							mIovecs[nbEntries + i].iov_len = entry.size;
+						}
+						nbEntries += messageEntries;
+						mMessagesEntries.push_back(messageEntries);
+					}
+					const size_t nbMessages = mMessagesEntries.size();
+					if (mHeaders.size() < nbMessages)
+						mHeaders.resize(nbMessages);
+				#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+					if (mSegmentation && mControls.size() < nbMessages)
+						mControls.resize(nbMessages);
+				#endif // BOUSKNET_HAS_UDP_OFFLOAD
+					for (size_t i = 0, entryIndex = 0; i < nbMessages; entryIndex += mMessagesEntries[i], ++i)
+					{
+						Entry& entry = mEntries[mFirstEntry + entryIndex];
+						mHeaders[i] = mmsghdr{};
+						msghdr& hdr = mHeaders[i].msg_hdr;
+						hdr.msg_name = &entry.target;
+						hdr.msg_namelen = sizeof(entry.target);
+						hdr.msg_iov = &mIovecs[entryIndex];
+						hdr.msg_iovlen = mMessagesEntries[i];
+					#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+						if (mMessagesEntries[i] > 1)
+						{
+							//!< Let the system split the buffer into datagrams of the first one size
+							hdr.msg_control = mControls[i].buffer;
+							hdr.msg_controllen = sizeof(ControlBuffer);
+							cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+							cmsg->cmsg_level = SOL_UDP;
+							cmsg->cmsg_type = UDP_SEGMENT;
+							cmsg->cmsg_len = CMSG_LEN(sizeof(uint16));
+							const uint16 segmentSize = entry.size;
+							memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+						}
+					#endif // BOUSKNET_HAS_UDP_OFFLOAD
+					}
+					++mNbSystemCalls;
+					const int ret = sendmmsg(sckt, mHeaders.data(), static_cast<unsigned int>(nbMessages), 0);
+					if (ret < 0)
+					{
+						const int err = Errors::Get();
+						if (err == Errors::WOULDBLOCK)
+							break; //!< Socket buffer is full, try again next time
+						if (mSegmentation && mMessagesEntries[0] > 1 && (err == EIO || err == EINVAL))
+						{
+							//!< The system or the network interface refuses segmentation after all : fall back to regular datagrams
+							mSegmentation = false;
+							continue;
+						}
+						onEntryFailed();
+						continue;
+					}
+					for (int i = 0; i < ret; ++i)
+					{
+						onEntriesSent(mMessagesEntries[i]);
+						nbSent += mMessagesEntries[i];
+					}
+					if (static_cast<size_t>(ret) < nbMessages)
+						break; //!< Socket buffer is full, or next message will report an error on next call
+				}
+			#else
+				while (!empty())
+				{
+					const Entry& entry = mEntries[mFirstEntry];
+					++mNbSystemCalls;
+					const int ret = sendto(sckt, reinterpret_cast<const char*>(mBuffer.data() + entry.offset), static_cast<int>(entry.size), 0, reinterpret_cast<const sockaddr*>(&entry.target), sizeof(entry.target));
+					if (ret < 0)
+					{
+						if (Errors::Get() == Errors::WOULDBLOCK)
+							break; //!< Socket buffer is full, try again next time
+						onEntryFailed();
+						continue;
+					}
+					onEntriesSent(1);
+					++nbSent;
+				}
+			#endif // BOUSKNET_HAS_MMSG
+
+				compact();
+				return nbSent;
+			}
+			void SendBatch::clear()
+			{
+				//!< Keep capacity for next frame
+				mEntries.clear();
+				mBuffer.clear();
+				mFirstEntry = 0;
+			}
+			void SendBatch::compact()
+			{
+				if (empty())
+				{
+					clear();
+					return;
+				}
+				if (mFirstEntry == 0)
+					return;
+				const size_t sentDataSize = mEntries[mFirstEntry].offset;
+				mBuffer.erase(mBuffer.begin(), mBuffer.begin() + sentDataSize);
+				mEntries.erase(mEntries.begin(), mEntries.begin() + mFirstEntry);
+				for (Entry& entry : mEntries)
+					entry.offset -= sentDataSize;
+				mFirstEntry = 0;
+			}
+			void SendBatch::onEntriesSent(const size_t count)
+			{
+				mFirstEntry += count;
+				mNbDatagramsSent += count;
+			}
+			void SendBatch::onEntryFailed()
+			{
+				//!< Drop it, as if lost on the network
+				++mFirstEntry;
+				++mNbDatagramsDropped;
+			}
+			size_t SendBatch::segmentableEntries(const size_t firstEntry) const
+			{
+				const Entry& first = mEntries[firstEntry];
+				size_t count = 1;
+				size_t totalSize = first.size;
+				for (size_t i = firstEntry + 1; i < mEntries.size() && count < MaxSegments; ++i)
+				{
+					const Entry& entry = mEntries[i];
+					//!< Segments share the same target, and all have the size of the first one except the last one which can be smaller
+					if (entry.size > first.size || totalSize + entry.size > MaxSegmentedSize || memcmp(&entry.target, &first.target, sizeof(first.target)) != 0)
+						break;
+					++count;
+					totalSize += entry.size;
+					if (entry.size < first.size)
+						break;
+				}
+				return count;
+			}
+		}
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <UDP/Datagram.hpp>
+#include <BufferPool.hpp>
+#include <Settings.hpp>
+#include <Sockets.hpp>
+#include <Types.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			/*
+			Preallocated datagrams and source addresses, filled from the socket with as few system calls as possible.
+			Uses recvmmsg when the platform supports it, otherwise falls back to one recvfrom per datagram into the same buffers.
+			With coalescing enabled (UDP GRO), the system may merge datagrams from a same sender into bigger buffers which are split back into datagrams.
+			Datagrams are received into pooled buffers : holding a buffer keeps its datagram alive after next call to receive, which then uses another buffer.
+			*/
+			class ReceiveBatch
+			{
+			public:
+				static constexpr size_t MaxSize = BOUSKNET_UDP_RECEIVE_BATCH_SIZE;
+				//!< Coalesced buffers pulled per system call : each of them can hold up to 64 datagrams
+				static constexpr size_t CoalescedMaxSize = 4;
+				static constexpr size_t CoalescedBufferSize = 65535;
+
+			public:
+				ReceiveBatch();
+				ReceiveBatch(const ReceiveBatch&) = delete;
+				ReceiveBatch& operator=(const ReceiveBatch&) = delete;
+				~ReceiveBatch() = default;
+
+				// Enable or disable UDP generic receive offload on the socket
+				// Returns whether it's enabled : if the system doesn't support it, datagrams keep being received one by one
+				bool setCoalescing(SOCKET sckt, bool enable);
+				bool isCoalescingEnabled() const { return mCoalescing; }
+
+				// Pull up to MaxSize datagrams from the socket, or CoalescedMaxSize buffers if coalescing is enabled
+				// Returns the number of datagrams received, or SOCKET_ERROR if none could be read (use Errors::Get for details)
+				int receive(SOCKET sckt);
+				// Whether last call to receive emptied the socket
+				bool isSocketDrained() const { return mSocketDrained; }
+
+				// Raw size received from the network, header included
+				uint16 receivedSize(size_t index) const { return mReceivedSizes[index]; }
+				Datagram& datagram(size_t index) { return mBuffers[index].as<Datagram>(); }
+				// Pooled buffer holding the datagram
+				const BufferPool::Buffer& buffer(size_t index) const { return mBuffers[index]; }
+				// Owner thread only
+				BufferPool& pool() { return *mPool; }
+				const sockaddr_storage& from(size_t index) const { return mAddresses[index]; }
+
+				// Statistics : number of system calls which returned data, and the number of datagrams they returned
+				uint64 nbBatches() const { return mNbBatches; }
+				uint64 nbDatagrams() const { return mNbDatagrams; }
+				float averageSize() const { return mNbBatches ? static_cast<float>(mNbDatagrams) / mNbBatches : 0.f; }
+
+			private:
+				//!< Make sure the buffer at index can be overwritten : swap it for a new one if it's still held outside
+				void prepare(size_t index);
+
+			private:
+				std::shared_ptr<BufferPool> mPool;
+				std::vector<BufferPool::Buffer> mBuffers;
+				std::vector<sockaddr_storage> mAddresses;
+				std::vector<uint16> mReceivedSizes;
+			#ifdef BOUSKNET_HAS_MMSG
+				std::vector<iovec> mIovecs;
+				std::vector<mmsghdr> mHeaders;
+			#endif // BOUSKNET_HAS_MMSG
+			#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+				int receiveCoalesced(SOCKET sckt);
+				//!< Make room for more datagrams, since a coalesced batch can hold more than MaxSize of them
+				void grow(size_t nbDatagrams);
+
+				union ControlBuffer
+				{
+					cmsghdr header;
+					uint8 buffer[CMSG_SPACE(sizeof(int))];
+				};
+				std::vector<uint8> mCoalescedBuffers;
+				std::vector<sockaddr_storage> mCoalescedAddresses;
+				std::vector<iovec> mCoalescedIovecs;
+				std::vector<mmsghdr> mCoalescedHeaders;
+				std::vector<ControlBuffer> mCoalescedControls;
+			#endif // BOUSKNET_HAS_UDP_OFFLOAD
+				uint64 mNbBatches{ 0 };
+				uint64 mNbDatagrams{ 0 };
+				bool mCoalescing{ false };
+				bool mSocketDrained{ true };
+			};
+
+			/*
+			Outbound datagrams of a frame, for all distant clients, sent with as few system calls as possible.
+			Uses sendmmsg when the platform supports it, otherwise falls back to one sendto per datagram.
+			Datagrams the socket can't take yet (EAGAIN, partial send) remain queued for next flush.
+			With segmentation enabled (UDP GSO), consecutive datagrams to a same target are handed to the system as a single buffer.
+			*/
+			class SendBatch
+			{
+			public:
+				static constexpr size_t MaxQueueSize = BOUSKNET_UDP_SEND_QUEUE_MAX_SIZE;
+				//!< Limits of a single segmented buffer
+				static constexpr size_t MaxSegments = 64;
+				static constexpr size_t MaxSegmentedSize = 65507;
+
+			public:
+				SendBatch() = default;
+				SendBatch(const SendBatch&) = delete;
+				SendBatch& operator=(const SendBatch&) = delete;
+				~SendBatch() = default;
+
+				// Enable or disable UDP generic segmentation offload on the socket
+				// Returns whether it's enabled : if the system doesn't support it, datagrams keep being sent one by one
+				bool setSegmentation(SOCKET sckt, bool enable);
+				bool isSegmentationEnabled() const { return mSegmentation; }
+
+				// Copy the datagram into the queue
+				// Returns false if the queue is full : the datagram is dropped, as if lost on the network
+				bool queue(const Datagram& dgram, const sockaddr_storage& target);
+				// Send as many queued datagrams as possible
+				// Returns the number of datagrams sent
+				size_t flush(SOCKET sckt);
+				void clear();
+
+				size_t size() const { return mEntries.size() - mFirstEntry; }
+				bool empty() const { return size() == 0; }
+
+				// Statistics
+				uint64 nbSystemCalls() const { return mNbSystemCalls; }
+				uint64 nbDatagramsSent() const { return mNbDatagramsSent; }
+				uint64 nbDatagramsDropped() const { return mNbDatagramsDropped; }
+
+			private:
+				struct Entry
+				{
+					sockaddr_storage target;
+					size_t offset;
+					uint16 size;
+				};
+				//!< The system doesn't accept more than UIO_MAXIOV messages per call
+				static constexpr size_t MaxMessagesPerCall = 1024;
+				//!< Called once some entries have been handed to the system
+				void onEntriesSent(size_t count);
+				//!< Called once the first entry failed to be sent for another reason than a full socket buffer
+				void onEntryFailed();
+				//!< Number of queued entries, starting from the given one, which can be sent as a single segmented buffer
+				size_t segmentableEntries(size_t firstEntry) const;
+				//!< Drop entries sent, keeping the remainder at the front for next flush
+				void compact();
+
+			private:
+				std::vector<Entry> mEntries;
+				std::vector<uint8> mBuffer; //!< Datagrams data, contiguous to keep allocations low from frame to frame
+				size_t mFirstEntry{ 0 }; //!< First entry not sent yet
+			#ifdef BOUSKNET_HAS_MMSG
+				std::vector<iovec> mIovecs;
+				std::vector<mmsghdr> mHeaders;
+				std::vector<size_t> mMessagesEntries; //!< Number of entries sent by each message of the system call
+			#endif // BOUSKNET_HAS_MMSG
+			#ifdef BOUSKNET_HAS_UDP_OFFLOAD
+				union ControlBuffer
+				{
+					cmsghdr header;
+					uint8 buffer[CMSG_SPACE(sizeof(uint16))];
+				};
+				std::vector<ControlBuffer> mControls;
+			#endif // BOUSKNET_HAS_UDP_OFFLOAD
+				bool mSegmentation{ false };
+				uint64 mNbSystemCalls{ 0 };
+				uint64 mNbDatagramsSent{ 0 };
+				uint64 mNbDatagramsDropped{ 0 };
+			};
+		}
+	}
+}
@@ -3,12 +3,14 @@
 #include "UDP/Datagram.hpp"
 #include "Serialization/Serializer.hpp"
 #include "Serialization/Deserializer.hpp"
-#include "Messages.hpp"
+#include "Events.hpp"
 #include "Settings.hpp"
 #include "Utils.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <limits>
 
 namespace Bousk
 {
@@ -17,6 +19,12 @@ namespace Bousk
 		namespace UDP
 		{
 			std::chrono::milliseconds DistantClient::sTimeout = BOUSKNET_DEFAULT_UDP_TIMEOUT;
+			std::chrono::milliseconds DistantClient::sKeepAliveInterval = BOUSKNET_DEFAULT_UDP_KEEP_ALIVE_INTERVAL;
+			KeepAliveMode DistantClient::sKeepAliveMode = KeepAliveMode::Periodic;
+			std::chrono::milliseconds DistantClient::sMaxAckDelay = BOUSKNET_DEFAULT_UDP_MAX_ACK_DELAY;
+			uint8 DistantClient::sAckFrequency = BOUSKNET_DEFAULT_UDP_ACK_FREQUENCY;
+			std::chrono::milliseconds DistantClient::sCoalescingMaxDelay = BOUSKNET_DEFAULT_UDP_COALESCING_MAX_DELAY;
+			uint16 DistantClient::sCoalescingFillThreshold = BOUSKNET_DEFAULT_UDP_COALESCING_FILL_THRESHOLD;
 
 			DistantClient::DistantClient(Client& client, const Address& addr, uint64 clientid)
 				: mClient(client)
@@ -24,12 +32,14 @@ namespace Bousk
 				, mClientId(clientid)
 				, mConnectionStartTime(Utils::Now())
 				, mLastKeepAlive(Utils::Now())
+				, mLastDatagramSent(Utils::Now())
 			{}
 			void DistantClient::onConnectionSent()
 			{
 				if (mState == State::None)
 				{
 					mState = State::ConnectionSent;
+					mKeepAliveNeeded = true;
 					maintainConnection();
 				}
 				else if (mState == State::ConnectionReceived)
@@ -43,9 +53,10 @@ namespace Bousk
 				if (mState == State::None)
 				{
 					mState = State::ConnectionReceived;
+					mKeepAliveNeeded = true;
 					maintainConnection();
 					// Push incoming connection request to client
-					mClient.onMessageReady(std::make_unique<Messages::IncomingConnection>(mAddress, mClientId));
+					mClient.onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::IncomingConnection>{}));
 				}
 				else if (mState == State::ConnectionSent)
 				{
@@ -60,8 +71,9 @@ namespace Bousk
 			void DistantClient::onConnected()
 			{
 				mState = State::Connected;
+				mKeepAliveNeeded = true;
 				maintainConnection();
-				onMessageReady(std::make_unique<Messages::Connection>(mAddress, mClientId, Messages::Connection::Result::Success));
+				onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::Connection>{ Messages::Connection::Result::Success }));
 				// Dispatch pending messages now
 				for (auto&& pendingMessage : mPendingMessages)
 				{
@@ -116,28 +128,33 @@ namespace Bousk
 				// when receiving packets from the other end right after disconnecting locally
 				mDisconnectionReason = DisconnectionReason::Disconnected;
 				mState = State::Disconnecting;
+				mKeepAliveNeeded = true;
 			}
 			void DistantClient::send(std::vector<uint8>&& data, uint32 channelIndex)
 			{
 				// If we're sending data, we're requesting a connection
 				onConnectionSent();
+				if (mNbBytesQueued == 0)
+					mCoalescingDeadline = Utils::Now() + sCoalescingMaxDelay;
+				mNbBytesQueued += static_cast<uint32>(data.size());
 				mChannelsHandler.queue(std::move(data), channelIndex);
 			}
 			void DistantClient::fillDatagramHeader(Datagram& dgram, Datagram::Type type)
 			{
-				dgram.header.ack = htons(mReceivedAcks.lastAck());
+				dgram.header.ack = mReceivedAcks.lastAck();
 				dgram.header.previousAcks = mReceivedAcks.previousAcksMask();
-				dgram.header.id = htons(mNextDatagramIdToSend);
+				dgram.header.id = mNextDatagramIdToSend;
 				dgram.header.type = type;
 				++mNextDatagramIdToSend;
 			}
 			void DistantClient::send(const Datagram& dgram)
 			{
-				int ret = mAddress.sendTo(mClient.mSocket, reinterpret_cast<const char*>(&dgram), dgram.size());
-				if (ret < 0)
-				{
-					// Error
-				}
+				//!< Datagrams of all clients are sent at once at the end of Client::processSend
+				mClient.mSendBatch.queue(dgram, mAddress.storage());
+				mLastDatagramSent = Utils::Now();
+				mKeepAliveNeeded = false;
+				//!< Every datagram carries the acks
+				mNbDatagramsToAck = 0;
 			}
 			void DistantClient::processSend(const uint8 maxDatagrams /*= 0*/)
 			{
@@ -145,23 +162,31 @@ namespace Bousk
 				// We do send data during connection process in order to keep it available before we accept it
 				if (isConnecting() || isConnected())
 				{
-					for (size_t loop = 0; maxDatagrams == 0 || loop < maxDatagrams; ++loop)
+					checkRetransmissionTimeout(now);
+					if (mNbDatagramsToAck > 0 && now >= mAckDeadline)
+						mKeepAliveNeeded = true;
+					//!< Partly filled datagrams wait for more messages
+					const bool coalescing = isCoalescing(now);
+					for (size_t loop = 0; !coalescing && (maxDatagrams == 0 || loop < maxDatagrams); ++loop)
 					{
 						Datagram datagram;
 						datagram.datasize = mChannelsHandler.serialize(datagram.data.data(), Datagram::DataMaxSize, mNextDatagramIdToSend);
 						if (datagram.datasize > 0)
 						{
+							mDataInFlight.push_back({ mNextDatagramIdToSend, now });
 							fillDatagramHeader(datagram, Datagram::Type::ConnectedData);
 							send(datagram);
 						}
 						else
 						{
-							if (loop == 0)
+							if (loop == 0 && (mKeepAliveNeeded || isKeepAliveDue(now)))
 							{
-								// Nothing to send this time, so send a keep alive to maintain connection
+								// Nothing to send this time, so send a keep alive to maintain connection and acknowledge received datagrams
 								fillKeepAlive(datagram);
 								send(datagram);
 							}
+							mNbBytesQueued = 0;
+							mFlushRequested = false;
 							break;
 						}
 					}
@@ -179,22 +204,24 @@ namespace Bousk
 						{
 							case DisconnectionReason::Disconnected:
 							case DisconnectionReason::DisconnectedFromOtherEnd:
-								mClient.onMessageReady(std::make_unique<Messages::Disconnection>(mAddress, mClientId, Messages::Disconnection::Reason::Disconnected));
+								mClient.onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::Disconnection>{ Messages::Disconnection::Reason::Disconnected }));
 								break;
 							case DisconnectionReason::Lost:
-								mClient.onMessageReady(std::make_unique<Messages::Disconnection>(mAddress, mClientId, Messages::Disconnection::Reason::Lost));
+								mClient.onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::Disconnection>{ Messages::Disconnection::Reason::Lost }));
 								break;
 							case DisconnectionReason::Refused:
-								mClient.onMessageReady(std::make_unique<Messages::Connection>(mAddress, mClientId, Messages::Connection::Result::Refused));
+								mClient.onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::Connection>{ Messages::Connection::Result::Refused }));
 								break;
 							case DisconnectionReason::ConnectionTimedOut:
-								mClient.onMessageReady(std::make_unique<Messages::Connection>(mAddress, mClientId, Messages::Connection::Result::TimedOut));
+								mClient.onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::Connection>{ Messages::Connection::Result::TimedOut }));
 								break;
 						}
 					}
-					else if (mDisconnectionReason != DisconnectionReason::None && mDisconnectionReason != DisconnectionReason::Lost)
+					else if (mDisconnectionReason != DisconnectionReason::None && mDisconnectionReason != DisconnectionReason::Lost
+						&& (mKeepAliveNeeded || now >= mLastDatagramSent + sKeepAliveInterval))
 					{
 						// Send disconnection datagrams while disconnecting to inform the other end that's a normal termination
+						// The first one right away, then at keep alive pace
 						Datagram datagram;
 						fillDatagramHeader(datagram, Datagram::Type::Disconnection);
 						send(datagram);
@@ -210,35 +237,89 @@ namespace Bousk
 					onConnectionTimedOut();
 				}
 			}
+			std::chrono::milliseconds DistantClient::nextDeadline() const
+			{
+				if (mKeepAliveNeeded && (isConnecting() || isConnected()))
+					return mLastDatagramSent;
+				//!< Data in flight is considered lost once the retransmission timeout of the oldest one is reached
+				const std::chrono::milliseconds retransmission = mDataInFlight.empty() ? std::chrono::milliseconds::max() : mDataInFlight.front().sentTime + mRoundTripTime.retransmissionTimeout();
+				const std::chrono::milliseconds ack = (mNbDatagramsToAck > 0) ? mAckDeadline : std::chrono::milliseconds::max();
+				const std::chrono::milliseconds coalescing = (mNbBytesQueued > 0) ? mCoalescingDeadline : std::chrono::milliseconds::max();
+				if (isConnecting())
+					return std::min({ mConnectionStartTime + GetTimeout(), mLastDatagramSent + sKeepAliveInterval, retransmission, ack, coalescing });
+				if (isConnected())
+				{
+					if (sKeepAliveMode == KeepAliveMode::AckOnly && mDataInFlight.empty())
+						return std::min({ mLastKeepAlive + GetTimeout(), ack, coalescing });
+					return std::min({ mLastKeepAlive + GetTimeout(), mLastDatagramSent + sKeepAliveInterval, retransmission, ack, coalescing });
+				}
+				if (isDisconnecting())
+				{
+					//!< Disconnection datagrams are only sent for a normal termination
+					if (mDisconnectionReason != DisconnectionReason::None && mDisconnectionReason != DisconnectionReason::Lost)
+						return mKeepAliveNeeded ? mLastDatagramSent : std::min(mLastKeepAlive + 2 * GetTimeout(), mLastDatagramSent + sKeepAliveInterval);
+					return mLastKeepAlive + 2 * GetTimeout();
+				}
+				return std::chrono::milliseconds::max();
+			}
+			bool DistantClient::isKeepAliveDue(const std::chrono::milliseconds now) const
+			{
+				//!< Connecting ends keep sending them whatever the mode : the handshake must survive losses
+				//!< A connected end waiting for the ack of its data keeps sending them too : if that data was lost, nothing else would let it know
+				if (isConnected() && sKeepAliveMode == KeepAliveMode::AckOnly && mDataInFlight.empty())
+					return false;
+				return now >= mLastDatagramSent + sKeepAliveInterval;
+			}
+			bool DistantClient::isCoalescing(const std::chrono::milliseconds now) const
+			{
+				//!< Messages sent again after a loss are held with the new ones : without new ones, they're sent right away
+				if (mNbBytesQueued == 0 || mNbBytesQueued >= sCoalescingFillThreshold || now >= mCoalescingDeadline || mFlushRequested)
+					return false;
+				return !mKeepAliveNeeded && !isKeepAliveDue(now);
+			}
 			void DistantClient::fillKeepAlive(Datagram& dgram)
 			{
 				fillDatagramHeader(dgram, Datagram::Type::KeepAlive);
 				// Do notify the other end if we're supposed to be connected or requesting the connection
 				Serialization::Serializer serializer;
 				serializer.write(mState == State::ConnectionSent || isConnected());
+				// Request an immediate ack while some data sent isn't acknowledged, to detect its loss without waiting for the other end keep alive
+				serializer.write(!mDataInFlight.empty());
 				memcpy(dgram.data.data(), serializer.buffer(), serializer.bufferSize());
 				dgram.datasize = static_cast<uint16>(serializer.bufferSize());
 			}
+			void DistantClient::onDataToAcknowledge()
+			{
+				if (mNbDatagramsToAck < std::numeric_limits<uint8>::max())
+					++mNbDatagramsToAck;
+				if (mNbDatagramsToAck >= sAckFrequency || sMaxAckDelay.count() <= 0)
+					mKeepAliveNeeded = true;
+				else if (mNbDatagramsToAck == 1)
+					mAckDeadline = Utils::Now() + sMaxAckDelay;
+			}
 			void DistantClient::handleKeepAlive(const uint8* data, const uint16 datasize)
 			{
 				maintainConnection();
-				if (mState == State::None || isConnecting())
+				Serialization::Deserializer deserializer(data, datasize);
+				bool isConnectedKeepAlive = false;
+				if (deserializer.read(isConnectedKeepAlive) && isConnectedKeepAlive && (mState == State::None || isConnecting()))
 				{
-					Serialization::Deserializer deserializer(data, datasize);
-					bool isConnectedKeepAlive = false;
-					if (deserializer.read(isConnectedKeepAlive) && isConnectedKeepAlive)
-					{
-						onConnectionReceived();
-					}
+					onConnectionReceived();
+				}
+				bool ackRequested = false;
+				if (deserializer.read(ackRequested) && ackRequested)
+				{
+					mKeepAliveNeeded = true;
 				}
 			}
-			void DistantClient::onDatagramReceived(Datagram&& datagram)
+			void DistantClient::onDatagramReceived(const Datagram& datagram)
 			{
-				const auto datagramid = ntohs(datagram.header.id);
+				const auto datagramid = datagram.header.id;
 				//!< Update the received acks tracking
 				mReceivedAcks.update(datagramid, 0, true);
 				//!< Update the send acks tracking
-				mSentAcks.update(ntohs(datagram.header.ack), datagram.header.previousAcks, true);
+				mSentAcks.update(datagram.header.ack, datagram.header.previousAcks, true);
+				onSentAcksUpdated(datagram.header.ack);
 				//!< Ignore duplicate
 				if (!mReceivedAcks.isNewlyAcked(datagramid))
 				{
@@ -267,6 +348,8 @@ namespace Bousk
 				{
 				case Datagram::Type::ConnectedData:
 				{
+					//!< Data must be acknowledged soon, even if we have nothing to send
+					onDataToAcknowledge();
 					//!< Dispatch data
 					onDataReceived(datagram.data.data(), datagram.datasize);
 				} break;
@@ -289,20 +372,62 @@ namespace Bousk
 			{
 				mChannelsHandler.onDatagramLost(datagramId);
 			}
+			void DistantClient::onSentAcksUpdated(const Datagram::ID ack)
+			{
+				if (mDataInFlight.empty())
+					return;
+				const auto now = Utils::Now();
+				const uint16 lastAck = mSentAcks.lastAck();
+				//!< Data is in flight until it's acked or detected lost
+				mDataInFlight.erase(std::remove_if(mDataInFlight.begin(), mDataInFlight.end(), [&](const InFlightDatagram& inFlight)
+				{
+					if (mSentAcks.isAcked(inFlight.id))
+					{
+						//!< Only the datagram this ack is about gives an accurate sample : others may have been acked by earlier datagrams which got lost
+						if (inFlight.id == ack && mSentAcks.isNewlyAcked(ack))
+							mRoundTripTime.onSample(now - inFlight.sentTime);
+						return true;
+					}
+					//!< Out of the acks range : the ack handler reports it lost
+					if (!Utils::IsSequenceNewer(inFlight.id, lastAck) && Utils::SequenceDiff(lastAck, inFlight.id) > 64)
+						return true;
+					//!< Later datagrams acked : this one isn't only late, no need to wait for it to get out of the acks range
+					if (mSentAcks.nbAckedAfter(inFlight.id) >= FastRetransmitAcks)
+					{
+						onDatagramSentLost(inFlight.id);
+						return true;
+					}
+					return false;
+				}), mDataInFlight.end());
+			}
+			void DistantClient::checkRetransmissionTimeout(const std::chrono::milliseconds now)
+			{
+				//!< Datagrams are in sending order and share the same timeout : those timed out come first
+				const auto firstInTime = std::find_if(mDataInFlight.begin(), mDataInFlight.end(), [&](const InFlightDatagram& inFlight) { return now < inFlight.sentTime + mRoundTripTime.retransmissionTimeout(); });
+				if (firstInTime == mDataInFlight.begin())
+					return;
+				for (auto it = mDataInFlight.begin(); it != firstInTime; ++it)
+					onDatagramSentLost(it->id);
+				mDataInFlight.erase(mDataInFlight.begin(), firstInTime);
+				mRoundTripTime.onTimeout();
+			}
 			void DistantClient::onDatagramReceivedLost(Datagram::ID)
 			{}
 			void DistantClient::onDataReceived(const uint8* data, const uint16 datasize)
 			{
 				// If we receive data, the other end is requesting a connection
 				onConnectionReceived();
+				// Data maintains the connection as much as a keep alive : a client sending data every frame never sends keep alives
+				if (isConnected())
+					maintainConnection();
 				mChannelsHandler.onDataReceived(data, datasize);
 				auto receivedMessages = mChannelsHandler.process(isConnected());
 				for (auto&& msg : receivedMessages)
 				{
-					onMessageReady(std::make_unique<Messages::UserData>(mAddress, mClientId, std::move(msg)));
+					onMessageReady(Messages::Event(mClientId, Messages::EventData<Messages::UserData>{ std::move(msg) }));
 				}
 			}
-			void DistantClient::onMessageReady(std::unique_ptr<Messages::Base>&& msg)
+			void DistantClient::onMessageReady(Messages::Event&& msg)
 			{
 				if (isConnected())
 				{
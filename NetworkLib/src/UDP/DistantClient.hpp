@@ -3,9 +3,13 @@
 #include <UDP/Datagram.hpp>
 #include <UDP/AckHandler.hpp>
 #include <UDP/ChannelsHandler.hpp>
+#include <UDP/RoundTripTime.hpp>
 #include <Address.hpp>
+#include <Events.hpp>
 #include <Sockets.hpp>
+#include <TimerWheel.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <vector>
@@ -15,17 +19,21 @@ namespace Bousk
 {
 	namespace Network
 	{
-		namespace Messages
-		{
-			class Base;
-		}
 		namespace UDP
 		{
 			class Client;
 			struct Datagram;
+			// When a connected distant client sends a keep alive while it has no data to send
+			enum class KeepAliveMode {
+				// Every keep alive interval, and right away to acknowledge received data
+				Periodic,
+				// Only to acknowledge received data : no traffic at all between idle ends, the connection then remains only as long as the other end sends data
+				AckOnly,
+			};
 			class DistantClient
 			{
 				friend class ::DistantClient_Test;
+				friend class Client;
 				enum class State {
 					None,
 					ConnectionSent,
@@ -52,26 +60,52 @@ namespace Bousk
 
 				static void SetTimeout(std::chrono::milliseconds timeout) { sTimeout = timeout; }
 				static std::chrono::milliseconds GetTimeout() { return sTimeout; }
+				// Should remain well below the timeout so several keep alives can be lost before the connection is
+				static void SetKeepAliveInterval(std::chrono::milliseconds interval) { sKeepAliveInterval = interval; }
+				static std::chrono::milliseconds GetKeepAliveInterval() { return sKeepAliveInterval; }
+				static void SetKeepAliveMode(KeepAliveMode mode) { sKeepAliveMode = mode; }
+				static KeepAliveMode GetKeepAliveMode() { return sKeepAliveMode; }
+				// Received data is acknowledged once frequency datagrams wait for it, or once the oldest waited maxDelay : a null delay acknowledges right away
+				// Delaying acks also delays loss detection on the other end, keep it small in regard of the round trip time
+				static void SetAckPolicy(std::chrono::milliseconds maxDelay, uint8 frequency) { sMaxAckDelay = maxDelay; sAckFrequency = std::max<uint8>(1, frequency); }
+				static std::chrono::milliseconds GetMaxAckDelay() { return sMaxAckDelay; }
+				static uint8 GetAckFrequency() { return sAckFrequency; }
+				// Messages are held back until fillThreshold bytes of them are queued, or the first one waited maxDelay : a null delay sends them right away
+				// A datagram due anyway, to acknowledge data or keep the connection alive, carries them at once
+				static void SetCoalescingPolicy(std::chrono::milliseconds maxDelay, uint16 fillThreshold) { sCoalescingMaxDelay = maxDelay; sCoalescingFillThreshold = fillThreshold; }
+				static std::chrono::milliseconds GetCoalescingMaxDelay() { return sCoalescingMaxDelay; }
+				static uint16 GetCoalescingFillThreshold() { return sCoalescingFillThreshold; }
 
 				inline bool isConnecting() const { return mState == State::ConnectionSent || mState == State::ConnectionReceived; }
 				inline bool isConnected() const { return mState == State::Connected; }
 				inline bool isDisconnecting() const { return mState == State::Disconnecting; }
 				inline bool isDisconnected() const { return mState == State::Disconnected; }
 
-				template<class T>
-				void registerChannel();
+				template<class T, class... Args>
+				void registerChannel(Args&&... args);
 
 				void connect();
 				void disconnect();
 
 				void send(std::vector<uint8>&& data, uint32 channelIndex);
+				// Send the messages held back by the coalescing policy with next processSend
+				void flush() { mFlushRequested = true; }
 				void processSend(uint8 maxDatagrams = 0);
-				void onDatagramReceived(Datagram&& datagram);
+				void onDatagramReceived(const Datagram& datagram);
+
+				// Next time processSend has something to do even if nothing is received nor sent meanwhile : keep alive, timeout or disconnection
+				std::chrono::milliseconds nextDeadline() const;
 
 				const Address& address() const { return mAddress; }
+				uint64 id() const { return mClientId; }
+				const RoundTripTime& roundTripTime() const { return mRoundTripTime; }
 
 			private:
 				void maintainConnection();
+				//!< Whether a keep alive is due now even without data to acknowledge
+				bool isKeepAliveDue(std::chrono::milliseconds now) const;
+				//!< Whether messages queued are held back to coalesce with the next ones
+				bool isCoalescing(std::chrono::milliseconds now) const;
 				void onConnectionSent();
 				void onConnectionReceived();
 				void onConnected();
@@ -82,9 +116,15 @@ namespace Bousk
 
 				void onDatagramSentAcked(Datagram::ID datagramId);
 				void onDatagramSentLost(Datagram::ID datagramId);
+				//!< Sample the round trip time from acks, and detect loss of data datagrams before they get out of the acks range
+				void onSentAcksUpdated(Datagram::ID ack);
+				//!< Consider lost the data datagrams not acked within the retransmission timeout
+				void checkRetransmissionTimeout(std::chrono::milliseconds now);
 				void onDatagramReceivedLost(Datagram::ID datagramId);
+				//!< Data received since the last datagram sent, which acknowledges it : a keep alive is due once enough of it or the ack deadline is reached
+				void onDataToAcknowledge();
 				void onDataReceived(const uint8* data, uint16 datasize);
-				void onMessageReady(std::unique_ptr<Messages::Base>&& msg);
+				void onMessageReady(Messages::Event&& msg);
 
 				void fillKeepAlive(Datagram& dgram);
 				void handleKeepAlive(const uint8* data, const uint16 datasize);
@@ -102,16 +142,39 @@ namespace Bousk
 				AckHandler mSentAcks;		//!< Which sent datagrams have been acked to detect loss
 				std::chrono::milliseconds mConnectionStartTime; // Connection start time, for connection timeout
 				std::chrono::milliseconds mLastKeepAlive; // Last time this connection has been marked alive, for timeout disconnection
+				std::chrono::milliseconds mLastDatagramSent; // Last time a datagram has been sent, to send keep alives on time while waiting
 				static std::chrono::milliseconds sTimeout; // Timeout is same for all clients
+				static std::chrono::milliseconds sKeepAliveInterval; // Idle connections send a keep alive that often, as do connecting and disconnecting ones
+				static KeepAliveMode sKeepAliveMode;
+				static std::chrono::milliseconds sMaxAckDelay;
+				static uint8 sAckFrequency;
+				static std::chrono::milliseconds sCoalescingMaxDelay;
+				static uint16 sCoalescingFillThreshold;
+				bool mKeepAliveNeeded{ false }; // Data to acknowledge or a connection state to notify : send a keep alive right away if there's no data to send
+				uint8 mNbDatagramsToAck{ 0 }; //!< Data datagrams received since the last datagram sent
+				std::chrono::milliseconds mAckDeadline{ 0 }; //!< A keep alive is due by then to acknowledge them
+				uint32 mNbBytesQueued{ 0 }; //!< Messages queued since the last datagrams sent
+				std::chrono::milliseconds mCoalescingDeadline{ 0 };
+				bool mFlushRequested{ false };
+				struct InFlightDatagram
+				{
+					Datagram::ID id;
+					std::chrono::milliseconds sentTime;
+				};
+				std::vector<InFlightDatagram> mDataInFlight; // Data datagrams sent, neither acknowledged nor detected lost yet, in sending order
+				RoundTripTime mRoundTripTime;
+				static constexpr uint8 FastRetransmitAcks = 3; //!< A datagram is lost once that many later datagrams are acked
 				State mState{ State::None };
 				DisconnectionReason mDisconnectionReason{ DisconnectionReason::None };
-				std::vector<std::unique_ptr<Messages::Base>> mPendingMessages; // Store messages before connection has been accepted
+				std::vector<Messages::Event> mPendingMessages; // Store messages before connection has been accepted
+				TimerWheel<DistantClient>::Timer mTimer{ *this }; //!< Scheduled by the client at next deadline
+				bool mToProcess{ false }; //!< Whether the client already queued it to be processed
 			};
 			
-			template<class T>
-			void DistantClient::registerChannel()
+			template<class T, class... Args>
+			void DistantClient::registerChannel(Args&&... args)
 			{
-				mChannelsHandler.registerChannel<T>();
+				mChannelsHandler.registerChannel<T>(std::forward<Args>(args)...);
 			}
 		}
 	}
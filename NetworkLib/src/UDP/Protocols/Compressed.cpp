@@ -0,0 +1,144 @@
+#include <UDP/Protocols/Compressed.hpp>
+#include <Serialization/Convert.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstring>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				namespace
+				{
+					//!< Packets are decompressed in pooled buffers : the protocol delivers messages as views into them
+					BufferPool& DecompressedPool()
+					{
+						thread_local const std::shared_ptr<BufferPool> pool = BufferPool::Create(Datagram::DataMaxSize);
+						return *pool;
+					}
+					//!< Marker, then the packet holding the compressed data
+					constexpr uint16 CompressedHeadersSize = 2 * Packet::HeaderSize;
+				}
+
+				Compressed::Compressed(std::unique_ptr<IProtocol>&& protocol, const Mode mode, std::shared_ptr<const Compression::Dictionary> dictionary, const uint16 threshold)
+					: mProtocol(std::move(protocol))
+					, mDictionary(std::move(dictionary))
+					, mMode(mode)
+					, mThreshold(threshold)
+				{
+					assert(mProtocol);
+				}
+
+				void Compressed::queue(std::vector<uint8>&& msgData)
+				{
+					if (mMode == Mode::PerDatagram)
+					{
+						mProtocol->queue(std::move(msgData));
+						return;
+					}
+					assert(msgData.size() < Packet::MaxMessageSize);
+					//!< Raw size, compressed data and format : kept only if smaller than the raw message
+					if (msgData.size() >= mThreshold && msgData.size() > sizeof(uint16) + 1)
+					{
+						std::vector<uint8> compressed(msgData.size());
+						const size_t compressedSize = Compression::LZ::Compress(msgData.data(), msgData.size(), compressed.data() + sizeof(uint16), msgData.size() - sizeof(uint16) - 1, mDictionary.get());
+						if (compressedSize != 0)
+						{
+							Serialization::Conversion::ToNetwork(static_cast<uint16>(msgData.size()), compressed.data());
+							compressed.resize(sizeof(uint16) + compressedSize);
+							compressed.push_back(static_cast<uint8>(MessageFormat::Compressed));
+							mProtocol->queue(std::move(compressed));
+							return;
+						}
+					}
+					msgData.push_back(static_cast<uint8>(MessageFormat::Raw));
+					mProtocol->queue(std::move(msgData));
+				}
+				uint16 Compressed::serialize(uint8* const buffer, const uint16 buffersize, const Datagram::ID datagramId)
+				{
+					const uint16 packetsSize = mProtocol->serialize(buffer, buffersize, datagramId);
+					if (mMode == Mode::PerMessage || packetsSize < mThreshold || packetsSize <= CompressedHeadersSize + 1)
+						return packetsSize;
+
+					std::array<uint8, Datagram::DataMaxSize> compressed;
+					const size_t compressedSize = Compression::LZ::Compress(buffer, packetsSize, compressed.data(), packetsSize - CompressedHeadersSize - 1, mDictionary.get());
+					if (compressedSize == 0)
+						return packetsSize;
+					Packet& marker = *reinterpret_cast<Packet*>(buffer);
+					marker.header = { mNextId++, 0, Packet::Type::LastFragment };
+					Packet& packet = *reinterpret_cast<Packet*>(buffer + Packet::HeaderSize);
+					packet.header = { mNextId++, static_cast<uint16>(compressedSize), Packet::Type::FullMessage };
+					memcpy(packet.data(), compressed.data(), compressedSize);
+					return static_cast<uint16>(CompressedHeadersSize + compressedSize);
+				}
+
+				void Compressed::onDataReceived(const uint8* const data, const uint16 datasize, const BufferPool::Buffer& buffer)
+				{
+					if (mMode == Mode::PerMessage || datasize < CompressedHeadersSize || !IsCompressedMarker(*reinterpret_cast<const Packet*>(data)))
+					{
+						mProtocol->onDataReceived(data, datasize, buffer);
+						return;
+					}
+					const Packet* packet = reinterpret_cast<const Packet*>(data + Packet::HeaderSize);
+					if (Packet::HeaderSize + packet->size() != datasize)
+					{
+						//!< Malformed buffer
+						return;
+					}
+					BufferPool::Buffer packets = DecompressedPool().acquire();
+					size_t packetsSize = 0;
+					if (!Compression::LZ::Decompress(packet->data(), packet->datasize(), packets.data(), Datagram::DataMaxSize, packetsSize, mDictionary.get()))
+						return;
+					mProtocol->onDataReceived(packets.data(), static_cast<uint16>(packetsSize), packets);
+				}
+				std::vector<Payload> Compressed::process()
+				{
+					std::vector<Payload> messages = mProtocol->process();
+					if (mMode == Mode::PerDatagram)
+						return messages;
+
+					size_t nbMessages = 0;
+					for (Payload& message : messages)
+					{
+						if (message.empty())
+							continue; //!< Malformed message
+						const MessageFormat format = static_cast<MessageFormat>(message[message.size() - 1]);
+						if (format == MessageFormat::Raw)
+						{
+							message.truncate(message.size() - 1);
+						}
+						else if (format == MessageFormat::Compressed && message.size() > sizeof(uint16))
+						{
+							uint16 rawSize = 0;
+							Serialization::Conversion::ToLocal(message.data(), rawSize);
+							if (rawSize > Packet::MaxMessageSize)
+								continue;
+							std::vector<uint8> raw(rawSize);
+							size_t decompressedSize = 0;
+							if (!Compression::LZ::Decompress(message.data() + sizeof(uint16), message.size() - sizeof(uint16) - 1, raw.data(), raw.size(), decompressedSize, mDictionary.get())
+								|| decompressedSize != rawSize)
+							{
+								continue;
+							}
+							message = Payload(std::move(raw));
+						}
+						else
+						{
+							continue;
+						}
+						if (&messages[nbMessages] != &message)
+							messages[nbMessages] = std::move(message);
+						++nbMessages;
+					}
+					messages.resize(nbMessages);
+					return messages;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Compression/LZ.hpp"
+#include "UDP/Packet.hpp"
+#include "UDP/Protocols/ProtocolInterface.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Compresses the data of another protocol, with a dictionary both ends share if any.
+				- PerMessage : each message is compressed when it's queued, so that a reliable protocol sends it compressed again if lost.
+				  A byte is appended to each message to tell whether it's compressed : messages can be a byte less than Packet::MaxMessageSize.
+				- PerDatagram : the packets the protocol serializes for a datagram are compressed together, small messages compress better.
+				  They are sent as is when they don't compress.
+				Data smaller than the threshold is sent as is.
+				*/
+				class Compressed : public IProtocol
+				{
+				public:
+					enum class Mode : uint8
+					{
+						PerMessage,
+						PerDatagram,
+					};
+					static constexpr uint16 DefaultThreshold = 64;
+
+				public:
+					Compressed(std::unique_ptr<IProtocol>&& protocol, Mode mode = Mode::PerMessage, std::shared_ptr<const Compression::Dictionary> dictionary = nullptr, uint16 threshold = DefaultThreshold);
+					~Compressed() override = default;
+
+					void queue(std::vector<uint8>&& msgData) override;
+					uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID datagramId) override;
+
+					void onDatagramAcked(const Datagram::ID datagramId) override { mProtocol->onDatagramAcked(datagramId); }
+					void onDatagramLost(const Datagram::ID datagramId) override { mProtocol->onDatagramLost(datagramId); }
+
+					void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer) override;
+					std::vector<Payload> process() override;
+
+					bool isReliable() const override { return mProtocol->isReliable(); }
+
+				private:
+					//!< Trailing byte of a message in PerMessage mode
+					enum class MessageFormat : uint8
+					{
+						Raw,
+						Compressed,
+					};
+					//!< In PerDatagram mode, compressed packets follow an empty LastFragment, which protocols never send
+					static bool IsCompressedMarker(const Packet& packet) { return packet.type() == Packet::Type::LastFragment && packet.datasize() == 0; }
+
+				private:
+					std::unique_ptr<IProtocol> mProtocol;
+					std::shared_ptr<const Compression::Dictionary> mDictionary;
+					const Mode mMode;
+					const uint16 mThreshold;
+					Packet::Id mNextId{ 0 }; //!< Of the packets holding compressed data
+				};
+			}
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#include "UDP/Protocols/PendingPacket.hpp"
+
+#include <cstring>
+#include <memory>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				namespace
+				{
+					BufferPool& PacketsPool()
+					{
+						thread_local const std::shared_ptr<BufferPool> pool = BufferPool::Create(sizeof(Packet));
+						return *pool;
+					}
+				}
+
+				void PendingPacket::hold(const Packet* packet, const BufferPool::Buffer& buffer)
+				{
+					if (buffer)
+					{
+						mBuffer = buffer;
+						mPacket = packet;
+					}
+					else
+					{
+						mBuffer = PacketsPool().acquire();
+						memcpy(mBuffer.data(), packet->buffer(), packet->size());
+						mPacket = &mBuffer.as<Packet>();
+					}
+				}
+			}
+		}
+	}
+}
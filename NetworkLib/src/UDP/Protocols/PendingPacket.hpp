@@ -0,0 +1,39 @@
+#pragma once
+
+#include "BufferPool.hpp"
+#include "UDP/Packet.hpp"
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Packet received, waiting for its message to be delivered.
+				It stays in the pooled buffer it was received in, without copy. Otherwise it's copied into a buffer from a pool shared by the channels of the thread.
+				*/
+				class PendingPacket
+				{
+				public:
+					PendingPacket() = default;
+					~PendingPacket() = default;
+
+					void hold(const Packet* packet, const BufferPool::Buffer& buffer);
+					void reset() { mBuffer.reset(); mPacket = nullptr; }
+
+					// Null if no packet is held
+					const Packet* packet() const { return mPacket; }
+					// Buffer the packet lies in, which any view into it must hold
+					const BufferPool::Buffer& buffer() const { return mBuffer; }
+
+				private:
+					BufferPool::Buffer mBuffer;
+					const Packet* mPacket{ nullptr };
+				};
+			}
+		}
+	}
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <UDP/Datagram.hpp>
+#include <BufferPool.hpp>
+#include <Payload.hpp>
 #include <vector>
 
 namespace Bousk
@@ -23,8 +25,9 @@ namespace Bousk
 					virtual void onDatagramAcked(Datagram::ID /*datagramId*/) {}
 					virtual void onDatagramLost(Datagram::ID /*datagramId*/) {}
 
-					virtual void onDataReceived(const uint8* data, uint16 datasize) = 0;
-					virtual std::vector<std::vector<uint8>> process() = 0;
+					// data lies in buffer when it's been received in a pooled buffer : messages can be delivered as views into it instead of copies
+					virtual void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer) = 0;
+					virtual std::vector<Payload> process() = 0;
 
 					virtual bool isReliable() const = 0;
 				};
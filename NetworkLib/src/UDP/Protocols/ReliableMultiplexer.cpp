@@ -0,0 +1,159 @@
+#include "UDP/Protocols/ReliableMultiplexer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				static_assert(ReliableMultiplexer::IsValidWindowSize(ReliableMultiplexer::DefaultWindowSize), "BOUSKNET_UDP_RELIABLE_WINDOW_SIZE must be a power of 2 between Packet::MaxPacketsPerMessage and 32768");
+
+				ReliableMultiplexer::ReliableMultiplexer(const uint16 windowSize)
+					: mWindowSize(windowSize)
+				{
+					assert(IsValidWindowSize(windowSize));
+				}
+				void ReliableMultiplexer::queue(std::vector<uint8>&& msgData)
+				{
+					assert(msgData.size() <= Packet::MaxMessageSize);
+					if (msgData.size() > Packet::DataMaxSize)
+					{
+						uint16 queuedSize = 0;
+						Packet* packet = nullptr;
+						while (queuedSize < msgData.size())
+						{
+							const auto fragmentSize = std::min(Packet::DataMaxSize, static_cast<uint16>(msgData.size() - queuedSize));
+							packet = &pushPacket().packet();
+							packet->header.type = ((queuedSize == 0) ? Packet::Type::FirstFragment : Packet::Type::Fragment);
+							packet->header.size = fragmentSize;
+							memcpy(packet->data(), msgData.data() + queuedSize, fragmentSize);
+							queuedSize += fragmentSize;
+						}
+						packet->header.type = Packet::Type::LastFragment;
+						assert(queuedSize == msgData.size());
+					}
+					else
+					{
+						//!< Single packet
+						Packet& packet = pushPacket().packet();
+						packet.header.type = Packet::Type::FullMessage;
+						packet.header.size = static_cast<uint16>(msgData.size());
+						memcpy(packet.data(), msgData.data(), msgData.size());
+					}
+				}
+				ReliableMultiplexer::ReliablePacket& ReliableMultiplexer::pushPacket()
+				{
+					const size_t nbQueued = static_cast<uint16>(mNextId - mFirstAllowedPacket);
+					if (nbQueued == mQueue.size())
+					{
+						//!< Full : double the ring, then put packets back at their index in the new size
+						std::vector<ReliablePacket> queue(std::max<size_t>(8, 2 * mQueue.size()));
+						for (size_t i = 0; i < nbQueued; ++i)
+						{
+							const Packet::Id id = static_cast<Packet::Id>(mFirstAllowedPacket + i);
+							queue[id & (queue.size() - 1)] = std::move(queued(id));
+						}
+						mQueue = std::move(queue);
+					}
+					ReliablePacket& packetHolder = queued(mNextId);
+					packetHolder.reset();
+					packetHolder.packet().header.id = mNextId++;
+					++mNbUnacked;
+					return packetHolder;
+				}
+				uint16 ReliableMultiplexer::serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId)
+				{
+					uint16 serializedSize = 0;
+					SentDatagram* sentDatagram = nullptr;
+					//!< Only packets the other end has room for can be sent
+					const uint16 nbAllowed = std::min<uint16>(static_cast<uint16>(mNextId - mFirstAllowedPacket), mWindowSize);
+					for (uint16 i = 0; i < nbAllowed; ++i)
+					{
+						ReliablePacket& packetHolder = queued(static_cast<Packet::Id>(mFirstAllowedPacket + i));
+						if (packetHolder.isAcked() || !packetHolder.shouldSend())
+							continue;
+						const auto& packet = packetHolder.packet();
+						if (serializedSize + packet.size() > buffersize)
+							continue; //!< Not enough room, let's skip this one for now
+
+						memcpy(buffer, packet.buffer(), packet.size());
+						serializedSize += packet.size();
+						buffer += packet.size();
+
+						//!< Once the packet has been serialized into a datagram, save which datagram it's been included into
+						packetHolder.onSent(datagramId);
+						if (!sentDatagram)
+						{
+							if (mSentDatagrams.empty())
+								mSentDatagrams.resize(SentDatagramsSize);
+							sentDatagram = &mSentDatagrams[datagramId % mSentDatagrams.size()];
+							if (sentDatagram->inFlight)
+								onDatagramLost(*sentDatagram);
+							sentDatagram->id = datagramId;
+							sentDatagram->inFlight = true;
+						}
+						sentDatagram->packets.push_back(packet.id());
+					}
+					return serializedSize;
+				}
+
+				void ReliableMultiplexer::onDatagramAcked(const Datagram::ID datagramId)
+				{
+					if (mSentDatagrams.empty())
+						return;
+					SentDatagram& sentDatagram = mSentDatagrams[datagramId % mSentDatagrams.size()];
+					if (!sentDatagram.inFlight || sentDatagram.id != datagramId)
+						return;
+					for (const Packet::Id id : sentDatagram.packets)
+					{
+						if (!isQueued(id))
+							continue;
+						ReliablePacket& packetHolder = queued(id);
+						if (!packetHolder.isAcked())
+						{
+							packetHolder.onAcked();
+							--mNbUnacked;
+						}
+					}
+					sentDatagram.packets.clear();
+					sentDatagram.inFlight = false;
+					//!< Acked messages leave the queue from its front, letting the next ones be sent
+					//!< Acked fragments of a message stay until its last one is : the other end keeps them in its window until then
+					for (Packet::Id id = mFirstAllowedPacket; id != mNextId && queued(id).isAcked(); ++id)
+					{
+						const Packet::Type type = queued(id).packet().type();
+						if (type == Packet::Type::FullMessage || type == Packet::Type::LastFragment)
+							mFirstAllowedPacket = id + 1;
+					}
+				}
+				void ReliableMultiplexer::onDatagramLost(const Datagram::ID datagramId)
+				{
+					if (mSentDatagrams.empty())
+						return;
+					SentDatagram& sentDatagram = mSentDatagrams[datagramId % mSentDatagrams.size()];
+					if (sentDatagram.inFlight && sentDatagram.id == datagramId)
+						onDatagramLost(sentDatagram);
+				}
+				void ReliableMultiplexer::onDatagramLost(SentDatagram& sentDatagram)
+				{
+					for (const Packet::Id id : sentDatagram.packets)
+					{
+						if (!isQueued(id))
+							continue;
+						ReliablePacket& packetHolder = queued(id);
+						if (!packetHolder.isAcked() && packetHolder.isLastSentIn(sentDatagram.id))
+							packetHolder.resend();
+					}
+					sentDatagram.packets.clear();
+					sentDatagram.inFlight = false;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
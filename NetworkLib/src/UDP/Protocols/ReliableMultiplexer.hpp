@@ -0,0 +1,100 @@
+#pragma once
+
+#include "UDP/Datagram.hpp"
+#include "UDP/Packet.hpp"
+#include "Settings.hpp"
+
+#include <limits>
+#include <vector>
+
+class ReliableOrdered_Multiplexer_Test;
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Sending side of reliable protocols : messages are split into packets, sent until acked.
+				At most windowSize packets, from the first one of the oldest message not fully acked, are in flight.
+				The receiving end keeps packets from the first one of the oldest message it didn't fully receive : it has room for them, whatever order they arrive in.
+				Both ends must use the same window size, a power of 2 large enough for the biggest message.
+				*/
+				class ReliableMultiplexer
+				{
+					friend class ReliableOrdered_Multiplexer_Test;
+				public:
+					static constexpr uint16 DefaultWindowSize = BOUSKNET_UDP_RELIABLE_WINDOW_SIZE;
+					static constexpr uint16 MinWindowSize = Packet::MaxPacketsPerMessage;
+					//!< Beyond half the ids range, ids of a window could no longer be ordered
+					static constexpr uint16 MaxWindowSize = std::numeric_limits<Packet::Id>::max() / 2 + 1;
+					static constexpr bool IsValidWindowSize(uint16 windowSize) { return windowSize >= MinWindowSize && windowSize <= MaxWindowSize && (windowSize & (windowSize - 1)) == 0; }
+
+				public:
+					explicit ReliableMultiplexer(uint16 windowSize = DefaultWindowSize);
+					~ReliableMultiplexer() = default;
+
+					void queue(std::vector<uint8>&& msgData);
+					uint16 serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId);
+
+					void onDatagramAcked(const Datagram::ID datagramId);
+					void onDatagramLost(const Datagram::ID datagramId);
+
+				private:
+					class ReliablePacket
+					{
+					public:
+						Packet& packet() { return mPacket; }
+						const Packet& packet() const { return mPacket; }
+
+						//!< Reuse the slot for a new packet
+						void reset() { mShouldSend = true; mSent = false; mAcked = false; }
+						bool shouldSend() const { return mShouldSend; }
+						void resend() { mShouldSend = true; }
+						void onSent(const Datagram::ID datagramId) { mLastDatagram = datagramId; mSent = true; mShouldSend = false; }
+						//!< Loss of an earlier copy is reported late, while the last one may still arrive : only the loss of the last one requires to send it again
+						bool isLastSentIn(const Datagram::ID datagramId) const { return mSent && mLastDatagram == datagramId; }
+						bool isAcked() const { return mAcked; }
+						void onAcked() { mAcked = true; }
+
+					private:
+						Packet mPacket;
+						Datagram::ID mLastDatagram{ 0 };
+						bool mShouldSend{ true };
+						bool mSent{ false };
+						bool mAcked{ false };
+					};
+					//!< Packets carried by a datagram, to handle its ack or loss without looking through the queue
+					struct SentDatagram
+					{
+						std::vector<Packet::Id> packets;
+						Datagram::ID id{ 0 };
+						bool inFlight{ false };
+					};
+					//!< A datagram still in flight when its slot is needed again is considered lost
+					static constexpr size_t SentDatagramsSize = 256;
+
+					bool isQueued(Packet::Id id) const { return static_cast<uint16>(id - mFirstAllowedPacket) < static_cast<uint16>(mNextId - mFirstAllowedPacket); }
+					ReliablePacket& queued(Packet::Id id) { return mQueue[id & (mQueue.size() - 1)]; }
+					//!< Slot of the next packet to queue, growing the queue if it's full
+					ReliablePacket& pushPacket();
+					void onDatagramLost(SentDatagram& sentDatagram);
+					size_t nbUnackedPackets() const { return mNbUnacked; }
+
+				private:
+					//!< Ring of packets queued, from mFirstAllowedPacket to mNextId excluded : each is at index id modulo the size, a power of 2
+					//!< mFirstAllowedPacket is the first packet of the oldest message not fully acked
+					std::vector<ReliablePacket> mQueue;
+					//!< Ring of datagrams which carried packets, at index id modulo its size. Allocated with the first packet sent
+					std::vector<SentDatagram> mSentDatagrams;
+					const uint16 mWindowSize;
+					size_t mNbUnacked{ 0 };
+					Packet::Id mNextId{ 0 };
+					Packet::Id mFirstAllowedPacket{ 0 };
+				};
+			}
+		}
+	}
+}
\ No newline at end of file
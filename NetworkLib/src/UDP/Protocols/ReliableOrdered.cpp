@@ -11,83 +11,12 @@ namespace Bousk
 		{
 			namespace Protocols
 			{
-				void ReliableOrdered::Multiplexer::queue(std::vector<uint8>&& msgData)
+				ReliableOrdered::Demultiplexer::Demultiplexer(const uint16 windowSize)
+					: mWindowSize(windowSize)
 				{
-					assert(msgData.size() <= Packet::MaxMessageSize);
-					if (msgData.size() > Packet::DataMaxSize)
-					{
-						uint16 queuedSize = 0;
-						while (queuedSize < msgData.size())
-						{
-							const auto fragmentSize = std::min(Packet::DataMaxSize, static_cast<uint16>(msgData.size() - queuedSize));
-							mQueue.resize(mQueue.size() + 1);
-							Packet& packet = mQueue.back().packet();
-							packet.header.id = mNextId++;
-							packet.header.type = ((queuedSize == 0) ? Packet::Type::FirstFragment : Packet::Type::Fragment);
-							packet.header.size = fragmentSize;
-							memcpy(packet.data(), msgData.data() + queuedSize, fragmentSize);
-							queuedSize += fragmentSize;
-						}
-						mQueue.back().packet().header.type = Packet::Type::LastFragment;
-						assert(queuedSize == msgData.size());
-					}
-					else
-					{
-						//!< Single packet
-						mQueue.resize(mQueue.size() + 1);
-						Packet& packet = mQueue.back().packet();
-						packet.header.id = mNextId++;
-						packet.header.type = Packet::Type::FullMessage;
-						packet.header.size = static_cast<uint16>(msgData.size());
-						memcpy(packet.data(), msgData.data(), msgData.size());
-					}
-				}
-				uint16 ReliableOrdered::Multiplexer::serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId)
-				{
-					uint16 serializedSize = 0;
-					for (auto& packetHolder : mQueue)
-					{
-						if (!(Utils::SequenceDiff(packetHolder.packet().id(), mFirstAllowedPacket) < Demultiplexer::QueueSize))
-							break;
-						if (!packetHolder.shouldSend())
-							continue;
-						const auto& packet = packetHolder.packet();
-						if (serializedSize + packet.size() > buffersize)
-							continue; //!< Not enough room, let's skip this one for now
-
-						memcpy(buffer, packet.buffer(), packet.size());
-						serializedSize += packet.size();
-						buffer += packet.size();
-
-						//!< Once the packet has been serialized into a datagram, save which datagram it's been included into
-						packetHolder.onSent(datagramId);
-					}
-					return serializedSize;
-				}
-
-				void ReliableOrdered::Multiplexer::onDatagramAcked(const Datagram::ID datagramId)
-				{
-					if (mQueue.empty())
-						return;
-
-					mQueue.erase(std::remove_if(mQueue.begin(), mQueue.end()
-						, [&](const ReliablePacket& packetHolder) { return packetHolder.isIncludedIn(datagramId); })
-						, mQueue.cend());
-					if (mQueue.empty())
-						mFirstAllowedPacket = mNextId;
-					else if (Utils::IsSequenceNewer(mQueue.front().packet().id(), mFirstAllowedPacket))
-						mFirstAllowedPacket = mQueue.front().packet().id();
-				}
-				void ReliableOrdered::Multiplexer::onDatagramLost(const Datagram::ID datagramId)
-				{
-					for (auto& packetHolder : mQueue)
-					{
-						if (packetHolder.isIncludedIn(datagramId))
-							packetHolder.resend();
-					}
+					assert(ReliableMultiplexer::IsValidWindowSize(windowSize));
 				}
-
-				void ReliableOrdered::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize)
+				void ReliableOrdered::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer)
 				{
 					//!< Extract packets from buffer
 					uint16 processedDataSize = 0;
@@ -99,120 +28,107 @@ namespace Bousk
 							//!< Malformed packet or buffer
 							break;
 						}
-						onPacketReceived(pckt);
+						onPacketReceived(pckt, buffer);
 						processedDataSize += pckt->size();
 						data += pckt->size();
 					}
 				}
-				void ReliableOrdered::Demultiplexer::onPacketReceived(const Packet* pckt)
+				void ReliableOrdered::Demultiplexer::onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer)
 				{
 					if (!Utils::IsSequenceNewer(pckt->id(), mLastProcessed))
 						return; //!< Packet is too old
+					const Packet::Id expectedPacketId = mLastProcessed + 1;
+					if (static_cast<uint16>(pckt->id() - expectedPacketId) >= mWindowSize)
+						return; //!< Beyond the window : the sender shouldn't have sent it
 
-								//!< Find the place for this packet
-					const size_t index = pckt->id() % mPendingQueue.size();
-					Packet& pendingPacket = mPendingQueue[index];
-					if (pendingPacket.datasize() == 0)
+					PendingPacket* pendingPacket = mPendingQueue.empty() ? nullptr : &pending(pckt->id());
+					if ((!pendingPacket || !pendingPacket->packet()) && pckt->id() == expectedPacketId && pckt->type() == Packet::Type::FullMessage)
 					{
-						// Slot is available, simply copy data from network into the queue
-						pendingPacket = *pckt;
+						//!< Next expected message, complete : it's ready as is
+						mReadyMessages.emplace_back(pckt->data(), pckt->datasize(), buffer);
+						mLastProcessed = pckt->id();
 					}
 					else
 					{
-						// Slot is NOT available, packet should already be received, otherwise it's an error
-						assert(pendingPacket.id() == pckt->id() && pendingPacket.datasize() == pckt->datasize());
+						if (!pendingPacket)
+						{
+							mPendingQueue.resize(mWindowSize);
+							pendingPacket = &pending(pckt->id());
+						}
+						if (!pendingPacket->packet())
+						{
+							//!< Slot is available
+							pendingPacket->hold(pckt, buffer);
+						}
+						else
+						{
+							// Slot is NOT available, packet should already be received, otherwise it's an error
+							assert(pendingPacket->packet()->id() == pckt->id() && pendingPacket->packet()->datasize() == pckt->datasize());
+						}
 					}
+					//!< The sender moves its window once a message is acked, without waiting for process : so must we
+					if (!mPendingQueue.empty())
+						extractReadyMessages();
 				}
-				std::vector<std::vector<uint8>> ReliableOrdered::Demultiplexer::process()
+				std::vector<Payload> ReliableOrdered::Demultiplexer::process()
+				{
+					std::vector<Payload> messagesReady = std::move(mReadyMessages);
+					mReadyMessages.clear();
+					return messagesReady;
+				}
+				void ReliableOrdered::Demultiplexer::extractReadyMessages()
 				{
-					auto ResetPacket = [](Packet& pckt) { pckt.header.size = 0; };
-					auto IsPacketValid = [](const Packet& pckt) { return pckt.header.size != 0; };
-					std::vector<std::vector<uint8>> messagesReady;
-
-					Packet::Id expectedPacketId = mLastProcessed + 1;
-					const size_t startIndexOffset = expectedPacketId % mPendingQueue.size();
 					//!< Our queue is ordered, just go through and reassemble packets
-					for (size_t i = 0; i < mPendingQueue.size(); ++i, ++expectedPacketId)
+					for (;;)
 					{
-						const size_t packetIndex = (i + startIndexOffset) % mPendingQueue.size();
-						Packet& packet = mPendingQueue[packetIndex];
-						if (!IsPacketValid(packet))
-							break;
+						const Packet::Id expectedPacketId = mLastProcessed + 1;
+						PendingPacket& pendingPacket = pending(expectedPacketId);
+						if (!pendingPacket.packet())
+							break; // Next message to extract is not received yet
+						const Packet& packet = *pendingPacket.packet();
 						if (packet.type() == Packet::Type::FullMessage)
 						{
-							//!< Full packet, just take it
-							std::vector<uint8> msg(packet.data(), packet.data() + packet.datasize());
+							//!< Full packet, just take it without copy
+							mReadyMessages.emplace_back(packet.data(), packet.datasize(), pendingPacket.buffer());
 							mLastProcessed = packet.id();
-							ResetPacket(packet);
-							messagesReady.push_back(std::move(msg));
+							pendingPacket.reset();
+							continue;
 						}
-						else if (packet.type() == Packet::Type::FirstFragment)
-						{
-							//!< Check if the message is ready (fully received)
-							const bool isMessageFull = [=]() mutable
-							{
-								// Skip first fragment
-								++i;
-								++expectedPacketId;
-								// Iterate through remaining packets to check message is complete
-								for (size_t j = i; j < mPendingQueue.size(); ++j, ++expectedPacketId)
-								{
-									const size_t idx = (j + startIndexOffset) % mPendingQueue.size();
-									const Packet& pckt = mPendingQueue[idx];
-									if (pckt.id() != expectedPacketId || pckt.datasize() == 0)
-										break; // Expected packet not received yet
-									if (pckt.type() == Packet::Type::LastFragment)
-									{
-										//!< Last fragment reached, the message is full
-										return true;
-									}
-									else if (pckt.type() != Packet::Type::Fragment)
-									{
-										//!< If we reach this, we likely recieved a malformed packet / hack attempt
-										break;
-									}
-								}
-								return false;
-							}();
-							if (!isMessageFull)
-								break; // Messages are ordered and next one to extract is not full yet
+						if (packet.type() != Packet::Type::FirstFragment)
+							break; //!< If we reach this, we likely recieved a malformed packet / hack attempt
 
-									   // Start the message with first fragment packet, then skip it
-							std::vector<uint8> msg(packet.data(), packet.data() + packet.datasize());
-							++i;
-							++expectedPacketId;
-							// Iterate through remaining packets to try to complete it
-							for (size_t j = i; j < mPendingQueue.size(); ++i, ++j, ++expectedPacketId)
+						//!< Check if the message is ready (fully received)
+						uint16 nbFragments = 1;
+						bool isMessageFull = false;
+						for (; nbFragments < mWindowSize; ++nbFragments)
+						{
+							const Packet* pckt = pending(static_cast<Packet::Id>(expectedPacketId + nbFragments)).packet();
+							if (!pckt)
+								break; // Expected packet not received yet
+							if (pckt->type() == Packet::Type::LastFragment)
 							{
-								const size_t idx = (j + startIndexOffset) % mPendingQueue.size();
-								Packet& pckt = mPendingQueue[idx];
-
-								if (pckt.type() == Packet::Type::LastFragment)
-								{
-									//!< Last fragment reached, the message is full
-									msg.insert(msg.cend(), pckt.data(), pckt.data() + pckt.datasize());
-									mLastProcessed = pckt.id();
-									ResetPacket(pckt);
-									messagesReady.push_back(std::move(msg));
-									break;
-								}
-								else if (pckt.type() != Packet::Type::Fragment)
-								{
-									//!< If we reach this, we likely recieved a malformed packet / hack attempt
-									break;
-								}
-
-								msg.insert(msg.cend(), pckt.data(), pckt.data() + pckt.datasize());
-								ResetPacket(pckt);
+								//!< Last fragment reached, the message is full
+								isMessageFull = true;
+								++nbFragments;
+								break;
 							}
+							if (pckt->type() != Packet::Type::Fragment)
+								break; //!< If we reach this, we likely recieved a malformed packet / hack attempt
 						}
-						else
+						if (!isMessageFull)
+							break; // Messages are ordered and next one to extract is not full yet
+
+						std::vector<uint8> msg;
+						msg.reserve(nbFragments * Packet::DataMaxSize);
+						for (uint16 i = 0; i < nbFragments; ++i)
 						{
-							// Messages are ordered and next one to extract is not received yet
-							break;
+							PendingPacket& fragment = pending(static_cast<Packet::Id>(expectedPacketId + i));
+							msg.insert(msg.cend(), fragment.packet()->data(), fragment.packet()->data() + fragment.packet()->datasize());
+							fragment.reset();
 						}
+						mLastProcessed = static_cast<Packet::Id>(expectedPacketId + nbFragments - 1);
+						mReadyMessages.push_back(std::move(msg));
 					}
-					return messagesReady;
 				}
 			}
 		}
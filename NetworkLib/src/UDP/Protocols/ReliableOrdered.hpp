@@ -1,12 +1,11 @@
 #pragma once
 
-#include "UDP/AckHandler.hpp"
 #include "UDP/Packet.hpp"
+#include "UDP/Protocols/PendingPacket.hpp"
 #include "UDP/Protocols/ProtocolInterface.hpp"
+#include "UDP/Protocols/ReliableMultiplexer.hpp"
 
 #include <vector>
-#include <array>
-#include <set>
 #include <limits>
 
 class ReliableOrdered_Multiplexer_Test;
@@ -19,12 +18,19 @@ namespace Bousk
 		{
 			namespace Protocols
 			{
+				/*
+				Messages are delivered once each, in the order they were sent.
+				At most windowSize packets are in flight : the receiving end stores those arriving out of order until the missing ones are received.
+				*/
 				class ReliableOrdered : public IProtocol
 				{
 					friend class ReliableOrdered_Multiplexer_Test;
 					friend class ReliableOrdered_Demultiplexer_Test;
 				public:
-					ReliableOrdered() = default;
+					static constexpr uint16 DefaultWindowSize = ReliableMultiplexer::DefaultWindowSize;
+
+				public:
+					explicit ReliableOrdered(uint16 windowSize = DefaultWindowSize) : mMultiplexer(windowSize), mDemultiplexer(windowSize) {}
 					~ReliableOrdered() override = default;
 
 					void queue(std::vector<uint8>&& msgData) override { mMultiplexer.queue(std::move(msgData)); }
@@ -33,63 +39,37 @@ namespace Bousk
 					void onDatagramAcked(const Datagram::ID datagramId) override { mMultiplexer.onDatagramAcked(datagramId); }
 					void onDatagramLost(const Datagram::ID datagramId) override { mMultiplexer.onDatagramLost(datagramId); }
 
-					void onDataReceived(const uint8* data, const uint16 datasize) override { mDemultiplexer.onDataReceived(data, datasize); }
-					std::vector<std::vector<uint8>> process() override { return mDemultiplexer.process(); }
+					void onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer) override { mDemultiplexer.onDataReceived(data, datasize, buffer); }
+					std::vector<Payload> process() override { return mDemultiplexer.process(); }
 
 					virtual bool isReliable() const { return true; }
 
 				private:
-					class Multiplexer
-					{
-						friend class ReliableOrdered_Multiplexer_Test;
-					public:
-						Multiplexer() = default;
-						~Multiplexer() = default;
-
-						void queue(std::vector<uint8>&& msgData);
-						uint16 serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId);
-
-						void onDatagramAcked(const Datagram::ID datagramId);
-						void onDatagramLost(const Datagram::ID datagramId);
+					using Multiplexer = ReliableMultiplexer;
+					Multiplexer mMultiplexer;
 
-					private:
-						class ReliablePacket
-						{
-						public:
-							Packet& packet() { return mPacket; }
-							const Packet& packet() const { return mPacket; }
-
-							bool shouldSend() const { return mShouldSend; }
-							void resend() { mShouldSend = true; }
-							void onSent(const Datagram::ID datagramId) { mDatagramsIncluding.insert(datagramId); mShouldSend = false; }
-							bool isIncludedIn(const Datagram::ID datagramId) const { return mDatagramsIncluding.find(datagramId) != mDatagramsIncluding.cend(); }
-
-						private:
-							Packet mPacket;
-							std::set<Datagram::ID> mDatagramsIncluding;
-							bool mShouldSend{ true };
-						};
-						std::vector<ReliablePacket> mQueue;
-						Packet::Id mNextId{ 0 };
-						Packet::Id mFirstAllowedPacket{ 0 };
-					} mMultiplexer;
 					class Demultiplexer
 					{
 						friend class ReliableOrdered_Demultiplexer_Test;
 					public:
-						static constexpr size_t QueueSize = 2 * Packet::MaxPacketsPerMessage;
-					public:
-						Demultiplexer() = default;
+						explicit Demultiplexer(uint16 windowSize = DefaultWindowSize);
 						~Demultiplexer() = default;
 
-						void onDataReceived(const uint8* data, const uint16 datasize);
-						std::vector<std::vector<uint8>> process();
+						void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer = BufferPool::Buffer());
+						std::vector<Payload> process();
 
 					private:
-						void onPacketReceived(const Packet* pckt);
+						void onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer);
+						//!< Move messages fully received, in order, from the pending queue to the ready ones
+						void extractReadyMessages();
+
+						PendingPacket& pending(Packet::Id id) { return mPendingQueue[id & (mWindowSize - 1)]; }
 
 					private:
-						std::array<Packet, QueueSize> mPendingQueue;
+						//!< Slot per packet of the window, at index id modulo its size. Allocated with the first packet received out of order
+						std::vector<PendingPacket> mPendingQueue;
+						std::vector<Payload> mReadyMessages; //!< Full messages received in order, extracted as soon as they're complete to free the window
+						const uint16 mWindowSize;
 						Packet::Id mLastProcessed{ std::numeric_limits<Packet::Id>::max() };
 					} mDemultiplexer;
 				};
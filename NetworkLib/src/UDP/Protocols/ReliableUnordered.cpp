@@ -0,0 +1,119 @@
+#include "UDP/Protocols/ReliableUnordered.hpp"
+
+#include <cassert>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				ReliableUnordered::Demultiplexer::Demultiplexer(const uint16 windowSize)
+					: mWindowSize(windowSize)
+				{
+					assert(ReliableMultiplexer::IsValidWindowSize(windowSize));
+				}
+				void ReliableUnordered::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer)
+				{
+					//!< Extract packets from buffer
+					uint16 processedDataSize = 0;
+					while (processedDataSize < datasize)
+					{
+						const Packet* pckt = reinterpret_cast<const Packet*>(data);
+						if (processedDataSize + pckt->size() > datasize || pckt->datasize() > Packet::DataMaxSize)
+						{
+							//!< Malformed packet or buffer
+							break;
+						}
+						onPacketReceived(pckt, buffer);
+						processedDataSize += pckt->size();
+						data += pckt->size();
+					}
+				}
+				void ReliableUnordered::Demultiplexer::onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer)
+				{
+					//!< Older packets have all been received already, newer ones are beyond the window : the sender shouldn't have sent them
+					const uint16 distance = static_cast<uint16>(pckt->id() - mFirstMissing);
+					if (distance >= mWindowSize)
+						return;
+					if (distance > 0)
+					{
+						if (isReceived(pckt->id()))
+							return; //!< Duplicate
+						setReceived(pckt->id());
+					}
+
+					if (pckt->type() == Packet::Type::FullMessage)
+					{
+						//!< Complete : it's ready as is
+						mReadyMessages.emplace_back(pckt->data(), pckt->datasize(), buffer);
+					}
+					else
+					{
+						if (mPendingFragments.empty())
+							mPendingFragments.resize(2 * mWindowSize);
+						pending(pckt->id()).hold(pckt, buffer);
+						reassemble(pckt->id());
+					}
+
+					if (distance == 0)
+					{
+						//!< Move the window past every packet received
+						++mFirstMissing;
+						while (isReceived(mFirstMissing))
+							clearReceived(mFirstMissing++);
+					}
+				}
+				void ReliableUnordered::Demultiplexer::setReceived(const Packet::Id id)
+				{
+					if (mReceived.empty())
+						mReceived.resize((mWindowSize + 63) / 64);
+					mReceived[(id & (mWindowSize - 1)) / 64] |= uint64(1) << (id % 64);
+				}
+				void ReliableUnordered::Demultiplexer::reassemble(const Packet::Id fragmentId)
+				{
+					//!< Fragment held with the given id, of the given type
+					auto IsHeld = [&](const Packet::Id id, const Packet::Type type) { const Packet* packet = pending(id).packet(); return packet && packet->id() == id && packet->type() == type; };
+					//!< Look for the first fragment then the last one : each fragment in between must have been received
+					Packet::Id firstId = fragmentId;
+					while (pending(firstId).packet()->type() != Packet::Type::FirstFragment)
+					{
+						const Packet::Id previousId = firstId - 1;
+						if (!IsHeld(previousId, Packet::Type::Fragment) && !IsHeld(previousId, Packet::Type::FirstFragment))
+							return;
+						firstId = previousId;
+					}
+					Packet::Id lastId = fragmentId;
+					while (pending(lastId).packet()->type() != Packet::Type::LastFragment)
+					{
+						const Packet::Id nextId = lastId + 1;
+						if (!IsHeld(nextId, Packet::Type::Fragment) && !IsHeld(nextId, Packet::Type::LastFragment))
+							return;
+						lastId = nextId;
+					}
+					const uint16 nbFragments = static_cast<uint16>(lastId - firstId + 1);
+					if (nbFragments > Packet::MaxPacketsPerMessage)
+						return; //!< If we reach this, we likely recieved a malformed packet / hack attempt
+
+					std::vector<uint8> msg;
+					msg.reserve(nbFragments * Packet::DataMaxSize);
+					for (uint16 i = 0; i < nbFragments; ++i)
+					{
+						PendingPacket& fragment = pending(static_cast<Packet::Id>(firstId + i));
+						msg.insert(msg.cend(), fragment.packet()->data(), fragment.packet()->data() + fragment.packet()->datasize());
+						fragment.reset();
+					}
+					mReadyMessages.push_back(std::move(msg));
+				}
+				std::vector<Payload> ReliableUnordered::Demultiplexer::process()
+				{
+					std::vector<Payload> messagesReady = std::move(mReadyMessages);
+					mReadyMessages.clear();
+					return messagesReady;
+				}
+			}
+		}
+	}
+}
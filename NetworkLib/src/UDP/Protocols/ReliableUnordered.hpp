@@ -0,0 +1,82 @@
+#pragma once
+
+#include "UDP/Packet.hpp"
+#include "UDP/Protocols/PendingPacket.hpp"
+#include "UDP/Protocols/ProtocolInterface.hpp"
+#include "UDP/Protocols/ReliableMultiplexer.hpp"
+
+#include <vector>
+
+class ReliableUnordered_Test;
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Messages are delivered once each, as soon as they are complete, whatever order they were sent in : a lost packet only delays its own message.
+				At most windowSize packets are in flight : the receiving end keeps a bit per packet of the window to ignore those already received.
+				*/
+				class ReliableUnordered : public IProtocol
+				{
+					friend class ReliableUnordered_Test;
+				public:
+					static constexpr uint16 DefaultWindowSize = ReliableMultiplexer::DefaultWindowSize;
+
+				public:
+					explicit ReliableUnordered(uint16 windowSize = DefaultWindowSize) : mMultiplexer(windowSize), mDemultiplexer(windowSize) {}
+					~ReliableUnordered() override = default;
+
+					void queue(std::vector<uint8>&& msgData) override { mMultiplexer.queue(std::move(msgData)); }
+					uint16 serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId) override { return mMultiplexer.serialize(buffer, buffersize, datagramId); }
+
+					void onDatagramAcked(const Datagram::ID datagramId) override { mMultiplexer.onDatagramAcked(datagramId); }
+					void onDatagramLost(const Datagram::ID datagramId) override { mMultiplexer.onDatagramLost(datagramId); }
+
+					void onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer) override { mDemultiplexer.onDataReceived(data, datasize, buffer); }
+					std::vector<Payload> process() override { return mDemultiplexer.process(); }
+
+					virtual bool isReliable() const { return true; }
+
+				private:
+					ReliableMultiplexer mMultiplexer;
+
+					class Demultiplexer
+					{
+						friend class ReliableUnordered_Test;
+					public:
+						explicit Demultiplexer(uint16 windowSize = DefaultWindowSize);
+						~Demultiplexer() = default;
+
+						void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer = BufferPool::Buffer());
+						std::vector<Payload> process();
+
+					private:
+						void onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer);
+						//!< Deliver the message the fragment belongs to, if all its fragments are received
+						void reassemble(Packet::Id fragmentId);
+
+						//!< Only valid for ids of the window
+						bool isReceived(Packet::Id id) const { return !mReceived.empty() && (mReceived[(id & (mWindowSize - 1)) / 64] & (uint64(1) << (id % 64))) != 0; }
+						void setReceived(Packet::Id id);
+						void clearReceived(Packet::Id id) { mReceived[(id & (mWindowSize - 1)) / 64] &= ~(uint64(1) << (id % 64)); }
+						PendingPacket& pending(Packet::Id id) { return mPendingFragments[id & (mPendingFragments.size() - 1)]; }
+
+					private:
+						//!< Bit per packet of the window, from mFirstMissing, at index id modulo the window size. Allocated with the first packet received out of order
+						std::vector<uint64> mReceived;
+						//!< Fragments waiting for the rest of their message, at index id modulo the size. Allocated with the first fragment received
+						//!< Fragments of a message can stay behind mFirstMissing while the rest of the window is received : it covers 2 windows
+						std::vector<PendingPacket> mPendingFragments;
+						std::vector<Payload> mReadyMessages; //!< Full messages, delivered without copy
+						const uint16 mWindowSize;
+						Packet::Id mFirstMissing{ 0 }; //!< Every packet before it has been received
+					} mDemultiplexer;
+				};
+			}
+		}
+	}
+}
@@ -0,0 +1,265 @@
+#include "UDP/Protocols/SnapshotDelta.hpp"
+#include "Serialization/Deserializer.hpp"
+#include "Serialization/Serializer.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				namespace
+				{
+					//!< Part header : has baseline [distance to the baseline] part index, is last part. The snapshot id is the packet one.
+					constexpr size_t PartHeaderBits(const bool hasBaseline) { return 1 + (hasBaseline ? 5 : 0) + 6 + 1; }
+					static_assert(SnapshotDelta::Window == 32 && SnapshotDelta::MaxParts == 64, "PartHeaderBits must match the window and parts sizes");
+				}
+
+				void SnapshotDelta::Multiplexer::queue(std::vector<uint8>&& msgData)
+				{
+					const SnapshotId id = mNextId++;
+					SentSnapshot& sentSnapshot = mSent[id % Window];
+					sentSnapshot = SentSnapshot();
+					if (!sentSnapshot.snapshot.deserialize(msgData.data(), msgData.size()))
+					{
+						assert(false); //!< Not a snapshot serialized by Replication::Snapshot::serialize
+						mIsSending = false;
+						return;
+					}
+					sentSnapshot.id = id;
+					sentSnapshot.isValid = true;
+					//!< Parts of snapshots out of the window won't be of any use
+					mSentParts.erase(std::remove_if(mSentParts.begin(), mSentParts.end(), [&](const SentPart& part) { return static_cast<SnapshotId>(id - part.snapshotId) >= Window; }), mSentParts.end());
+
+					//!< A snapshot not fully sent yet is replaced : the latest state is all that matters
+					mSending = id;
+					mIsSending = true;
+					mNextObject = 0;
+					mSendingHasBaseline = mHasBaseline && static_cast<SnapshotId>(id - mBaseline) < Window && sent(mBaseline) != nullptr;
+					mSendingBaseline = mBaseline;
+				}
+				uint16 SnapshotDelta::Multiplexer::serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID datagramId)
+				{
+					if (!mIsSending || buffersize <= Packet::HeaderSize)
+						return 0;
+
+					SentSnapshot& sentSnapshot = *sent(mSending);
+					const Replication::Snapshot& snapshot = sentSnapshot.snapshot;
+					const Replication::Snapshot* baseline = mSendingHasBaseline ? &sent(mSendingBaseline)->snapshot : nullptr;
+					const size_t maxBits = (std::min(buffersize, Packet::PacketMaxSize) - Packet::HeaderSize) * 8;
+					const size_t headerBits = PartHeaderBits(baseline != nullptr);
+
+					//!< Add objects while they fit
+					size_t nbObjects = 0;
+					size_t objectsBits = 0;
+					Replication::ObjectId minId = 0;
+					for (size_t index = mNextObject; index < snapshot.nbObjects(); ++index)
+					{
+						const size_t objectBits = snapshot.objectBits(index, baseline, minId);
+						if (headerBits + Replication::Snapshot::NbObjectsBits(nbObjects + 1) + objectsBits + objectBits > maxBits)
+							break;
+						objectsBits += objectBits;
+						minId = snapshot.objectId(index) + 1;
+						++nbObjects;
+					}
+					const bool isLast = (mNextObject + nbObjects == snapshot.nbObjects());
+					if (nbObjects == 0 && (!isLast || headerBits + Replication::Snapshot::NbObjectsBits(0) > maxBits))
+					{
+						if (buffersize >= Packet::PacketMaxSize)
+						{
+							assert(false); //!< Object too large to fit in a packet
+							mIsSending = false;
+						}
+						return 0; //!< Wait for a datagram with more room
+					}
+					if (!isLast && sentSnapshot.nbParts + 1 >= MaxParts)
+					{
+						assert(false); //!< Snapshot too large
+						mIsSending = false;
+						return 0;
+					}
+
+					Serialization::Serializer serializer;
+					serializer.write(baseline != nullptr);
+					if (baseline)
+						serializer.write(static_cast<uint8>(mSending - mSendingBaseline), static_cast<uint8>(1), static_cast<uint8>(Window - 1));
+					serializer.write(sentSnapshot.nbParts, static_cast<uint8>(0), static_cast<uint8>(MaxParts - 1));
+					serializer.write(isLast);
+					const bool written = snapshot.write(serializer, baseline, mNextObject, nbObjects);
+					assert(written && serializer.bufferSize() * 8 <= maxBits);
+
+					Packet::Header header;
+					header.id = mSending;
+					header.size = static_cast<uint16>(serializer.bufferSize());
+					header.type = Packet::Type::FullMessage;
+					memcpy(buffer, &header, Packet::HeaderSize);
+					memcpy(buffer + Packet::HeaderSize, serializer.buffer(), serializer.bufferSize());
+
+					mSentParts.push_back({ datagramId, mSending });
+					++sentSnapshot.nbParts;
+					mNextObject += nbObjects;
+					if (isLast)
+					{
+						sentSnapshot.isFullySent = true;
+						mIsSending = false;
+					}
+					return Packet::HeaderSize + header.size;
+				}
+
+				void SnapshotDelta::Multiplexer::onDatagramAcked(const Datagram::ID datagramId)
+				{
+					const auto it = std::find_if(mSentParts.begin(), mSentParts.end(), [&](const SentPart& part) { return part.datagramId == datagramId; });
+					if (it == mSentParts.end())
+						return;
+					const SnapshotId snapshotId = it->snapshotId;
+					mSentParts.erase(it);
+					SentSnapshot* sentSnapshot = sent(snapshotId);
+					if (!sentSnapshot)
+						return;
+					++sentSnapshot->nbAckedParts;
+					//!< Once all its parts are received, the other end can decode snapshots against this one
+					if (sentSnapshot->isFullySent && sentSnapshot->nbAckedParts == sentSnapshot->nbParts
+						&& (!mHasBaseline || Utils::IsSequenceNewer(snapshotId, mBaseline)))
+					{
+						mBaseline = snapshotId;
+						mHasBaseline = true;
+					}
+				}
+				void SnapshotDelta::Multiplexer::onDatagramLost(const Datagram::ID datagramId)
+				{
+					//!< The snapshot will never be fully received : it's not sent again, a newer one will follow
+					const auto it = std::find_if(mSentParts.begin(), mSentParts.end(), [&](const SentPart& part) { return part.datagramId == datagramId; });
+					if (it != mSentParts.end())
+						mSentParts.erase(it);
+				}
+
+				SnapshotDelta::Multiplexer::SentSnapshot* SnapshotDelta::Multiplexer::sent(const SnapshotId id)
+				{
+					SentSnapshot& sentSnapshot = mSent[id % Window];
+					return (sentSnapshot.isValid && sentSnapshot.id == id) ? &sentSnapshot : nullptr;
+				}
+
+				void SnapshotDelta::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize)
+				{
+					//!< Extract packets from buffer
+					uint16 processedDataSize = 0;
+					while (processedDataSize < datasize)
+					{
+						const Packet* pckt = reinterpret_cast<const Packet*>(data);
+						if (processedDataSize + Packet::HeaderSize > datasize || processedDataSize + pckt->size() > datasize || pckt->datasize() > Packet::DataMaxSize || pckt->type() != Packet::Type::FullMessage)
+						{
+							//!< Malformed packet or buffer
+							return;
+						}
+						processedDataSize += pckt->size();
+						data += pckt->size();
+						onPartReceived(pckt->id(), pckt->data(), pckt->datasize());
+					}
+				}
+				std::vector<Payload> SnapshotDelta::Demultiplexer::process()
+				{
+					std::vector<Payload> messagesReady = std::move(mReadyMessages);
+					mReadyMessages.clear();
+					return messagesReady;
+				}
+
+				void SnapshotDelta::Demultiplexer::onPartReceived(const SnapshotId id, const uint8* data, const uint16 datasize)
+				{
+					Serialization::Deserializer deserializer(data, datasize);
+					bool hasBaseline = false;
+					uint8 distance = 0;
+					uint8 part = 0;
+					bool isLast = false;
+					if (!deserializer.read(hasBaseline)
+						|| (hasBaseline && !deserializer.read(distance, static_cast<uint8>(1), static_cast<uint8>(Window - 1)))
+						|| !deserializer.read(part, static_cast<uint8>(0), static_cast<uint8>(MaxParts - 1))
+						|| !deserializer.read(isLast))
+					{
+						return;
+					}
+					const Replication::Snapshot* baseline = nullptr;
+					if (hasBaseline)
+					{
+						baseline = received(static_cast<SnapshotId>(id - distance));
+						if (!baseline)
+							return; //!< Baseline not received or too old : this snapshot can't be decoded
+					}
+					Replication::Snapshot snapshot;
+					if (!snapshot.read(deserializer, baseline))
+						return;
+
+					if (part == 0 && isLast)
+					{
+						onSnapshotReceived(id, std::move(snapshot));
+						return;
+					}
+
+					PartialSnapshot& partial = mPartials[id % Window];
+					if (!partial.isValid || partial.id != id)
+					{
+						if (partial.isValid && Utils::IsSequenceNewer(partial.id, id))
+							return; //!< Older than the snapshot being assembled
+						partial = PartialSnapshot();
+						partial.id = id;
+						partial.isValid = true;
+					}
+					const uint64 partBit = uint64(1) << part;
+					if ((partial.receivedParts & partBit) || (partial.nbParts != 0 && part >= partial.nbParts) || (isLast && partial.receivedParts >> part))
+						return; //!< Duplicate or inconsistent part
+					if (isLast)
+						partial.nbParts = part + 1;
+					if (partial.parts.size() <= part)
+						partial.parts.resize(part + 1);
+					partial.parts[part] = std::move(snapshot);
+					partial.receivedParts |= partBit;
+					if (partial.nbParts == 0 || partial.receivedParts != (uint64(-1) >> (64 - partial.nbParts)))
+						return;
+
+					//!< All parts received
+					Replication::Snapshot full = std::move(partial.parts[0]);
+					for (uint8 i = 1; i < partial.nbParts; ++i)
+					{
+						const Replication::Snapshot& next = partial.parts[i];
+						if (full.nbObjects() != 0 && next.nbObjects() != 0 && next.objectId(0) <= full.objectId(full.nbObjects() - 1))
+						{
+							partial = PartialSnapshot(); //!< Malformed : objects must have increasing ids
+							return;
+						}
+						full.append(next);
+					}
+					partial = PartialSnapshot();
+					onSnapshotReceived(id, std::move(full));
+				}
+				const Replication::Snapshot* SnapshotDelta::Demultiplexer::received(const SnapshotId id) const
+				{
+					const ReceivedSnapshot& receivedSnapshot = mReceived[id % Window];
+					return (receivedSnapshot.isValid && receivedSnapshot.id == id) ? &receivedSnapshot.snapshot : nullptr;
+				}
+				void SnapshotDelta::Demultiplexer::onSnapshotReceived(const SnapshotId id, Replication::Snapshot&& snapshot)
+				{
+					const bool isNewest = !mHasDelivered || Utils::IsSequenceNewer(id, mLastDelivered);
+					if (isNewest)
+					{
+						mReadyMessages.emplace_back(snapshot.serialize());
+						mLastDelivered = id;
+						mHasDelivered = true;
+					}
+					//!< Even older than the last delivered, it can be the baseline of the next ones
+					ReceivedSnapshot& receivedSnapshot = mReceived[id % Window];
+					if (receivedSnapshot.isValid && receivedSnapshot.id != id && Utils::IsSequenceNewer(receivedSnapshot.id, id))
+						return;
+					receivedSnapshot.snapshot = std::move(snapshot);
+					receivedSnapshot.id = id;
+					receivedSnapshot.isValid = true;
+				}
+			}
+		}
+	}
+}
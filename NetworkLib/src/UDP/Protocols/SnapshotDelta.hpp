@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Replication/Snapshot.hpp"
+#include "UDP/Packet.hpp"
+#include "UDP/Protocols/ProtocolInterface.hpp"
+
+#include <array>
+#include <vector>
+
+class SnapshotDelta_Test;
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Snapshots of replicated objects, each sent as a delta against the last one the other end acknowledged.
+				Messages queued and delivered are full snapshots, see Replication::Snapshot::serialize.
+				Only the latest snapshot is sent : one queued before the previous one is fully sent replaces it. Lost ones aren't sent again.
+				A snapshot larger than a packet is split into parts, each in its own datagram : it's received once all its parts are.
+				It becomes the baseline once all the datagrams of its parts are acked.
+				*/
+				class SnapshotDelta : public IProtocol
+				{
+					friend class SnapshotDelta_Test;
+				public:
+					using SnapshotId = uint16;
+					static constexpr SnapshotId Window = 32; //!< Snapshots kept by both ends : baselines are never older
+					static constexpr uint8 MaxParts = 64;
+
+				public:
+					SnapshotDelta() = default;
+					~SnapshotDelta() override = default;
+
+					void queue(std::vector<uint8>&& msgData) override { mMultiplexer.queue(std::move(msgData)); }
+					uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID datagramId) override { return mMultiplexer.serialize(buffer, buffersize, datagramId); }
+
+					void onDatagramAcked(Datagram::ID datagramId) override { mMultiplexer.onDatagramAcked(datagramId); }
+					void onDatagramLost(Datagram::ID datagramId) override { mMultiplexer.onDatagramLost(datagramId); }
+
+					void onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer&) override { mDemultiplexer.onDataReceived(data, datasize); }
+					std::vector<Payload> process() override { return mDemultiplexer.process(); }
+
+					virtual bool isReliable() const { return false; }
+
+				private:
+					class Multiplexer
+					{
+						friend class SnapshotDelta_Test;
+					public:
+						Multiplexer() = default;
+						~Multiplexer() = default;
+
+						void queue(std::vector<uint8>&& msgData);
+						uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID datagramId);
+
+						void onDatagramAcked(Datagram::ID datagramId);
+						void onDatagramLost(Datagram::ID datagramId);
+
+					private:
+						struct SentSnapshot
+						{
+							Replication::Snapshot snapshot;
+							SnapshotId id{ 0 };
+							uint8 nbParts{ 0 };
+							uint8 nbAckedParts{ 0 };
+							bool isFullySent{ false };
+							bool isValid{ false };
+						};
+						struct SentPart
+						{
+							Datagram::ID datagramId;
+							SnapshotId snapshotId;
+						};
+
+					private:
+						SentSnapshot* sent(SnapshotId id);
+
+					private:
+						std::array<SentSnapshot, Window> mSent; //!< At index id modulo the window
+						std::vector<SentPart> mSentParts; //!< Waiting for their datagram to be acked or lost
+						SnapshotId mNextId{ 0 };
+						SnapshotId mBaseline{ 0 };
+						bool mHasBaseline{ false };
+						//!< Snapshot being sent and its baseline, from the object mNextObject
+						SnapshotId mSending{ 0 };
+						bool mIsSending{ false };
+						bool mSendingHasBaseline{ false };
+						SnapshotId mSendingBaseline{ 0 };
+						size_t mNextObject{ 0 };
+					} mMultiplexer;
+
+					class Demultiplexer
+					{
+						friend class SnapshotDelta_Test;
+					public:
+						Demultiplexer() = default;
+						~Demultiplexer() = default;
+
+						void onDataReceived(const uint8* data, uint16 datasize);
+						std::vector<Payload> process();
+
+					private:
+						struct ReceivedSnapshot
+						{
+							Replication::Snapshot snapshot;
+							SnapshotId id{ 0 };
+							bool isValid{ false };
+						};
+						//!< Snapshot split into parts, until they are all received
+						struct PartialSnapshot
+						{
+							std::vector<Replication::Snapshot> parts;
+							uint64 receivedParts{ 0 };
+							SnapshotId id{ 0 };
+							uint8 nbParts{ 0 }; //!< 0 until the last part is received
+							bool isValid{ false };
+						};
+
+					private:
+						void onPartReceived(SnapshotId id, const uint8* data, uint16 datasize);
+						const Replication::Snapshot* received(SnapshotId id) const;
+						void onSnapshotReceived(SnapshotId id, Replication::Snapshot&& snapshot);
+
+					private:
+						//!< At index id modulo the window. Only full snapshots are kept : a baseline is never replaced by a snapshot which isn't complete
+						std::array<ReceivedSnapshot, Window> mReceived;
+						std::array<PartialSnapshot, Window> mPartials;
+						std::vector<Payload> mReadyMessages;
+						SnapshotId mLastDelivered{ 0 };
+						bool mHasDelivered{ false };
+					} mDemultiplexer;
+				};
+			}
+		}
+	}
+}
@@ -61,7 +61,7 @@ namespace Bousk
 					}
 					return serializedSize;
 				}
-				void UnreliableOrdered::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize)
+				void UnreliableOrdered::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer)
 				{
 					//!< Extract packets from buffer
 					uint16 processedDataSize = 0;
@@ -73,103 +73,109 @@ namespace Bousk
 							//!< Malformed packet or buffer
 							return;
 						}
-						onPacketReceived(pckt);
+						onPacketReceived(pckt, buffer);
 						processedDataSize += pckt->size();
 						data += pckt->size();
 					}
 				}
-				void UnreliableOrdered::Demultiplexer::onPacketReceived(const Packet* pckt)
+				void UnreliableOrdered::Demultiplexer::onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer)
 				{
 					if (!Utils::IsSequenceNewer(pckt->id(), mLastProcessed))
 						return; //!< Packet is too old
 
-								//!< Find the place for this packet, our queue must remain ordered
-					if (mPendingQueue.empty() || Utils::IsSequenceNewer(pckt->id(), mPendingQueue.back().id()))
+					const uint16 distance = static_cast<uint16>(pckt->id() - mLastProcessed - 1);
+					if (distance >= WindowSize)
 					{
-						mPendingQueue.push_back(*pckt);
+						//!< Make room for it : older messages are delivered if complete, abandoned otherwise
+						extractMessages(distance - WindowSize + 1, true);
 					}
-					else
+					if (pckt->type() == Packet::Type::FullMessage && mNbPending == 0)
 					{
-						//!< Find the first iterator with an id equals to or newer than our packet, we must place the packet before that one
-						auto insertLocation = std::find_if(mPendingQueue.cbegin(), mPendingQueue.cend(), [&pckt](const Packet& p) { return p.id() == pckt->id() || Utils::IsSequenceNewer(p.id(), pckt->id()); });
-						//!< Make sure we don't insert a packet received multiple times
-						if (insertLocation->id() != pckt->id())
-						{
-							mPendingQueue.insert(insertLocation, *pckt);
-						}
+						//!< Nothing to reassemble before it : the message is ready as is
+						mReadyMessages.emplace_back(pckt->data(), pckt->datasize(), buffer);
+						mLastProcessed = pckt->id();
+						return;
 					}
+
+					if (mPendingQueue.empty())
+						mPendingQueue.resize(WindowSize);
+					PendingPacket& pendingPacket = pending(pckt->id());
+					if (pendingPacket.packet())
+						return; //!< Duplicate
+					pendingPacket.hold(pckt, buffer);
+					++mNbPending;
 				}
-				std::vector<std::vector<uint8>> UnreliableOrdered::Demultiplexer::process()
+				void UnreliableOrdered::Demultiplexer::extractMessages(const uint16 nbPackets, const bool abandonIncomplete)
 				{
-					std::vector<std::vector<uint8>> messagesReady;
-
-					auto itPacket = mPendingQueue.cbegin();
-					auto itEnd = mPendingQueue.cend();
-					std::vector<Packet>::const_iterator newestProcessedPacket;
-					//!< Our queue is ordered, just go through and reassemble packets
-					while (itPacket != itEnd)
+					const Packet::Id firstId = mLastProcessed + 1;
+					//!< Further packets would be out of the ring
+					const uint16 nbScanned = std::min(nbPackets, WindowSize);
+					uint16 nbProcessed = 0;
+					for (uint16 i = 0; i < nbScanned && mNbPending > 0; ++i)
 					{
-						if (itPacket->type() == Packet::Type::FullMessage)
+						const Packet* packet = pending(static_cast<Packet::Id>(firstId + i)).packet();
+						if (!packet)
+							continue;
+						if (packet->type() == Packet::Type::FullMessage)
 						{
-							//!< Full packet, just take it
-							std::vector<uint8> msg(itPacket->data(), itPacket->data() + itPacket->datasize());
-							messagesReady.push_back(std::move(msg));
-							newestProcessedPacket = itPacket;
-							++itPacket;
+							//!< Full packet, just take it without copy
+							mReadyMessages.emplace_back(packet->data(), packet->datasize(), pending(packet->id()).buffer());
+							nbProcessed = i + 1;
+							continue;
 						}
-						else if (itPacket->type() == Packet::Type::FirstFragment)
-						{
-							//!< Check if the message is ready (fully received)
-							std::vector<uint8> msg = [&]()
-							{
-								std::vector<uint8> msg(itPacket->data(), itPacket->data() + itPacket->datasize());
-								auto expectedPacketId = itPacket->id();
-								++itPacket;
-								++expectedPacketId;
-								while (itPacket != itEnd && itPacket->id() == expectedPacketId)
-								{
-									if (itPacket->type() == Packet::Type::LastFragment)
-									{
-										//!< Last fragment reached, the message is full
-										msg.insert(msg.cend(), itPacket->data(), itPacket->data() + itPacket->datasize());
-										return msg;
-									}
-									else if (itPacket->type() != Packet::Type::Fragment)
-									{
-										//!< If we reach this, we likely recieved a malformed packet / hack attempt
-										msg.clear();
-										return msg;
-									}
+						if (packet->type() != Packet::Type::FirstFragment)
+							continue; //!< Remaining of an abandoned message, or malformed packet
 
-									msg.insert(msg.cend(), itPacket->data(), itPacket->data() + itPacket->datasize());
-									++itPacket;
-									++expectedPacketId;
-								}
-								msg.clear();
-								return msg;
-							}();
-							if (!msg.empty())
+						//!< Check if the message is ready (fully received)
+						uint16 nbFragments = 1;
+						bool isMessageFull = false;
+						for (; i + nbFragments < nbScanned; ++nbFragments)
+						{
+							const Packet* fragment = pending(static_cast<Packet::Id>(firstId + i + nbFragments)).packet();
+							if (!fragment || (fragment->type() != Packet::Type::Fragment && fragment->type() != Packet::Type::LastFragment))
+								break; //!< Missing fragment, or malformed packet / hack attempt
+							if (fragment->type() == Packet::Type::LastFragment)
 							{
-								//!< We do have a message
-								messagesReady.push_back(std::move(msg));
-								newestProcessedPacket = itPacket;
-								//!< Move iterator after the last packet of the message
-								++itPacket;
+								//!< Last fragment reached, the message is full
+								isMessageFull = true;
+								++nbFragments;
+								break;
 							}
 						}
-						else
+						if (!isMessageFull)
+							continue;
+
+						std::vector<uint8> msg;
+						msg.reserve(nbFragments * Packet::DataMaxSize);
+						for (uint16 j = 0; j < nbFragments; ++j)
 						{
-							++itPacket;
+							const Packet* fragment = pending(static_cast<Packet::Id>(firstId + i + j)).packet();
+							msg.insert(msg.cend(), fragment->data(), fragment->data() + fragment->datasize());
 						}
+						mReadyMessages.push_back(std::move(msg));
+						i += nbFragments - 1;
+						nbProcessed = i + 1;
 					}
 
-					//!< Remove every processed and partial packets until the last one processed included
-					if (!messagesReady.empty())
+					//!< Release packets of delivered messages, and those of older incomplete ones which can't be delivered anymore
+					const uint16 nbReleased = abandonIncomplete ? nbScanned : nbProcessed;
+					for (uint16 i = 0; i < nbReleased && mNbPending > 0; ++i)
 					{
-						mLastProcessed = newestProcessedPacket->id();
-						mPendingQueue.erase(mPendingQueue.cbegin(), std::next(newestProcessedPacket));
+						PendingPacket& pendingPacket = pending(static_cast<Packet::Id>(firstId + i));
+						if (!pendingPacket.packet())
+							continue;
+						pendingPacket.reset();
+						--mNbPending;
 					}
-
+					mLastProcessed += abandonIncomplete ? nbPackets : nbProcessed;
+				}
+				std::vector<Payload> UnreliableOrdered::Demultiplexer::process()
+				{
+					//!< Messages ready on reception are older than any pending packet
+					if (mNbPending > 0)
+						extractMessages(WindowSize, false);
+					std::vector<Payload> messagesReady = std::move(mReadyMessages);
+					mReadyMessages.clear();
 					return messagesReady;
 				}
 			}
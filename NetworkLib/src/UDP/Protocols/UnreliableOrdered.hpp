@@ -2,6 +2,7 @@
 
 #include "UDP/AckHandler.hpp"
 #include "UDP/Packet.hpp"
+#include "UDP/Protocols/PendingPacket.hpp"
 #include "UDP/Protocols/ProtocolInterface.hpp"
 
 #include <vector>
@@ -17,6 +18,11 @@ namespace Bousk
 		{
 			namespace Protocols
 			{
+				/*
+				Messages are delivered at most once each, never older than one already delivered.
+				Packets received out of order wait in a ring covering the window following the last message delivered.
+				A fragmented message is abandoned once a newer message is delivered, or when packets newer than the window push it out.
+				*/
 				class UnreliableOrdered : public IProtocol
 				{
 					friend class Multiplexer_Test;
@@ -28,8 +34,8 @@ namespace Bousk
 					void queue(std::vector<uint8>&& msgData) override { mMultiplexer.queue(std::move(msgData)); }
 					uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID datagramId) override { return mMultiplexer.serialize(buffer, buffersize, datagramId); }
 
-					void onDataReceived(const uint8* data, uint16 datasize) override { mDemultiplexer.onDataReceived(data, datasize); }
-					std::vector<std::vector<uint8>> process() override { return mDemultiplexer.process(); }
+					void onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer) override { mDemultiplexer.onDataReceived(data, datasize, buffer); }
+					std::vector<Payload> process() override { return mDemultiplexer.process(); }
 
 					virtual bool isReliable() const { return false; }
 
@@ -51,18 +57,30 @@ namespace Bousk
 					class Demultiplexer
 					{
 						friend class Demultiplexer_Test;
+					public:
+						//!< Large enough for the biggest message to be reassembled
+						static constexpr uint16 WindowSize = 2 * Packet::MaxPacketsPerMessage;
+
 					public:
 						Demultiplexer() = default;
 						~Demultiplexer() = default;
 
-						void onDataReceived(const uint8* data, uint16 datasize);
-						std::vector<std::vector<uint8>> process();
+						void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer = BufferPool::Buffer());
+						std::vector<Payload> process();
 
 					private:
-						void onPacketReceived(const Packet* pckt);
+						void onPacketReceived(const Packet* pckt, const BufferPool::Buffer& buffer);
+
+						PendingPacket& pending(Packet::Id id) { return mPendingQueue[id & (WindowSize - 1)]; }
+						//!< Move complete messages among the nbPackets following the last processed one to the ready messages
+						//!< Packets until the last one delivered are released, or all nbPackets when abandoning incomplete messages
+						void extractMessages(uint16 nbPackets, bool abandonIncomplete);
 
 					private:
-						std::vector<Packet> mPendingQueue;
+						//!< Slot per packet of the window, at index id modulo its size. Allocated with the first packet waiting
+						std::vector<PendingPacket> mPendingQueue;
+						std::vector<Payload> mReadyMessages; //!< Full messages, older than any pending packet
+						uint16 mNbPending{ 0 };
 						Packet::Id mLastProcessed{ std::numeric_limits<Packet::Id>::max() };
 					} mDemultiplexer;
 				};
@@ -0,0 +1,140 @@
+#include "UDP/Protocols/UnreliableSequenced.hpp"
+#include "Utils.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				uint64 UnreliableSequenced::Key(const uint8* data, const uint8 keySize)
+				{
+					uint64 key = 0;
+					memcpy(&key, data, keySize);
+					return key;
+				}
+
+				UnreliableSequenced::Multiplexer::Multiplexer(const uint8 keySize)
+					: mKeySize(keySize)
+				{
+					assert(keySize <= MaxKeySize);
+				}
+				void UnreliableSequenced::Multiplexer::queue(std::vector<uint8>&& msgData)
+				{
+					assert(msgData.size() <= Packet::DataMaxSize);
+					assert(msgData.size() >= mKeySize);
+					const uint64 key = Key(msgData.data(), mKeySize);
+					KeyState& keyState = mKeys[key];
+					const Packet::Id sequence = keyState.nextSequence++;
+					if (keyState.queuedIndex != NotQueued)
+					{
+						//!< Previous state not sent yet : replace it
+						QueuedMessage& queued = mQueue[keyState.queuedIndex];
+						queued.data = std::move(msgData);
+						queued.sequence = sequence;
+						return;
+					}
+					keyState.queuedIndex = mQueue.size();
+					mQueue.push_back({ std::move(msgData), key, sequence });
+				}
+				uint16 UnreliableSequenced::Multiplexer::serialize(uint8* buffer, const uint16 buffersize, const Datagram::ID)
+				{
+					uint16 serializedSize = 0;
+					for (; mFirstQueued < mQueue.size(); ++mFirstQueued)
+					{
+						QueuedMessage& queued = mQueue[mFirstQueued];
+						const uint16 packetSize = static_cast<uint16>(Packet::HeaderSize + queued.data.size());
+						if (serializedSize + packetSize > buffersize)
+							break; //!< Not enough room for next packet
+
+						Packet::Header header;
+						header.id = queued.sequence;
+						header.size = static_cast<uint16>(queued.data.size());
+						header.type = Packet::Type::FullMessage;
+						memcpy(buffer, &header, Packet::HeaderSize);
+						memcpy(buffer + Packet::HeaderSize, queued.data.data(), queued.data.size());
+						serializedSize += packetSize;
+						buffer += packetSize;
+
+						mKeys[queued.key].queuedIndex = NotQueued;
+						queued.data = std::vector<uint8>();
+					}
+					if (mFirstQueued == mQueue.size())
+					{
+						mQueue.clear();
+						mFirstQueued = 0;
+					}
+					else if (mFirstQueued > mQueue.size() / 2)
+					{
+						//!< Sent messages keep piling up before those waiting : remove them
+						mQueue.erase(mQueue.begin(), mQueue.begin() + mFirstQueued);
+						mFirstQueued = 0;
+						for (size_t i = 0; i < mQueue.size(); ++i)
+							mKeys[mQueue[i].key].queuedIndex = i;
+					}
+					return serializedSize;
+				}
+
+				UnreliableSequenced::Demultiplexer::Demultiplexer(const uint8 keySize, const size_t maxKeys)
+					: mMaxKeys(maxKeys)
+					, mKeySize(keySize)
+				{
+					assert(keySize <= MaxKeySize);
+					assert(maxKeys > 0);
+				}
+				void UnreliableSequenced::Demultiplexer::onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer)
+				{
+					//!< Extract packets from buffer
+					uint16 processedDataSize = 0;
+					while (processedDataSize < datasize)
+					{
+						const Packet* pckt = reinterpret_cast<const Packet*>(data);
+						if (processedDataSize + pckt->size() > datasize || pckt->datasize() > Packet::DataMaxSize || pckt->datasize() < mKeySize || pckt->type() != Packet::Type::FullMessage)
+						{
+							//!< Malformed packet or buffer
+							return;
+						}
+						processedDataSize += pckt->size();
+						data += pckt->size();
+
+						const uint64 key = Key(pckt->data(), mKeySize);
+						const auto it = mLastDelivered.find(key);
+						if (it != mLastDelivered.end())
+						{
+							if (!Utils::IsSequenceNewer(pckt->id(), it->second.sequence))
+								continue; //!< Not newer than the state already delivered
+							it->second.sequence = pckt->id();
+							mKeysOrder.splice(mKeysOrder.end(), mKeysOrder, it->second.order);
+						}
+						else if (mLastDelivered.size() < mMaxKeys)
+						{
+							mKeysOrder.push_back(key);
+							mLastDelivered.emplace(key, DeliveredKey{ pckt->id(), std::prev(mKeysOrder.end()) });
+						}
+						else
+						{
+							//!< Forget the least recently updated key, reusing its place in the list
+							mLastDelivered.erase(mKeysOrder.front());
+							mKeysOrder.splice(mKeysOrder.end(), mKeysOrder, mKeysOrder.begin());
+							mKeysOrder.back() = key;
+							mLastDelivered.emplace(key, DeliveredKey{ pckt->id(), std::prev(mKeysOrder.end()) });
+						}
+						mReadyMessages.emplace_back(pckt->data(), pckt->datasize(), buffer);
+					}
+				}
+				std::vector<Payload> UnreliableSequenced::Demultiplexer::process()
+				{
+					std::vector<Payload> messagesReady = std::move(mReadyMessages);
+					mReadyMessages.clear();
+					return messagesReady;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "UDP/Packet.hpp"
+#include "UDP/Protocols/ProtocolInterface.hpp"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class UnreliableSequenced_Test;
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			namespace Protocols
+			{
+				/*
+				Latest state only : each message is keyed by its first keySize bytes, such as the id of the entity it updates.
+				A message queued while one with the same key is still waiting to be sent replaces it, keeping its place in the queue.
+				The receiving end drops messages older than the last one delivered with the same key.
+				Keys come from the other end : it remembers up to maxKeys of them, forgetting the least recently updated one beyond that.
+				The next message of a forgotten key is delivered whatever its sequence.
+				Messages must fit in a single packet. With a key size of 0, all messages share the same key.
+				*/
+				class UnreliableSequenced : public IProtocol
+				{
+					friend class UnreliableSequenced_Test;
+				public:
+					static constexpr uint8 MaxKeySize = sizeof(uint64);
+					static constexpr size_t DefaultMaxKeys = 4096;
+
+				public:
+					explicit UnreliableSequenced(uint8 keySize = sizeof(uint16), size_t maxKeys = DefaultMaxKeys) : mMultiplexer(keySize), mDemultiplexer(keySize, maxKeys) {}
+					~UnreliableSequenced() override = default;
+
+					void queue(std::vector<uint8>&& msgData) override { mMultiplexer.queue(std::move(msgData)); }
+					uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID datagramId) override { return mMultiplexer.serialize(buffer, buffersize, datagramId); }
+
+					void onDataReceived(const uint8* data, const uint16 datasize, const BufferPool::Buffer& buffer) override { mDemultiplexer.onDataReceived(data, datasize, buffer); }
+					std::vector<Payload> process() override { return mDemultiplexer.process(); }
+
+					virtual bool isReliable() const { return false; }
+
+				private:
+					//!< Key of a message, its first keySize bytes
+					static uint64 Key(const uint8* data, uint8 keySize);
+
+					class Multiplexer
+					{
+						friend class UnreliableSequenced_Test;
+					public:
+						explicit Multiplexer(uint8 keySize);
+						~Multiplexer() = default;
+
+						void queue(std::vector<uint8>&& msgData);
+						uint16 serialize(uint8* buffer, uint16 buffersize, Datagram::ID);
+
+					private:
+						static constexpr size_t NotQueued = static_cast<size_t>(-1);
+						struct QueuedMessage
+						{
+							std::vector<uint8> data;
+							uint64 key;
+							Packet::Id sequence;
+						};
+						struct KeyState
+						{
+							size_t queuedIndex{ NotQueued }; //!< Index of its message waiting in mQueue, if any
+							Packet::Id nextSequence{ 0 };
+						};
+
+					private:
+						std::vector<QueuedMessage> mQueue; //!< Messages from mFirstQueued are waiting to be sent
+						std::unordered_map<uint64, KeyState> mKeys;
+						size_t mFirstQueued{ 0 };
+						const uint8 mKeySize;
+					} mMultiplexer;
+					class Demultiplexer
+					{
+						friend class UnreliableSequenced_Test;
+					public:
+						explicit Demultiplexer(uint8 keySize, size_t maxKeys = DefaultMaxKeys);
+						~Demultiplexer() = default;
+
+						void onDataReceived(const uint8* data, uint16 datasize, const BufferPool::Buffer& buffer = BufferPool::Buffer());
+						std::vector<Payload> process();
+
+					private:
+						struct DeliveredKey
+						{
+							Packet::Id sequence; //!< Of the last message delivered
+							std::list<uint64>::iterator order; //!< Position in mKeysOrder
+						};
+
+					private:
+						std::unordered_map<uint64, DeliveredKey> mLastDelivered;
+						std::list<uint64> mKeysOrder; //!< Keys from the least recently updated one
+						std::vector<Payload> mReadyMessages; //!< Delivered without copy
+						const size_t mMaxKeys;
+						const uint8 mKeySize;
+					} mDemultiplexer;
+				};
+			}
+		}
+	}
+}
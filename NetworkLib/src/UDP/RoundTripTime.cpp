@@ -0,0 +1,37 @@
+#include "UDP/RoundTripTime.hpp"
+
+#include <algorithm>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			void RoundTripTime::onSample(const std::chrono::milliseconds rtt)
+			{
+				const std::chrono::microseconds sample = std::max(std::chrono::milliseconds(0), rtt);
+				if (!mHasSample)
+				{
+					mSmoothed = sample;
+					mVariation = sample / 2;
+					mHasSample = true;
+				}
+				else
+				{
+					//!< RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, then SRTT = 7/8 SRTT + 1/8 R
+					const std::chrono::microseconds delta = (mSmoothed > sample) ? mSmoothed - sample : sample - mSmoothed;
+					mVariation = (3 * mVariation + delta) / 4;
+					mSmoothed = (7 * mSmoothed + sample) / 8;
+				}
+				//!< RTO = SRTT + 4 RTTVAR, the clock granularity being a millisecond
+				const std::chrono::microseconds timeout = mSmoothed + std::max<std::chrono::microseconds>(std::chrono::milliseconds(1), 4 * mVariation);
+				mTimeout = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(timeout), MinTimeout, MaxTimeout);
+			}
+			void RoundTripTime::onTimeout()
+			{
+				mTimeout = std::min(mTimeout * 2, MaxTimeout);
+			}
+		}
+	}
+}
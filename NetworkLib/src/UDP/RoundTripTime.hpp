@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Types.hpp>
+
+#include <chrono>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			/*
+			Smoothed round trip time to a distant client and its variation, as TCP estimates them (RFC 6298).
+			The retransmission timeout derives from them : data not acked within that delay is considered lost.
+			Each timeout doubles it until a new sample comes, not to flood a congested link with retransmissions.
+			*/
+			class RoundTripTime
+			{
+			public:
+				static constexpr std::chrono::milliseconds InitialTimeout{ 200 };
+				static constexpr std::chrono::milliseconds MinTimeout{ 20 };
+				static constexpr std::chrono::milliseconds MaxTimeout{ 2000 };
+
+			public:
+				RoundTripTime() = default;
+
+				void onSample(std::chrono::milliseconds rtt);
+				void onTimeout();
+
+				bool hasSample() const { return mHasSample; }
+				std::chrono::microseconds smoothed() const { return mSmoothed; }
+				std::chrono::microseconds variation() const { return mVariation; }
+				std::chrono::milliseconds retransmissionTimeout() const { return mTimeout; }
+
+			private:
+				std::chrono::microseconds mSmoothed{ 0 };
+				std::chrono::microseconds mVariation{ 0 };
+				std::chrono::milliseconds mTimeout{ InitialTimeout };
+				bool mHasSample{ false };
+			};
+		}
+	}
+}
@@ -0,0 +1,175 @@
+#include "UDP/ShardedServer.hpp"
+#include "Messages.hpp"
+
+#include <algorithm>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace UDP
+		{
+			ShardedServer::~ShardedServer()
+			{
+				release();
+			}
+
+			bool ShardedServer::init(const uint16 port, size_t nbShards /*= 0*/)
+			{
+				assert(!mRegisteredChannels.empty()); // Initializing without any channel doesn't make sense..
+
+				release();
+				if (nbShards == 0)
+					nbShards = std::max(1u, std::thread::hardware_concurrency());
+				for (size_t i = 0; i < nbShards; ++i)
+				{
+					auto shard = std::make_unique<Client>();
+					for (auto& fct : mRegisteredChannels)
+						fct(*shard);
+					shard->setReusePort(nbShards > 1);
+					//!< Ids are generated with a stride so that a distant client id is unique among all shards
+					shard->mClientIdsFirst = i;
+					shard->mClientIdsStride = nbShards;
+					shard->mNewSenderHandler = [this, i](const Address& from, const BufferPool::Buffer& buffer) { return onNewSender(i, from, buffer); };
+					shard->mClientRemovedHandler = [this, i](const Address& addr) { onClientRemoved(i, addr); };
+					if (!shard->init(port))
+					{
+						if (i == 0)
+						{
+							//!< SO_REUSEPORT may be unsupported : try again as a single shard
+							if (nbShards > 1)
+								return init(port, 1);
+							return false;
+						}
+						//!< The system refused more sockets on this port : keep the shards already opened
+						break;
+					}
+					mShards.push_back(std::move(shard));
+				}
+				mRunning = true;
+				for (size_t i = 0; i < mShards.size(); ++i)
+					mThreads.emplace_back([this, i]() { run(i); });
+				return true;
+			}
+			void ShardedServer::release()
+			{
+				mRunning = false;
+				for (auto& shard : mShards)
+					shard->wakeUp();
+				for (std::thread& thread : mThreads)
+					thread.join();
+				mThreads.clear();
+				for (auto& shard : mShards)
+					shard->release();
+				mShards.clear();
+				OwnersLock lock(mOwnersLock);
+				mOwners.clear();
+			}
+
+			size_t ShardedServer::nbClients() const
+			{
+				OwnersLock lock(mOwnersLock);
+				return mOwners.size();
+			}
+
+			void ShardedServer::connect(const Address& addr)
+			{
+				assert(!mShards.empty());
+				mShards[owner(addr, defaultOwner(addr))]->connect(addr);
+			}
+			void ShardedServer::disconnect(const Address& addr)
+			{
+				assert(!mShards.empty());
+				const size_t shard = owner(addr, NoShard);
+				if (shard != NoShard)
+					mShards[shard]->disconnect(addr);
+			}
+			void ShardedServer::sendTo(const Address& target, std::vector<uint8>&& data, const uint32 channelIndex)
+			{
+				assert(!mShards.empty());
+				mShards[owner(target, defaultOwner(target))]->sendTo(target, std::move(data), channelIndex);
+			}
+			void ShardedServer::flush(const Address& target)
+			{
+				assert(!mShards.empty());
+				const size_t shard = owner(target, NoShard);
+				if (shard != NoShard)
+					mShards[shard]->flush(target);
+			}
+
+			std::vector<std::unique_ptr<Messages::Base>> ShardedServer::poll()
+			{
+				std::vector<std::unique_ptr<Messages::Base>> messages;
+				poll(messages);
+				return messages;
+			}
+			void ShardedServer::poll(std::vector<std::unique_ptr<Messages::Base>>& messages)
+			{
+				for (auto& shard : mShards)
+					shard->poll(messages);
+			}
+			size_t ShardedServer::pollEvents(std::vector<Messages::Event>& events)
+			{
+				size_t count = 0;
+				for (auto& shard : mShards)
+					count += shard->pollEvents(events);
+				return count;
+			}
+			Address ShardedServer::address(const uint64 emitterId) const
+			{
+				//!< Each shard generates ids starting at its index, with a stride of the number of shards
+				if (mShards.empty())
+					return Address();
+				return mShards[emitterId % mShards.size()]->address(emitterId);
+			}
+
+			size_t ShardedServer::owner(const Address& addr, const size_t candidate)
+			{
+				const Address::Key key = addr.key();
+				OwnersLock lock(mOwnersLock);
+				auto itOwner = mOwners.find(key);
+				if (itOwner != mOwners.end())
+					return itOwner->second;
+				if (candidate != NoShard)
+					mOwners.emplace(key, candidate);
+				return candidate;
+			}
+			size_t ShardedServer::defaultOwner(const Address& addr) const
+			{
+				return Address::Key::Hash()(addr.key()) % mShards.size();
+			}
+			bool ShardedServer::onNewSender(const size_t shard, const Address& from, const BufferPool::Buffer& buffer)
+			{
+				const size_t ownerShard = owner(from, shard);
+				if (ownerShard == shard)
+					return true;
+				Client& owner = *(mShards[ownerShard]);
+				{
+					Client::HandedOverDatagramsLock lock(owner.mHandedOverDatagramsLock);
+					//!< The owner shares the buffer : no copy of the datagram
+					owner.mHandedOverDatagrams.emplace_back(buffer, from);
+				}
+				owner.onPendingWork();
+				return false;
+			}
+			void ShardedServer::onClientRemoved(const size_t shard, const Address& addr)
+			{
+				OwnersLock lock(mOwnersLock);
+				auto itOwner = mOwners.find(addr.key());
+				if (itOwner != mOwners.end() && itOwner->second == shard)
+					mOwners.erase(itOwner);
+			}
+
+			void ShardedServer::run(const size_t shard)
+			{
+				Client& client = *(mShards[shard]);
+				while (mRunning)
+				{
+					client.wait(mMaxWaitDuration);
+					client.receive();
+					client.processSend();
+				}
+			}
+		}
+	}
+}
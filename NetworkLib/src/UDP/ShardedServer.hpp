@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Address.hpp"
+#include "UDPClient.hpp"
+#include "Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Bousk
+{
+	namespace Network
+	{
+		namespace Messages
+		{
+			class Base;
+		}
+		namespace UDP
+		{
+			/*
+			ShardedServer spreads the distant clients of a single UDP port over several Client, each driven by its own thread.
+
+			Every shard opens its own socket on the same port with SO_REUSEPORT : the system then hashes each sender to one of them.
+			Each distant client is owned by a single shard. When a datagram reaches another shard than the owner one,
+			it is handed over to the owner so that a distant client never exists in 2 shards.
+
+			To use it, register channels, then call init(port, nbShards).
+			The application only has to poll messages and connect, disconnect, sendTo its distant clients : shards receive & send by themselves.
+			If the system doesn't support SO_REUSEPORT, a single shard is used.
+			*/
+			class ShardedServer
+			{
+			public:
+				ShardedServer() = default;
+				ShardedServer(const ShardedServer&) = delete;
+				ShardedServer(ShardedServer&&) = delete;
+				ShardedServer& operator=(const ShardedServer&) = delete;
+				ShardedServer& operator=(ShardedServer&&) = delete;
+				~ShardedServer();
+
+				template<class T, class... Args>
+				void registerChannel(Args&&... args);
+
+				// Maximum time a shard waits for activity between 2 frames. Must be called before init
+				void setMaxWaitDuration(std::chrono::milliseconds duration) { mMaxWaitDuration = duration; }
+
+				// Open nbShards sockets on the given port and start their threads. 0 uses as many shards as the hardware has threads
+				bool init(uint16 port, size_t nbShards = 0);
+				void release();
+
+				size_t nbShards() const { return mShards.size(); }
+				// Number of distant clients owned by all shards
+				size_t nbClients() const;
+
+				// Can be called anytime from any thread
+				void connect(const Address& addr);
+				// Can be called anytime from any thread
+				void disconnect(const Address& addr);
+				// Can be called anytime from any thread
+				void sendTo(const Address& target, std::vector<uint8>&& data, uint32 channelIndex);
+				void sendTo(const Address& target, const uint8* data, size_t dataSize, uint32 channelIndex) { sendTo(target, std::vector<uint8>(data, data + dataSize), channelIndex); }
+				// Can be called anytime from any thread
+				void flush(const Address& target);
+
+				// Extract ready messages of all shards. Can be called anytime from any thread but each message is unique and polled only once
+				std::vector<std::unique_ptr<Messages::Base>> poll();
+				// Append ready messages of all shards to the given vector, which keeps its capacity from frame to frame
+				void poll(std::vector<std::unique_ptr<Messages::Base>>& messages);
+				// Call callback(std::unique_ptr<Messages::Base>&&) with each ready message of all shards. Returns the number of messages polled
+				template<class Callback>
+				size_t poll(Callback&& callback);
+				// Same as poll, without allocating each message : append ready events of all shards to the given vector
+				size_t pollEvents(std::vector<Messages::Event>& events);
+				// Call callback(Messages::Event&&) with each ready event of all shards. Returns the number of events polled
+				template<class Callback>
+				size_t pollEvents(Callback&& callback);
+				// Address of the emitter of an event, invalid if it's unknown. Can be called anytime from any thread
+				Address address(uint64 emitterId) const;
+
+			private:
+				static constexpr size_t NoShard = static_cast<size_t>(-1);
+				//!< Shard owning the address. If it's not owned yet and a candidate is given, the candidate becomes its owner
+				size_t owner(const Address& addr, size_t candidate);
+				//!< Default owner for an address the application reaches before it sent anything
+				size_t defaultOwner(const Address& addr) const;
+				//!< Returns whether the shard owns the new sender, otherwise the datagram is handed over to its owner
+				bool onNewSender(size_t shard, const Address& from, const BufferPool::Buffer& buffer);
+				void onClientRemoved(size_t shard, const Address& addr);
+				void run(size_t shard);
+
+			private:
+				std::vector<std::unique_ptr<Client>> mShards;
+				std::vector<std::thread> mThreads;
+				std::atomic<bool> mRunning{ false };
+				std::chrono::milliseconds mMaxWaitDuration{ 100 };
+				std::vector<std::function<void(Client&)>> mRegisteredChannels;
+
+				mutable std::mutex mOwnersLock;
+				using OwnersLock = std::lock_guard<std::mutex>;
+				std::unordered_map<Address::Key, size_t, Address::Key::Hash> mOwners; //!< Shard owning each distant client
+			};
+
+			template<class Callback>
+			size_t ShardedServer::poll(Callback&& callback)
+			{
+				size_t count = 0;
+				for (auto& shard : mShards)
+					count += shard->poll(callback);
+				return count;
+			}
+			template<class Callback>
+			size_t ShardedServer::pollEvents(Callback&& callback)
+			{
+				size_t count = 0;
+				for (auto& shard : mShards)
+					count += shard->pollEvents(callback);
+				return count;
+			}
+
+			template<class T, class... Args>
+			void ShardedServer::registerChannel(Args&&... args)
+			{
+				assert(mShards.empty()); // Don't add channels after being initialized !!!
+				mRegisteredChannels.push_back([=](Client& shard) { shard.registerChannel<T>(args...); });
+			}
+		}
+	}
+}
@@ -25,7 +25,7 @@ namespace Bousk
 			void Simulator::push(const Datagram& datagram, const Address& from)
 			{
 				assert(isEnabled());
-				const bool isLost = std::uniform_int_distribution(1, 100)(mLossGenerator) < mLoss.get();
+				const bool isLost = std::uniform_int_distribution(1, 100)(mLossGenerator) <= mLoss.get();
 				if (isLost)
 					return;
 
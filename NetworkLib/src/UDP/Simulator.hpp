@@ -27,6 +27,8 @@ namespace Bousk
 				void seed(unsigned int value);
 
 				void setDuplicate(RangedInteger<1, 10> duplicate) { mDuplicate = duplicate; }
+				// Chance, per thousand, of a datagram being duplicated
+				void setDuplicateRate(RangedInteger<0, 1000> rate) { mDuplicateRate = rate; }
 				void setLossRate(RangedInteger<0, 100> loss) { mLoss = loss; }
 				void setDelay(RangedInteger<0, 250> fixed, RangedInteger<0, 100> random) { mFixedDelay = fixed; mRandomDelay = random; }
 
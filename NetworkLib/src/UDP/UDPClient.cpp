@@ -3,6 +3,7 @@
 #include "Address.hpp"
 #include "Messages.hpp"
 #include "Errors.hpp"
+#include "Utils.hpp"
 
 #include <algorithm>
 #include <cstring>
@@ -21,8 +22,49 @@ namespace Bousk
 			{
 				return DistantClient::GetTimeout();
 			}
+			void Client::SetKeepAliveInterval(std::chrono::milliseconds interval)
+			{
+				DistantClient::SetKeepAliveInterval(interval);
+			}
+			std::chrono::milliseconds Client::GetKeepAliveInterval()
+			{
+				return DistantClient::GetKeepAliveInterval();
+			}
+			void Client::SetKeepAliveMode(KeepAliveMode mode)
+			{
+				DistantClient::SetKeepAliveMode(mode);
+			}
+			KeepAliveMode Client::GetKeepAliveMode()
+			{
+				return DistantClient::GetKeepAliveMode();
+			}
+			void Client::SetAckPolicy(std::chrono::milliseconds maxDelay, uint8 frequency)
+			{
+				DistantClient::SetAckPolicy(maxDelay, frequency);
+			}
+			std::chrono::milliseconds Client::GetMaxAckDelay()
+			{
+				return DistantClient::GetMaxAckDelay();
+			}
+			uint8 Client::GetAckFrequency()
+			{
+				return DistantClient::GetAckFrequency();
+			}
+			void Client::SetCoalescingPolicy(std::chrono::milliseconds maxDelay, uint16 fillThreshold)
+			{
+				DistantClient::SetCoalescingPolicy(maxDelay, fillThreshold);
+			}
+			std::chrono::milliseconds Client::GetCoalescingMaxDelay()
+			{
+				return DistantClient::GetCoalescingMaxDelay();
+			}
+			uint16 Client::GetCoalescingFillThreshold()
+			{
+				return DistantClient::GetCoalescingFillThreshold();
+			}
 
 			Client::Client()
+				: mTimers(Utils::Now())
 			{}
 			Client::~Client()
 			{
@@ -38,6 +80,9 @@ namespace Bousk
 				if (mSocket == INVALID_SOCKET)
 					return false;
 
+				if (mReusePort && !SetReusePort(mSocket))
+					return false;
+
 				const Address addr = Address::Any(Address::Type::IPv4, port);
 				if (!addr.bind(mSocket))
 					return false;
@@ -45,95 +90,192 @@ namespace Bousk
 				if (!SetNonBlocking(mSocket))
 					return false;
 
-				mClientIdsGenerator = 0;
+				if (!mPoller.init(mSocket))
+					return false;
+
+				//!< Offloads are optional : they fall back to regular datagrams if the system doesn't support them
+				mSendBatch.setSegmentation(mSocket, mSegmentationOffload);
+				mReceiveBatch.setCoalescing(mSocket, mSegmentationOffload);
+
+				mClientIdsGenerator = mClientIdsFirst;
 				return true;
 			}
 			void Client::release()
 			{
+				mPoller.release();
 				if (mSocket != INVALID_SOCKET)
 					CloseSocket(mSocket);
 				mSocket = INVALID_SOCKET;
+				mPendingOperations.consume([](Operation&) {});
+				mEvents.clear();
 				{
-					OperationsLock lock(mOperationsLock);
-					mPendingOperations.clear();
-				}
-				{
-					MessagesLock lock(mMessagesLock);
-					mMessages.clear();
+					HandedOverDatagramsLock lock(mHandedOverDatagramsLock);
+					mHandedOverDatagrams.clear();
 				}
+				mClientsToProcess.clear();
 				mClients.clear();
+				mClientsIndices.clear();
+				mSendBatch.clear();
 			}
 			void Client::connect(const Address& addr)
 			{
 				assert(addr.isValid());
-				OperationsLock lock(mOperationsLock);
-				mPendingOperations.push_back(Operation::Connect(addr));
+				mPendingOperations.push([&](Operation& op) { op.setConnect(addr); });
+				onPendingWork();
 			}
 			void Client::disconnect(const Address& addr)
 			{
 				assert(addr.isValid());
-				OperationsLock lock(mOperationsLock);
-				mPendingOperations.push_back(Operation::Disconnect(addr));
+				mPendingOperations.push([&](Operation& op) { op.setDisconnect(addr); });
+				onPendingWork();
 			}
 			void Client::sendTo(const Address& target, std::vector<uint8>&& data, const uint32 channelIndex)
 			{
 				assert(target.isValid());
-				OperationsLock lock(mOperationsLock);
-				mPendingOperations.push_back(Operation::SendTo(target, std::move(data), channelIndex));
+				mPendingOperations.push([&](Operation& op) { op.setSendTo(target, std::move(data), channelIndex); });
+				onPendingWork();
+			}
+			void Client::sendTo(const Address& target, const uint8* data, const size_t dataSize, const uint32 channelIndex)
+			{
+				assert(target.isValid());
+				mPendingOperations.push([&](Operation& op) { op.setSendTo(target, data, dataSize, channelIndex); });
+				onPendingWork();
+			}
+			void Client::flush(const Address& target)
+			{
+				assert(target.isValid());
+				mPendingOperations.push([&](Operation& op) { op.setFlush(target); });
+				onPendingWork();
+			}
+			void Client::wait(const std::chrono::milliseconds maxDuration)
+			{
+				if (mSocket == INVALID_SOCKET)
+					return;
+				if (!mClientsToProcess.empty())
+					return;
+				const auto now = Utils::Now();
+				std::chrono::milliseconds timeout = maxDuration;
+				const std::chrono::milliseconds nextExpiration = mTimers.nextExpiration();
+				if (nextExpiration != std::chrono::milliseconds::max())
+					timeout = std::min(timeout, std::max(std::chrono::milliseconds(0), nextExpiration - now));
+			#if BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
+				//!< Delayed datagrams are released by the simulator over time
+				if (mSimulator.isEnabled())
+					timeout = std::min(timeout, std::chrono::milliseconds(1));
+			#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
+				if (timeout.count() <= 0)
+					return;
+
+				//!< Operations queued from now on wake us up, and those queued before are seen by hasPendingWork
+				mWaiting = true;
+				if (!hasPendingWork())
+					mPoller.wait(timeout, !mSendBatch.empty());
+				mWaiting = false;
+			}
+			bool Client::hasPendingWork()
+			{
+				if (!mPendingOperations.empty())
+					return true;
+				HandedOverDatagramsLock lock(mHandedOverDatagramsLock);
+				return !mHandedOverDatagrams.empty();
+			}
+			void Client::onPendingWork()
+			{
+				//!< Order the queued work with the check of mWaiting, as wait orders mWaiting with its check of pending work
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (mWaiting)
+					mPoller.wakeUp();
 			}
 			void Client::processSend()
 			{
 				// Process pending operations
-				std::vector<Operation> operations;
-				{
-					OperationsLock lock(mOperationsLock);
-					operations.swap(mPendingOperations);
-				}
-				for (Operation& op : operations)
+				mPendingOperations.consume([&](Operation& op)
 				{
 					switch (op.mType)
 					{
 						case Operation::Type::Connect:
 						{
 							if (auto client = getClient(op.mTarget, true))
+							{
 								client->connect();
+								markToProcess(*client);
+							}
 						} break;
 						case Operation::Type::SendTo:
 						{
 							if (auto client = getClient(op.mTarget, true))
+							{
 								client->send(std::move(op.mData), op.mChannel);
+								markToProcess(*client);
+							}
 						} break;
 						case Operation::Type::Disconnect:
 						{
 							if (auto client = getClient(op.mTarget))
+							{
 								client->disconnect();
+								markToProcess(*client);
+							}
+						} break;
+						case Operation::Type::Flush:
+						{
+							if (auto client = getClient(op.mTarget))
+							{
+								client->flush();
+								markToProcess(*client);
+							}
 						} break;
 					}
-				}
+				});
+
+				// Clients with a deadline reached : keep alive to send, timeout or end of disconnection
+				mTimers.advance(Utils::Now(), [&](DistantClient& client) { markToProcess(client); });
 
-				// Do send data to clients
-				for (auto& client : mClients)
+				// Do send data to clients and remove disconnected ones. Idle clients are not visited
+				for (DistantClient* client : mClientsToProcess)
+				{
+					client->mToProcess = false;
 					client->processSend();
+					if (client->isDisconnected())
+					{
+						removeClient(mClientsIndices[client->address().key()]);
+						continue;
+					}
+					const std::chrono::milliseconds deadline = client->nextDeadline();
+					if (deadline == std::chrono::milliseconds::max())
+						client->mTimer.cancel();
+					else
+						mTimers.schedule(client->mTimer, deadline);
+				}
+				mClientsToProcess.clear();
 
-				// Remove disconnected clients
-				mClients.erase(
-					std::remove_if(mClients.begin(), mClients.end(), [](const std::unique_ptr<DistantClient>& client) { return client->isDisconnected(); })
-					, mClients.end()
-				);
+				// Flush datagrams of every client
+				if (mSocket != INVALID_SOCKET)
+					mSendBatch.flush(mSocket);
 			}
 			void Client::receive()
 			{
 				for (;;)
 				{
-					Datagram datagram;
-					Address from;
-					int ret = from.recvFrom(mSocket, reinterpret_cast<uint8*>(&datagram), Datagram::BufferMaxSize);
-					if (ret > 0)
+					const int nbReceived = mReceiveBatch.receive(mSocket);
+					if (nbReceived < 0)
+					{
+						//!< Error handling
+						const auto err = Errors::Get();
+						if (err != Errors::WOULDBLOCK)
+						{
+							//!< Log that error
+						}
+						break;
+					}
+					for (int i = 0; i < nbReceived; ++i)
 					{
-						const uint16 receivedSize = static_cast<uint16>(ret);
-						if (receivedSize >= Datagram::HeaderSize)
+						const uint16 receivedSize = mReceiveBatch.receivedSize(i);
+						const BufferPool::Buffer& buffer = mReceiveBatch.buffer(i);
+						Datagram& datagram = buffer.as<Datagram>();
+						if (receivedSize >= Datagram::HeaderMinSize && datagram.deserialize(receivedSize))
 						{
-							datagram.datasize = receivedSize - Datagram::HeaderSize;
+							const Address from(mReceiveBatch.from(i));
 						#if BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 							if (mSimulator.isEnabled())
 							{
@@ -144,8 +286,7 @@ namespace Bousk
 						#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 							{
 								// Handle the datagram directly
-								if (auto client = getClient(from, true))
-									client->onDatagramReceived(std::move(datagram));
+								onDatagramReceived(buffer, from);
 							}
 						}
 						else
@@ -153,19 +294,8 @@ namespace Bousk
 							//!< Something is wrong, unexpected datagram
 						}
 					}
-					else
-					{
-						if (ret < 0)
-						{
-							//!< Error handling
-							const auto err = Errors::Get();
-							if (err != Errors::WOULDBLOCK)
-							{
-								//!< Log that error
-							}
-						}
+					if (mReceiveBatch.isSocketDrained())
 						break;
-					}
 				}
 				// Poll pending datagrams from the simulator
 			#if BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
@@ -174,41 +304,83 @@ namespace Bousk
 					std::vector<std::pair<Datagram, Address>> datagrams = mSimulator.poll();
 					for (auto& [datagram, from] : datagrams)
 					{
-						if (auto client = getClient(from, true))
-							client->onDatagramReceived(std::move(datagram));
+						BufferPool::Buffer buffer = mReceiveBatch.pool().acquire();
+						buffer.as<Datagram>() = datagram;
+						onDatagramReceived(buffer, from);
 					}
 				}
 			#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
+				// Dispatch datagrams handed over by other threads
+				std::vector<std::pair<BufferPool::Buffer, Address>> handedOverDatagrams;
+				{
+					HandedOverDatagramsLock lock(mHandedOverDatagramsLock);
+					handedOverDatagrams.swap(mHandedOverDatagrams);
+				}
+				for (auto& [buffer, from] : handedOverDatagrams)
+				{
+					onDatagramReceived(buffer, from);
+				}
 			}
-			std::vector<std::unique_ptr<Messages::Base>> Client::poll()
+			void Client::onDatagramReceived(const BufferPool::Buffer& buffer, const Address& from)
 			{
-				MessagesLock lock(mMessagesLock);
-				return std::move(mMessages);
+				DistantClient* client = getClient(from);
+				if (!client)
+				{
+					if (mNewSenderHandler && !mNewSenderHandler(from, buffer))
+						return;
+					client = getClient(from, true);
+				}
+				client->onDatagramReceived(buffer.as<Datagram>());
+				//!< Acknowledge the datagram, notify connection changes and check its timeout with next processSend
+				markToProcess(*client);
 			}
 
 			DistantClient* Client::getClient(const Address& clientAddr, bool create /*= false*/)
 			{
-				auto itClient = std::find_if(mClients.begin(), mClients.end(), [&](const std::unique_ptr<DistantClient>& client) { return client->address() == clientAddr; });
-				if (itClient != mClients.end())
-					return itClient->get();
+				const Address::Key key = clientAddr.key();
+				auto itClient = mClientsIndices.find(key);
+				if (itClient != mClientsIndices.end())
+					return mClients[itClient->second].get();
 				else if (create)
 				{
-					mClients.emplace_back(std::make_unique<DistantClient>(*this, clientAddr, mClientIdsGenerator++));
+					mClientsIndices.emplace(key, mClients.size());
+					mClients.emplace_back(std::make_unique<DistantClient>(*this, clientAddr, mClientIdsGenerator));
+					mEvents.addEmitter(mClientIdsGenerator, clientAddr);
+					mClientIdsGenerator += mClientIdsStride;
 					setupChannels(*(mClients.back()));
 					return mClients.back().get();
 				}
 				else
 					return nullptr;
 			}
+			void Client::removeClient(const size_t index)
+			{
+				if (mClientRemovedHandler)
+					mClientRemovedHandler(mClients[index]->address());
+				mClientsIndices.erase(mClients[index]->address().key());
+				mEvents.removeEmitter(mClients[index]->id());
+				if (index != mClients.size() - 1)
+				{
+					mClients[index] = std::move(mClients.back());
+					mClientsIndices[mClients[index]->address().key()] = index;
+				}
+				mClients.pop_back();
+			}
+			void Client::markToProcess(DistantClient& client)
+			{
+				if (client.mToProcess)
+					return;
+				client.mToProcess = true;
+				mClientsToProcess.push_back(&client);
+			}
 			void Client::setupChannels(DistantClient& client)
 			{
 				for (auto& fct : mRegisteredChannels)
 					fct(client);
 			}
-			void Client::onMessageReady(std::unique_ptr<Messages::Base>&& msg)
+			void Client::onMessageReady(Messages::Event&& msg)
 			{
-				MessagesLock lock(mMessagesLock);
-				mMessages.push_back(std::move(msg));
+				mEvents.push(std::move(msg));
 			}
 		}
 	}
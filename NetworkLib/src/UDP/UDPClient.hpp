@@ -1,15 +1,23 @@
 #pragma once
 
 #include "Address.hpp"
+#include "DatagramBatch.hpp"
 #include "DistantClient.hpp"
+#include "EventsQueue.hpp"
+#include "MPSCQueue.hpp"
+#include "Poller.hpp"
+#include "Settings.hpp"
 #include "Simulator.hpp"
 #include "Sockets.hpp"
+#include "TimerWheel.hpp"
 #include "Types.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace Bousk
@@ -29,6 +37,8 @@ namespace Bousk
 			
 			An application loop should do the following
 			- frame start -
+			> wait
+			>> block until data is received, an operation is queued or a distant client has something to do
 			> receive
 			>> receive pending data from the system
 			> poll
@@ -48,6 +58,7 @@ namespace Bousk
 			class Client
 			{
 				friend class DistantClient;
+				friend class ShardedServer;
 			public:
 				Client();
 				Client(const Client&) = delete;
@@ -56,20 +67,44 @@ namespace Bousk
 				Client& operator=(Client&&) = delete;
 				~Client();
 
-				template<class T>
-				void registerChannel();
+				// Each distant client gets its own channel of type T, built with a copy of the given arguments
+				template<class T, class... Args>
+				void registerChannel(Args&&... args);
 
 			#if BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 				Simulator& simulator() { return mSimulator; }
 				const Simulator& simulator() const { return mSimulator; }
 			#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 
+				// Use UDP segmentation & receive offloads (GSO/GRO) if the system supports them. Must be called before init
+				// Consecutive datagrams to a same distant client are then sent in a single buffer, which benefits clients receiving lots of data
+				void setSegmentationOffload(bool enable) { mSegmentationOffload = enable; }
+				bool isSendSegmentationEnabled() const { return mSendBatch.isSegmentationEnabled(); }
+				bool isReceiveCoalescingEnabled() const { return mReceiveBatch.isCoalescingEnabled(); }
+
+				// Share the port with other sockets (SO_REUSEPORT). Must be called before init, which fails if the system doesn't support it
+				void setReusePort(bool enable) { mReusePort = enable; }
+
 				// Initialise socket to send and receive data on the given port
 				bool init(uint16 port);
 				void release();
 
 				static void SetTimeout(std::chrono::milliseconds timeout);
 				static std::chrono::milliseconds GetTimeout();
+				// Idle connections send a keep alive every interval, which should remain well below the timeout
+				static void SetKeepAliveInterval(std::chrono::milliseconds interval);
+				static std::chrono::milliseconds GetKeepAliveInterval();
+				// In AckOnly mode, connected ends send keep alives only to acknowledge received data
+				static void SetKeepAliveMode(KeepAliveMode mode);
+				static KeepAliveMode GetKeepAliveMode();
+				// Acknowledge received data once frequency datagrams wait for it, or once the oldest waited maxDelay. Immediate acks by default
+				static void SetAckPolicy(std::chrono::milliseconds maxDelay, uint8 frequency);
+				static std::chrono::milliseconds GetMaxAckDelay();
+				static uint8 GetAckFrequency();
+				// Hold messages back until fillThreshold bytes of them are queued for a distant client, or the first one waited maxDelay. Sent right away by default
+				static void SetCoalescingPolicy(std::chrono::milliseconds maxDelay, uint16 fillThreshold);
+				static std::chrono::milliseconds GetCoalescingMaxDelay();
+				static uint16 GetCoalescingFillThreshold();
 
 				// Can be called anytime from any thread
 				void connect(const Address& addr);
@@ -77,29 +112,85 @@ namespace Bousk
 				void disconnect(const Address& addr);
 				// Can be called anytime from any thread
 				void sendTo(const Address& target, std::vector<uint8>&& data, uint32 channelIndex);
-				void sendTo(const Address& target, const uint8* data, size_t dataSize, uint32 channelIndex) { sendTo(target, std::vector<uint8>(data, data + dataSize), channelIndex); }
+				void sendTo(const Address& target, const uint8* data, size_t dataSize, uint32 channelIndex);
+				// Send messages held back by the coalescing policy with next processSend, for latency critical ones. Can be called anytime from any thread
+				void flush(const Address& target);
 
-				// This performs operations on existing clients. Must not be called while calling receive
+				// Block until data can be received, an operation is queued from another thread, a distant client needs a keep alive or times out, or maxDuration elapsed
+				// Must be called from the thread calling receive & processSend
+				void wait(std::chrono::milliseconds maxDuration);
+				// Interrupt current or next wait. Can be called anytime from any thread
+				void wakeUp() { mPoller.wakeUp(); }
+
+				// This performs operations on existing clients then sends all datagrams produced at once. Must not be called while calling receive
 				void processSend();
 				// This performs operations on existing clients. Must not be called while calling processSend
 				void receive();
 				// Extract ready messages. Can be called anytime from any thread but each message is unique and polled only once
-				std::vector<std::unique_ptr<Messages::Base>> poll();
+				std::vector<std::unique_ptr<Messages::Base>> poll() { return mEvents.poll(); }
+				// Append ready messages to the given vector, which keeps its capacity from frame to frame
+				void poll(std::vector<std::unique_ptr<Messages::Base>>& messages) { mEvents.poll(messages); }
+				// Call callback(std::unique_ptr<Messages::Base>&&) with each ready message. Returns the number of messages polled
+				template<class Callback>
+				size_t poll(Callback&& callback) { return mEvents.poll(std::forward<Callback>(callback)); }
+				// Same as poll, without allocating each message : append ready events to the given vector, which is meant to be cleared and refilled each frame
+				size_t pollEvents(std::vector<Messages::Event>& events) { return mEvents.pollEvents(events); }
+				// Call callback(Messages::Event&&) with each ready event. Returns the number of events polled
+				template<class Callback>
+				size_t pollEvents(Callback&& callback) { return mEvents.pollEvents(std::forward<Callback>(callback)); }
+				// Address of the emitter of an event, invalid if it's unknown. Can be called anytime from any thread
+				Address address(uint64 emitterId) const { return mEvents.address(emitterId); }
+
+				// Average number of datagrams pulled from the socket per system call in receive
+				float averageReceiveBatchSize() const { return mReceiveBatch.averageSize(); }
+				// Number of datagrams sent since init
+				uint64 nbDatagramsSent() const { return mSendBatch.nbDatagramsSent(); }
+				// Number of datagrams dropped since init, because the socket couldn't take them fast enough
+				uint64 nbDatagramsDropped() const { return mSendBatch.nbDatagramsDropped(); }
 
 			private:
 				DistantClient* getClient(const Address& clientAddr, bool create = false);
+				//!< Dispatch the datagram held by buffer to its distant client, created if needed unless the datagram is handed over to another client
+				void onDatagramReceived(const BufferPool::Buffer& buffer, const Address& from);
+				//!< Swap the client with the last one then remove it, keeping indices up to date
+				void removeClient(size_t index);
+				//!< Queue the client to be processed by next processSend
+				void markToProcess(DistantClient& client);
 				void setupChannels(DistantClient& client);
+				//!< Whether some operations or datagrams are ready to be processed without waiting for the socket
+				bool hasPendingWork();
+				//!< Wake up a thread blocked in wait, if any
+				void onPendingWork();
 
 			private:
-				void onMessageReady(std::unique_ptr<Messages::Base>&& msg);
+				void onMessageReady(Messages::Event&& msg);
 
 			private:
 				SOCKET mSocket{ INVALID_SOCKET };
+				Poller mPoller;
+				std::atomic<bool> mWaiting{ false }; //!< Whether a thread is blocked in wait, to wake it up only when needed
+				ReceiveBatch mReceiveBatch;
+				SendBatch mSendBatch;
+				bool mSegmentationOffload{ false };
+				bool mReusePort{ false };
+				TimerWheel<DistantClient> mTimers; //!< Deadline of each distant client : keep alive, timeout or disconnection. Must outlive them
 				std::vector<std::unique_ptr<DistantClient>> mClients;
+				std::vector<DistantClient*> mClientsToProcess; //!< Clients with operations, received datagrams or due deadlines : the others are idle
+				std::unordered_map<Address::Key, size_t, Address::Key::Hash> mClientsIndices; //!< Index in mClients of each client address
 				uint64 mClientIdsGenerator{ 0 };
-				std::mutex mMessagesLock;
-				using MessagesLock = std::lock_guard<std::mutex>;
-				std::vector<std::unique_ptr<Messages::Base>> mMessages;
+				uint64 mClientIdsFirst{ 0 };
+				uint64 mClientIdsStride{ 1 }; //!< Sharded clients generate ids with a stride to keep them unique across shards
+
+				//!< Sharding hooks
+				//!< Called with the address of an unknown sender : returns false if the datagram has been handed over and no client must be created
+				std::function<bool(const Address&, const BufferPool::Buffer&)> mNewSenderHandler;
+				//!< Called once a distant client has been removed
+				std::function<void(const Address&)> mClientRemovedHandler;
+				//!< Datagrams handed over by other threads, dispatched during next receive
+				std::mutex mHandedOverDatagramsLock;
+				using HandedOverDatagramsLock = std::lock_guard<std::mutex>;
+				std::vector<std::pair<BufferPool::Buffer, Address>> mHandedOverDatagrams;
+				EventsQueue mEvents;
 
 				std::vector<std::function<void(DistantClient&)>> mRegisteredChannels;
 
@@ -109,42 +200,36 @@ namespace Bousk
 						Connect,
 						SendTo,
 						Disconnect,
+						Flush,
 					};
 				public:
-					static Operation Connect(const Address& target) { return Operation(Type::Connect, target); }
-					static Operation SendTo(const Address& target, std::vector<uint8>&& data, uint32 channel) { return Operation(Type::SendTo, target, std::move(data), channel); }
-					static Operation Disconnect(const Address& target) { return Operation(Type::Disconnect, target); }
-
-					Operation(Type type, const Address& target)
-						: mType(type)
-						, mTarget(target)
-					{}
-					Operation(Type type, const Address& target, std::vector<uint8>&& data, uint32 channel)
-						: mType(type)
-						, mTarget(target)
-						, mData(std::move(data))
-						, mChannel(channel)
-					{}
-
-					Type mType;
+					//!< Operations are written in place into preallocated slots, which are reused : every member must be set
+					void setConnect(const Address& target) { set(Type::Connect, target, 0); mData.clear(); }
+					void setSendTo(const Address& target, std::vector<uint8>&& data, uint32 channel) { set(Type::SendTo, target, channel); mData = std::move(data); }
+					void setSendTo(const Address& target, const uint8* data, size_t dataSize, uint32 channel) { set(Type::SendTo, target, channel); mData.assign(data, data + dataSize); }
+					void setDisconnect(const Address& target) { set(Type::Disconnect, target, 0); mData.clear(); }
+					void setFlush(const Address& target) { set(Type::Flush, target, 0); mData.clear(); }
+
+					Type mType{ Type::Connect };
 					Address mTarget;
 					std::vector<uint8> mData;
 					uint32 mChannel{ 0 };
+
+				private:
+					void set(Type type, const Address& target, uint32 channel) { mType = type; mTarget = target; mChannel = channel; }
 				};
-				std::mutex mOperationsLock;
-				using OperationsLock = std::lock_guard<std::mutex>;
-				std::vector<Operation> mPendingOperations;
+				MPSCQueue<Operation> mPendingOperations{ BOUSKNET_UDP_OPERATIONS_QUEUE_SIZE };
 
 			#if BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 				Simulator mSimulator;
 			#endif // BOUSKNET_ALLOW_NETWORK_SIMULATOR == BOUSKNET_SETTINGS_ENABLED
 			};
 
-			template<class T>
-			void Client::registerChannel()
+			template<class T, class... Args>
+			void Client::registerChannel(Args&&... args)
 			{
 				assert(mSocket == INVALID_SOCKET); // Don't add channels after being initialized !!!
-				mRegisteredChannels.push_back([](DistantClient& distantClient) { distantClient.registerChannel<T>(); });
+				mRegisteredChannels.push_back([=](DistantClient& distantClient) { distantClient.registerChannel<T>(args...); });
 			}
 		}
 	}
@@ -5,18 +5,6 @@ namespace Bousk
 {
 	namespace Utils
 	{
-		uint8 CountNeededBits(uint64 v)
-		{
-			assert(v != 0);
-			uint8 bits = 0;
-			while (v)
-			{
-				++bits;
-				v /= 2;
-			}
-			return bits;
-		}
-
 		uint8 CreateRightBitsMask(uint8 rightBits)
 		{
 			assert(rightBits >= 1 && rightBits <= 8);
@@ -3,6 +3,10 @@
 #include <Types.hpp>
 #include <chrono>
 
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif // _MSC_VER
+
 #define UNUSED(x) (void)(x)
 
 namespace Bousk
@@ -20,7 +24,7 @@ namespace Bousk
 
 		using Bousk::Bit;
 
-		uint8 CountNeededBits(uint64 v);
+		inline uint8 CountNeededBits(uint64 v);
 
 		uint8 CreateRightBitsMask(uint8 rightBits);
 		uint8 CreateBitsMask(uint8 nbBits, uint8 rightBitsToSkip);
@@ -42,5 +42,16 @@ namespace Bousk
 			assert(n < 64);
 			return (bitfield & (Bit<uint64>::Right << n)) != 0;
 		}
+		uint8 CountNeededBits(const uint64 v)
+		{
+			assert(v != 0);
+		#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse64(&index, v);
+			return static_cast<uint8>(index + 1);
+		#else
+			return static_cast<uint8>(64 - __builtin_clzll(v));
+		#endif // _MSC_VER
+		}
 	}
 }
\ No newline at end of file